@@ -20,6 +20,7 @@
 #include "Backend.h"
 #include "LocaleUtils.h"
 #include "Log.h"
+#include "Trace.h"
 #include "platform/TerminalKbd.h"
 
 #include <QCommandLineParser>
@@ -47,6 +48,7 @@ int main(int argc, char *argv[])
 
     handle_cli_args(app);
     Log::init();
+    Trace::init();
     AppSettings::load_config();
 
     backend::AppContext context;
@@ -72,6 +74,11 @@ void handle_cli_args(QGuiApplication& app)
         tr_log("Do not print log messages to the terminal"));
     argparser.addOption(arg_silent);
 
+    const QCommandLineOption arg_trace(QStringLiteral("trace"),
+        tr_log("Write timing information of the startup process into <file>, in Chrome's trace event format"),
+        QStringLiteral("file"));
+    argparser.addOption(arg_trace);
+
     argparser.addHelpOption();
     argparser.addVersionOption();
     argparser.process(app); // may quit!
@@ -79,4 +86,7 @@ void handle_cli_args(QGuiApplication& app)
 
     AppSettings::general.portable = argparser.isSet(arg_portable);
     AppSettings::general.silent = argparser.isSet(arg_silent);
+    AppSettings::general.trace_path = argparser.isSet(arg_trace)
+        ? argparser.value(arg_trace)
+        : QString::fromLocal8Bit(qgetenv("PEGASUS_TRACE"));
 }
@@ -22,6 +22,7 @@
 
 ApiObject::ApiObject(QObject* parent)
     : QObject(parent)
+    , m_allGames(m_library)
     , m_launch_game_file(nullptr)
     , m_providerman(this)
 {
@@ -30,6 +31,8 @@ ApiObject::ApiObject(QObject* parent)
 
     connect(&m_internal.settings().locales(), &model::Locales::localeChanged,
             this, &ApiObject::localeChanged);
+    connect(&m_internal.settings().locales(), &model::Locales::localeChanged,
+            &m_providerman, &ProviderManager::onLocaleChanged);
     connect(&m_internal.settings().keyEditor(), &model::KeyEditor::keysChanged,
             &m_keys, &model::Keys::refresh_keys);
     connect(&m_internal.settings().themes(), &model::Themes::themeChanged,
@@ -43,46 +46,44 @@ ApiObject::ApiObject(QObject* parent)
             &m_internal.meta(), &model::Meta::onSecondPhaseCompleted);
     connect(&m_providerman, &ProviderManager::staticDataReady,
             this, &ApiObject::onStaticDataLoaded);
+    connect(&m_providerman, &ProviderManager::rescanStarted,
+            &m_internal.meta(), &model::Meta::onRescanStarted);
+    connect(&m_providerman, &ProviderManager::rescanFinished,
+            &m_internal.meta(), &model::Meta::onRescanFinished);
+
+    m_internal.meta().setProviderNames(m_providerman.providerNames());
+    connect(&m_internal.meta(), &model::Meta::rescanRequested,
+            &m_providerman, &ProviderManager::startRescan);
+    connect(&m_internal.meta(), &model::Meta::rescanCancelRequested,
+            &m_providerman, &ProviderManager::cancelRescan);
+
+    connect(&m_library, &model::Library::launchFileSelectorRequested,
+            this, &ApiObject::selectGameFile);
+    connect(&m_library, &model::Library::launchRequested,
+            this, &ApiObject::onGameFileLaunchRequested);
+    connect(&m_library, &model::Library::favoritesChanged,
+            this, &ApiObject::onGameFavoriteChanged);
 
     onThemeChanged();
 }
 
 void ApiObject::startScanning()
 {
-    m_providerman.startSearch(m_allGames, m_collections);
+    m_providerman.startSearch(m_library, m_allGames, m_collections);
 }
 
 void ApiObject::onStaticDataLoaded()
 {
     qInfo().noquote() << tr_log("%1 games found").arg(m_allGames.count());
-
-    for (model::Game* game : m_allGames) {
-        connect(game, &model::Game::launchFileSelectorRequested,
-                this, &ApiObject::onGameFileSelectorRequested);
-        connect(game, &model::Game::favoriteChanged,
-                this, &ApiObject::onGameFavoriteChanged);
-
-        for (model::GameFile* gamefile : *game->files()) {
-            connect(gamefile, &model::GameFile::launchRequested,
-                    this, &ApiObject::onGameFileLaunchRequested);
-        }
-    }
-
     m_internal.meta().onUiReady();
 }
 
-void ApiObject::onGameFileSelectorRequested()
-{
-    auto game = static_cast<model::Game*>(QObject::sender());
-    emit selectGameFile(game);
-}
-
-void ApiObject::onGameFileLaunchRequested()
+void ApiObject::onGameFileLaunchRequested(model::GameFile* gamefile)
 {
     if (m_launch_game_file)
         return;
 
-    m_launch_game_file = static_cast<model::GameFile*>(QObject::sender());
+    m_launch_game_file = gamefile;
     emit launchGameFile(m_launch_game_file);
 }
 
@@ -109,7 +110,7 @@ void ApiObject::onGameFinished()
 
 void ApiObject::onGameFavoriteChanged()
 {
-    m_providerman.onGameFavoriteChanged(m_allGames.asList());
+    m_providerman.onGameFavoriteChanged(m_library.store());
 }
 
 void ApiObject::onThemeChanged()
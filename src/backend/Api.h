@@ -19,6 +19,8 @@
 
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
 #include "model/internal/Internal.h"
 #include "model/keys/Keys.h"
 #include "model/memory/Memory.h"
@@ -36,11 +38,14 @@
 class ApiObject : public QObject {
     Q_OBJECT
 
+    // NOTE: has to be created before the game lists
+    model::Library m_library;
+
     QML_CONST_PROPERTY(model::Internal, internal)
     QML_CONST_PROPERTY(model::Keys, keys)
     QML_READONLY_PROPERTY(model::Memory, memory)
     QML_OBJMODEL_PROPERTY(model::Collection, collections)
-    QML_OBJMODEL_PROPERTY(model::Game, allGames)
+    QML_CONST_PROPERTY(model::GameList, allGames)
 
     // retranslate on locale change
     Q_PROPERTY(QString tr READ emptyString NOTIFY localeChanged)
@@ -70,8 +75,7 @@ private slots:
     // internal communication
     void onStaticDataLoaded();
     void onGameFavoriteChanged();
-    void onGameFileSelectorRequested();
-    void onGameFileLaunchRequested();
+    void onGameFileLaunchRequested(model::GameFile*);
     void onThemeChanged();
 
 private:
@@ -39,8 +39,10 @@ struct General {
     bool portable;
     bool silent;
     bool fullscreen;
+    bool sort_ignore_articles;
     QString locale;
     QString theme;
+    QString trace_path;
 
     General();
     NO_COPY_NO_MOVE(General)
@@ -20,6 +20,7 @@
 #include "LocaleUtils.h"
 #include "Log.h"
 #include "ScriptRunner.h"
+#include "Trace.h"
 #include "model/gaming/Game.h"
 #include "platform/PowerCommands.h"
 
@@ -43,6 +44,7 @@ void on_app_close(AppCloseType type)
     }
 
     qInfo().noquote() << tr_log("Closing Pegasus, goodbye!");
+    Trace::close();
     Log::close();
 
     QCoreApplication::quit();
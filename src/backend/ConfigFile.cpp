@@ -18,12 +18,270 @@
 #include "ConfigFile.h"
 
 #include "LocaleUtils.h"
+#include "utils/HashMap.h"
 
 #include <QDebug>
 #include <QFile>
-#include <QRegularExpression>
 #include <QStringBuilder>
 #include <QTextStream>
+#include <cstring>
+
+
+namespace {
+constexpr auto EMPTY_LINE_MARK = QChar('.');
+
+bool is_ascii(const char* it, const char* const end)
+{
+    constexpr quint64 HIGH_BITS = Q_UINT64_C(0x8080808080808080);
+    for (; end - it >= 8; it += 8) {
+        quint64 word;
+        std::memcpy(&word, it, sizeof(word));
+        if (word & HIGH_BITS)
+            return false;
+    }
+    for (; it != end; ++it) {
+        if (static_cast<uchar>(*it) & 0x80)
+            return false;
+    }
+    return true;
+}
+
+// NOTE: the same as QChar::isSpace for ASCII characters
+bool is_ascii_space(char c)
+{
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+void trim_ascii(const char*& begin, const char*& end)
+{
+    while (begin != end && is_ascii_space(*begin))
+        ++begin;
+    while (begin != end && is_ascii_space(*(end - 1)))
+        --end;
+}
+
+bool has_unicode_bom(const char* data, qint64 size)
+{
+    return (size >= 2 && (std::memcmp(data, "\xFF\xFE", 2) == 0 || std::memcmp(data, "\xFE\xFF", 2) == 0))
+        || (size >= 4 && std::memcmp(data, "\x00\x00\xFE\xFF", 4) == 0);
+}
+
+
+/// Builds the entries from the lines of the file, and reports the errors.
+/// The lines can either be QStrings, or UTF-8 text in memory; in the latter
+/// case pure ASCII lines are processed without creating a QString of them.
+class LineParser {
+public:
+    LineParser(const std::function<void(const config::Entry&)>& onAttributeFound,
+               const std::function<void(const config::Error&)>& onError);
+
+    void parseLine(int linenum, const QStringRef& line);
+    void parseLine(int linenum, const char* begin, const char* end);
+    void finish();
+
+private:
+    const std::function<void(const config::Entry&)>& m_on_attribute;
+    const std::function<void(const config::Error&)>& m_on_error;
+
+    config::Entry m_entry;
+    /// raw key -> lowercase key, as the same few keys are used over and over
+    HashMap<QString, QString> m_keys;
+
+    void closeCurrentAttrib();
+    bool canAppendValue(int linenum);
+    const QString& lowercaseKey(const char* begin, const char* end);
+};
+
+LineParser::LineParser(const std::function<void(const config::Entry&)>& onAttributeFound,
+                       const std::function<void(const config::Error&)>& onError)
+    : m_on_attribute(onAttributeFound)
+    , m_on_error(onError)
+{
+    m_entry.reset();
+}
+
+void LineParser::closeCurrentAttrib()
+{
+    if (!m_entry.key.isEmpty()) {
+        if (m_entry.values.isEmpty()) {
+            m_on_error({ m_entry.line, tr_log("attribute value missing, entry ignored") });
+        }
+        else
+            m_on_attribute(m_entry);
+    }
+
+    m_entry.reset();
+}
+
+void LineParser::finish()
+{
+    closeCurrentAttrib();
+}
+
+bool LineParser::canAppendValue(int linenum)
+{
+    if (m_entry.key.isEmpty()) {
+        m_on_error({ linenum, tr_log("line starts with whitespace, but no attribute has been defined yet") });
+        return false;
+    }
+    return true;
+}
+
+const QString& LineParser::lowercaseKey(const char* begin, const char* end)
+{
+    const QLatin1String raw_key(begin, static_cast<int>(end - begin));
+
+    auto it = m_keys.find(raw_key);
+    if (it == m_keys.end()) {
+        QString key(raw_key);
+        QString lowercase_key = key.toLower();
+        it = m_keys.emplace(std::move(key), std::move(lowercase_key)).first;
+    }
+    return it->second;
+}
+
+void LineParser::parseLine(int linenum, const QStringRef& line)
+{
+    if (line.startsWith('#'))
+        return;
+
+    const QStringRef trimmed_line = line.trimmed();
+    if (trimmed_line.isEmpty()) {
+        closeCurrentAttrib();
+        return;
+    }
+
+    // multiline (starts with whitespace but also has content)
+    if (line.at(0).isSpace()) {
+        if (!canAppendValue(linenum))
+            return;
+
+        if (trimmed_line == EMPTY_LINE_MARK) {
+            m_entry.values.append(QStringLiteral("\n"));
+            return;
+        }
+
+        m_entry.values.append(trimmed_line.toString());
+        return;
+    }
+
+    // either a new entry or error - in both cases, the previous entry should be closed
+    closeCurrentAttrib();
+
+    // keyval pair (after the multiline check); the key cannot be empty
+    const int colon_pos = trimmed_line.indexOf(':');
+    if (colon_pos < 1) {
+        m_on_error({ linenum, tr_log("line invalid, skipped") });
+        return;
+    }
+
+    m_entry.key = trimmed_line.left(colon_pos).trimmed().toString().toLower();
+
+    // the value can be empty here, if it's purely multiline
+    const QStringRef value_part = trimmed_line.mid(colon_pos + 1).trimmed();
+    if (!value_part.isEmpty())
+        m_entry.values.append(value_part.toString());
+
+    m_entry.line = linenum;
+}
+
+void LineParser::parseLine(int linenum, const char* const begin, const char* const end)
+{
+    // NOTE: non-ASCII characters may also be whitespace
+    if (!is_ascii(begin, end)) {
+        const QString line = QString::fromUtf8(begin, static_cast<int>(end - begin));
+        parseLine(linenum, QStringRef(&line));
+        return;
+    }
+
+    if (begin != end && *begin == '#')
+        return;
+
+    const char* trimmed_begin = begin;
+    const char* trimmed_end = end;
+    trim_ascii(trimmed_begin, trimmed_end);
+    if (trimmed_begin == trimmed_end) {
+        closeCurrentAttrib();
+        return;
+    }
+
+    // multiline (starts with whitespace but also has content)
+    if (is_ascii_space(*begin)) {
+        if (!canAppendValue(linenum))
+            return;
+
+        if (trimmed_end - trimmed_begin == 1 && *trimmed_begin == EMPTY_LINE_MARK.toLatin1()) {
+            m_entry.values.append(QStringLiteral("\n"));
+            return;
+        }
+
+        m_entry.values.append(QString::fromLatin1(trimmed_begin, static_cast<int>(trimmed_end - trimmed_begin)));
+        return;
+    }
+
+    // either a new entry or error - in both cases, the previous entry should be closed
+    closeCurrentAttrib();
+
+    // keyval pair (after the multiline check); the key cannot be empty
+    const auto colon = static_cast<const char*>(std::memchr(trimmed_begin, ':', static_cast<size_t>(trimmed_end - trimmed_begin)));
+    if (!colon || colon == trimmed_begin) {
+        m_on_error({ linenum, tr_log("line invalid, skipped") });
+        return;
+    }
+
+    const char* key_begin = trimmed_begin;
+    const char* key_end = colon;
+    trim_ascii(key_begin, key_end);
+    m_entry.key = lowercaseKey(key_begin, key_end);
+
+    // the value can be empty here, if it's purely multiline
+    const char* value_begin = colon + 1;
+    const char* value_end = trimmed_end;
+    trim_ascii(value_begin, value_end);
+    if (value_begin != value_end)
+        m_entry.values.append(QString::fromLatin1(value_begin, static_cast<int>(value_end - value_begin)));
+
+    m_entry.line = linenum;
+}
+
+
+/// Reads UTF-8 text from memory, looking for line breaks with memchr
+void read_buffer(const char* data, qint64 size,
+                 const std::function<void(const config::Entry&)>& onAttributeFound,
+                 const std::function<void(const config::Error&)>& onError)
+{
+    // NOTE: UTF-16 and UTF-32 texts are rare, the stream reader can deal with them
+    if (has_unicode_bom(data, size)) {
+        QTextStream stream(QByteArray::fromRawData(data, static_cast<int>(size)));
+        config::readStream(stream, onAttributeFound, onError);
+        return;
+    }
+
+    const char* const data_end = data + size;
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        data += 3;
+
+    LineParser parser(onAttributeFound, onError);
+
+    int linenum = 0;
+    const char* line_begin = data;
+    while (line_begin != data_end) {
+        linenum++;
+
+        const auto newline = static_cast<const char*>(std::memchr(line_begin, '\n', static_cast<size_t>(data_end - line_begin)));
+        const char* const next_line = newline ? newline + 1 : data_end;
+
+        const char* line_end = newline ? newline : data_end;
+        if (line_end != line_begin && *(line_end - 1) == '\r')
+            --line_end;
+
+        parser.parseLine(linenum, line_begin, line_end);
+        line_begin = next_line;
+    }
+
+    parser.finish();
+}
+} // namespace
 
 
 namespace config {
@@ -40,11 +298,10 @@ bool readFile(const QString& path,
               const std::function<void(const Error&)>& onError)
 {
     QFile file(path);
-    if (!file.open(QFile::ReadOnly | QFile::Text))
+    if (!file.open(QFile::ReadOnly))
         return false;
 
-    QTextStream stream(&file);
-    readStream(stream, onAttributeFound, onError);
+    readFile(file, onAttributeFound, onError);
     return true;
 }
 
@@ -53,92 +310,35 @@ void readFile(QFile& file,
               const std::function<void(const Error&)>& onError)
 {
     Q_ASSERT(file.isOpen() && file.isReadable());
-    QTextStream stream(&file);
-    return readStream(stream, onAttributeFound, onError);
+
+    // NOTE: mapping can fail, eg. for empty files or compressed resources
+    const qint64 offset = file.pos();
+    const qint64 size = file.size() - offset;
+    uchar* const mapped = size > 0 ? file.map(offset, size) : nullptr;
+    if (mapped) {
+        read_buffer(reinterpret_cast<const char*>(mapped), size, onAttributeFound, onError);
+        file.unmap(mapped);
+        return;
+    }
+
+    const QByteArray contents = file.readAll();
+    read_buffer(contents.constData(), contents.size(), onAttributeFound, onError);
 }
 
 void readStream(QTextStream& stream,
                 const std::function<void(const Entry&)>& onAttributeFound,
                 const std::function<void(const Error&)>& onError)
 {
-    constexpr auto EMPTY_LINE_MARK = QChar('.');
-    const QRegularExpression rx_keyval(QStringLiteral(R"(^([^:]+):(.*)$)")); // key: value
-
-    Error error;
-    Entry entry;
-    entry.reset();
-
-    const auto close_current_attrib = [&](){
-        if (!entry.key.isEmpty()) {
-            if (entry.values.isEmpty()) {
-                onError({ entry.line, tr_log("attribute value missing, entry ignored") });
-            }
-            else
-                onAttributeFound(entry);
-        }
-
-        entry.reset();
-    };
+    LineParser parser(onAttributeFound, onError);
 
     int linenum = 0;
     QString line;
     while (stream.readLineInto(&line)) {
         linenum++;
-
-        if (line.startsWith('#'))
-            continue;
-
-        const QStringRef trimmed_line = line.leftRef(-1).trimmed();
-        if (trimmed_line.isEmpty()) {
-            close_current_attrib();
-            continue;
-        }
-
-        // multiline (starts with whitespace but also has content)
-        if (line.at(0).isSpace()) {
-            if (entry.key.isEmpty()) {
-                onError({ linenum, tr_log("line starts with whitespace, but no attribute has been defined yet") });
-                continue;
-            }
-
-            if (trimmed_line == EMPTY_LINE_MARK) {
-                entry.values.append(QStringLiteral("\n"));
-                continue;
-            }
-
-            entry.values.append(trimmed_line.toString());
-            continue;
-        }
-
-        // either a new entry or error - in both cases, the previous entry should be closed
-        close_current_attrib();
-
-        // empty line, skip
-        if (trimmed_line.isEmpty())
-            continue;
-
-        // keyval pair (after the multiline check)
-        const auto rx_keyval_match = rx_keyval.match(trimmed_line);
-        if (rx_keyval_match.hasMatch()) {
-            // the key is never empty if the regex matches the *trimmed* line
-            entry.key = rx_keyval_match.capturedRef(1).trimmed().toString().toLower();
-
-            // the value can be empty here, if it's purely multiline
-            auto value_part = rx_keyval_match.capturedRef(2).trimmed();
-            if (!value_part.isEmpty())
-                entry.values.append(value_part.toString());
-
-            entry.line = linenum;
-            continue;
-        }
-
-        // invalid line
-        onError({ linenum, tr_log("line invalid, skipped") });
+        parser.parseLine(linenum, QStringRef(&line));
     }
 
-    // the very last line
-    linenum++;
-    close_current_attrib();
+    parser.finish();
 }
 
 
@@ -18,6 +18,7 @@
 #include "FrontendLayer.h"
 
 #include "Paths.h"
+#include "Trace.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkDiskCache>
@@ -59,6 +60,7 @@ FrontendLayer::FrontendLayer(QObject* const api, QObject* parent)
 void FrontendLayer::rebuild()
 {
     Q_ASSERT(!m_engine);
+    const TraceSpan span("FrontendLayer::rebuild");
 
     m_engine = new QQmlApplicationEngine(this);
     m_engine->addImportPath(QStringLiteral("lib/qml"));
@@ -57,23 +57,23 @@ void ProcessLauncher::onLaunchRequested(const model::GameFile* gamefile)
 
     // TODO: in the future, check the gamefile's own launch command first
 
-    QString launch_cmd = game->data().launch_cmd;
+    QString launch_cmd = game->launchCmd();
 
     if (!launch_cmd.isEmpty())
-        format_launch_command(launch_cmd, gamefile->data().fileinfo);
+        format_launch_command(launch_cmd, gamefile->fileinfo());
 
     if (launch_cmd.isEmpty()) {
         qInfo().noquote()
             << tr_log("Cannot launch the game `%1` because there is no launch command defined for it!")
-               .arg(game->data().title);
+               .arg(game->title());
         emit processLaunchError();
         return;
     }
 
 
-    QString workdir = game->data().launch_workdir;
+    QString workdir = game->launchWorkdir();
     if (workdir.isEmpty())
-        workdir = gamefile->data().fileinfo.absolutePath();
+        workdir = gamefile->fileinfo().absolutePath();
 
 
     beforeRun();
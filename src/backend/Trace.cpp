@@ -0,0 +1,166 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Trace.h"
+
+#include "AppSettings.h"
+#include "LocaleUtils.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+
+namespace {
+static constexpr auto MSG_PREFIX = "Trace:";
+
+// NOTE: the events are kept in memory until the program exits, including the ones
+// of every rescan, so their number is limited (to a few tens of megabytes at most)
+constexpr size_t MAX_EVENTS = 100000;
+
+struct Event {
+    const char* name;
+    QString detail;
+    qint64 start_us;
+    qint64 end_us;
+    quintptr thread_id;
+};
+
+std::atomic<bool> g_enabled(false);
+QString g_path;
+QElapsedTimer g_timer;
+QMutex g_mutex;
+std::vector<Event> g_events;
+size_t g_dropped_events = 0;
+
+QJsonObject event_to_json(const Event& event)
+{
+    QJsonObject obj {
+        { QStringLiteral("name"), QString::fromLatin1(event.name) },
+        { QStringLiteral("ph"), QStringLiteral("X") },
+        { QStringLiteral("ts"), static_cast<double>(event.start_us) },
+        { QStringLiteral("dur"), static_cast<double>(event.end_us - event.start_us) },
+        { QStringLiteral("pid"), 1 },
+        { QStringLiteral("tid"), static_cast<double>(event.thread_id) },
+    };
+    if (!event.detail.isEmpty())
+        obj.insert(QStringLiteral("args"), QJsonObject {{ QStringLiteral("detail"), event.detail }});
+
+    return obj;
+}
+} // namespace
+
+
+void Trace::init()
+{
+    g_path = AppSettings::general.trace_path;
+    if (g_path.isEmpty())
+        return;
+
+    g_timer.start();
+    g_enabled = true;
+    qInfo().noquote() << MSG_PREFIX << tr_log("recording timing information into `%1`").arg(g_path);
+}
+
+void Trace::close()
+{
+    if (!enabled())
+        return;
+
+    write();
+    g_enabled = false;
+}
+
+bool Trace::enabled()
+{
+    return g_enabled;
+}
+
+qint64 Trace::now()
+{
+    return g_timer.nsecsElapsed() / 1000;
+}
+
+void Trace::addSpan(const char* name, const QString& detail, qint64 start_us, qint64 end_us)
+{
+    const auto thread_id = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    {
+        QMutexLocker lock(&g_mutex);
+        if (g_events.size() < MAX_EVENTS) {
+            g_events.push_back({ name, detail, start_us, end_us, thread_id });
+            return;
+        }
+        if (g_dropped_events++ > 0)
+            return;
+    }
+
+    qWarning().noquote() << MSG_PREFIX
+        << tr_log("the limit of %1 events was reached, further events are not recorded").arg(MAX_EVENTS);
+}
+
+void Trace::write()
+{
+    if (!enabled())
+        return;
+
+    QJsonArray events;
+    {
+        QMutexLocker lock(&g_mutex);
+        for (const Event& event : g_events)
+            events.append(event_to_json(event));
+    }
+
+    const QJsonObject root {
+        { QStringLiteral("traceEvents"), events },
+        { QStringLiteral("displayTimeUnit"), QStringLiteral("ms") },
+    };
+
+    QSaveFile file(g_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning().noquote() << MSG_PREFIX << tr_log("could not open `%1` for writing").arg(g_path);
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit())
+        qWarning().noquote() << MSG_PREFIX << tr_log("failed to write `%1`").arg(g_path);
+}
+
+
+TraceSpan::TraceSpan(const char* name)
+    : TraceSpan(name, QString())
+{}
+
+TraceSpan::TraceSpan(const char* name, QString detail)
+    : m_name(name)
+    , m_detail(std::move(detail))
+    , m_start_us(Trace::enabled() ? Trace::now() : -1)
+{}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_start_us < 0 || !Trace::enabled())
+        return;
+
+    Trace::addSpan(m_name, m_detail, m_start_us, Trace::now());
+}
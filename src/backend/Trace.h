@@ -0,0 +1,58 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "utils/NoCopyNoMove.h"
+
+#include <QString>
+#include <QtGlobal>
+
+
+/// Collects timing information about the important steps of the program,
+/// and writes them in the Chrome trace event format (viewable in
+/// chrome://tracing or Perfetto). Disabled unless a trace file is set.
+class Trace {
+public:
+    Trace() = delete;
+    NO_COPY_NO_MOVE(Trace)
+
+    static void init();
+    static void close();
+
+    static bool enabled();
+    /// Writes the events recorded so far into the trace file
+    static void write();
+
+    /// Microseconds since the initialization of the tracer
+    static qint64 now();
+    static void addSpan(const char* name, const QString& detail, qint64 start_us, qint64 end_us);
+};
+
+
+/// Records the time between its construction and destruction as a trace event
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name);
+    explicit TraceSpan(const char* name, QString detail);
+    ~TraceSpan();
+    NO_COPY_NO_MOVE(TraceSpan)
+
+private:
+    const char* const m_name;
+    const QString m_detail;
+    const qint64 m_start_us;
+};
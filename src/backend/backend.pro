@@ -1,6 +1,6 @@
 TEMPLATE = lib
 
-QT += qml quick gamepad sql
+QT += qml quick gamepad sql concurrent
 CONFIG += c++11 staticlib warn_on exceptions_off
 android: QT += androidextras
 
@@ -17,7 +17,8 @@ SOURCES += \
     ScriptRunner.cpp \
     Paths.cpp \
     AppSettings.cpp \
-    Log.cpp
+    Log.cpp \
+    Trace.cpp
 
 HEADERS += \
     Api.h \
@@ -33,6 +34,7 @@ HEADERS += \
     Paths.h \
     AppSettings.h \
     Log.h \
+    Trace.h \
 
 include(configfiles/configfiles.pri)
 include(platform/platform.pri)
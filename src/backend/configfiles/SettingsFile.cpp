@@ -53,6 +53,7 @@ ConfigEntryMaps::ConfigEntryMaps()
         { QStringLiteral("portable"), GeneralOption::PORTABLE },
         { QStringLiteral("silent"), GeneralOption::SILENT },
         { QStringLiteral("fullscreen"), GeneralOption::FULLSCREEN },
+        { QStringLiteral("sort-ignore-articles"), GeneralOption::SORT_IGNORE_ARTICLES },
         { QStringLiteral("locale"), GeneralOption::LOCALE },
         { QStringLiteral("theme"), GeneralOption::THEME },
     }
@@ -167,6 +168,10 @@ void LoadContext::handle_general_attrib(const int lineno, const QString& key, co
             strconv.store_maybe(AppSettings::general.fullscreen, val,
                 [&](){ log_needs_bool(lineno, key); });
             break;
+        case ConfigEntryGeneralOption::SORT_IGNORE_ARTICLES:
+            strconv.store_maybe(AppSettings::general.sort_ignore_articles, val,
+                [&](){ log_needs_bool(lineno, key); });
+            break;
         case ConfigEntryGeneralOption::LOCALE:
             AppSettings::general.locale = val;
             break;
@@ -273,6 +278,7 @@ void SaveContext::print_general(QTextStream& stream) const
 
     GeneralStrMap option_values {
         { GeneralOption::FULLSCREEN, AppSettings::general.fullscreen ? STR_TRUE : STR_FALSE },
+        { GeneralOption::SORT_IGNORE_ARTICLES, AppSettings::general.sort_ignore_articles ? STR_TRUE : STR_FALSE },
         { GeneralOption::LOCALE, AppSettings::general.locale },
         { GeneralOption::THEME, AppSettings::general.theme },
     };
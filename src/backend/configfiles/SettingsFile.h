@@ -40,6 +40,7 @@ enum class ConfigEntryGeneralOption : unsigned char {
     PORTABLE,
     SILENT,
     FULLSCREEN,
+    SORT_IGNORE_ARTICLES,
     LOCALE,
     THEME,
 };
@@ -20,17 +20,32 @@
 
 namespace model {
 
-Collection::Collection(modeldata::Collection collection, QObject* parent)
+Collection::Collection(modeldata::Collection collection, Library& library, QObject* parent)
     : QObject(parent)
-    , m_games(this)
+    , m_games(library, this)
     , m_collection(std::move(collection))
     , m_assets(&m_collection.assets, this)
 {}
 
-void Collection::setGameList(QVector<Game*> games)
+void Collection::setGameList(std::vector<size_t> games)
 {
-    m_games.clear();
-    m_games.append(std::move(games));
+    m_games.setEntries(std::move(games));
+}
+
+void Collection::updateStaticData(modeldata::Collection collection)
+{
+    Q_ASSERT(m_collection.name == collection.name);
+
+    if (!collection.shortName().isEmpty())
+        m_collection.setShortName(collection.shortName());
+    m_collection.summary = std::move(collection.summary);
+    m_collection.description = std::move(collection.description);
+    m_collection.launch_cmd = std::move(collection.launch_cmd);
+    m_collection.launch_workdir = std::move(collection.launch_workdir);
+    m_collection.assets = std::move(collection.assets);
+
+    emit staticDataChanged();
+    emit m_assets.assetsChanged();
 }
 
 } // namespace model
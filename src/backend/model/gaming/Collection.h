@@ -17,15 +17,15 @@
 
 #pragma once
 
-#include "Game.h"
 #include "GameAssets.h"
+#include "GameList.h"
 #include "modeldata/gaming/CollectionData.h"
+#include "utils/QmlHelpers.h"
 
-#include "QtQmlTricks/QQmlObjectListModel.h"
 #include <QString>
-#include <QVector>
+#include <vector>
 
-namespace model { class Game; }
+namespace model { class Library; }
 
 
 namespace model {
@@ -33,16 +33,20 @@ class Collection : public QObject {
     Q_OBJECT
 
     Q_PROPERTY(QString name READ name CONSTANT)
-    Q_PROPERTY(QString shortName READ shortName CONSTANT)
-    Q_PROPERTY(QString summary READ summary CONSTANT)
-    Q_PROPERTY(QString description READ description CONSTANT)
+    Q_PROPERTY(QString shortName READ shortName NOTIFY staticDataChanged)
+    Q_PROPERTY(QString summary READ summary NOTIFY staticDataChanged)
+    Q_PROPERTY(QString description READ description NOTIFY staticDataChanged)
     Q_PROPERTY(model::GameAssets* defaultAssets READ assetsPtr CONSTANT)
-    QML_OBJMODEL_PROPERTY(model::Game, games)
+    QML_CONST_PROPERTY(model::GameList, games)
 
 public:
-    explicit Collection(modeldata::Collection, QObject* parent = nullptr);
+    explicit Collection(modeldata::Collection, Library&, QObject* parent = nullptr);
 
-    void setGameList(QVector<Game*>);
+    /// Sets the games of the collection, by their index in the library's store
+    void setGameList(std::vector<size_t>);
+    const modeldata::Collection& data() const { return m_collection; }
+    /// Replaces the metadata and assets with the ones found by a later search
+    void updateStaticData(modeldata::Collection);
 
 public:
     const QString& name() const { return m_collection.name; }
@@ -52,6 +56,9 @@ public:
 
     GameAssets* assetsPtr() { return &m_assets; }
 
+signals:
+    void staticDataChanged();
+
 private:
     modeldata::Collection m_collection;
     GameAssets m_assets;
@@ -17,55 +17,92 @@
 
 #include "Game.h"
 
+#include "Library.h"
+
+
+namespace {
+QString joined_list(const QStringList& list) { return list.join(QLatin1String(", ")); }
+} // namespace
+
 
 namespace model {
 
-Game::Game(modeldata::Game game, QObject* parent)
+Game::Game(Library& library, size_t idx, QObject* parent)
     : QObject(parent)
     , m_files(this)
-    , m_game(std::move(game))
-    , m_assets(&m_game.assets, this)
+    , m_library(library)
+    , m_idx(idx)
+    , m_assets_data(library.store().assets(idx))
+    , m_assets(&m_assets_data, this)
 {
-    for (modeldata::GameFile& entry : m_game.files) {
-        auto gamefile = new model::GameFile(std::move(entry), this);
+    const modeldata::GameStore& store = m_library.store();
+    const size_t first_file = store.firstFile(m_idx);
+
+    for (size_t i = 0; i < store.fileCount(m_idx); i++) {
+        auto gamefile = new model::GameFile(m_library, first_file + i, this);
 
         connect(gamefile, &model::GameFile::playStatsChanged,
                 this, &model::Game::playStatsChanged);
 
         m_files.append(gamefile);
     }
-
-    m_game.files.clear();
 }
 
-void Game::setFavorite(bool new_val)
+void Game::updateIndex(size_t idx)
 {
-    m_game.is_favorite = new_val;
+    m_idx = idx;
+
+    // NOTE: the library keeps the object only if the files are the same
+    const size_t first_file = m_library.store().firstFile(m_idx);
+    for (int i = 0; i < m_files.count(); i++)
+        m_files.at(i)->updateIndex(first_file + static_cast<size_t>(i));
+
+    m_assets_data = m_library.store().assets(m_idx);
+
+    emit staticDataChanged();
     emit favoriteChanged();
+    emit playStatsChanged();
+    emit m_assets.assetsChanged();
 }
 
+QString Game::title() const { return m_library.store().title(m_idx); }
+QString Game::summary() const { return m_library.store().summary(m_idx); }
+QString Game::description() const { return m_library.store().description(m_idx); }
+QString Game::launchCmd() const { return m_library.store().launchCmd(m_idx); }
+QString Game::launchWorkdir() const { return m_library.store().launchWorkdir(m_idx); }
+
+QStringList Game::developerList() const { return m_library.store().developers(m_idx); }
+QStringList Game::publisherList() const { return m_library.store().publishers(m_idx); }
+QStringList Game::genreList() const { return m_library.store().genres(m_idx); }
+QString Game::developerString() const { return joined_list(developerList()); }
+QString Game::publisherString() const { return joined_list(publisherList()); }
+QString Game::genreString() const { return joined_list(genreList()); }
+
+int Game::players() const { return m_library.store().playerCount(m_idx); }
+float Game::rating() const { return m_library.store().rating(m_idx); }
+QDate Game::release() const { return m_library.store().releaseDate(m_idx); }
+
+bool Game::favorite() const
+{
+    return m_library.store().isFavorite(m_idx);
+}
+
+void Game::setFavorite(bool new_val)
+{
+    m_library.setFavorite(m_idx, new_val);
+}
 
 int Game::playCount() const
 {
-    return std::accumulate(filesConst().cbegin(), filesConst().cend(), 0,
-        [](int sum, const model::GameFile* const gamefile){
-            return sum + gamefile->playCount();
-        });
+    return m_library.playCount(m_idx);
 }
 qint64 Game::playTime() const
 {
-    return std::accumulate(filesConst().cbegin(), filesConst().cend(), 0,
-        [](qint64 sum, const model::GameFile* const gamefile){
-            return sum + gamefile->playTime();
-        });
+    return m_library.playTime(m_idx);
 }
 QDateTime Game::lastPlayed() const
 {
-    const auto it = std::max_element(filesConst().cbegin(), filesConst().cend(),
-        [](const model::GameFile* const a, const model::GameFile* const b){
-            return a->lastPlayed() < b->lastPlayed();
-        });
-    return (*it)->lastPlayed();
+    return m_library.lastPlayed(m_idx);
 }
 
 void Game::launch()
@@ -19,52 +19,40 @@
 
 #include "GameAssets.h"
 #include "GameFile.h"
-#include "modeldata/gaming/CollectionData.h"
-#include "modeldata/gaming/GameData.h"
+#include "modeldata/gaming/GameAssetsData.h"
 
 #include "QtQmlTricks/QQmlObjectListModel.h"
+#include <QDate>
+#include <QDateTime>
 #include <QObject>
+#include <QStringList>
 
-
-namespace {
-QString joined_list(const QStringList& list) { return list.join(QLatin1String(", ")); }
-} // namespace
-
-
-#define CPROP_Q(type, apiName) \
-    private: Q_PROPERTY(type apiName READ apiName CONSTANT)
-
-#define CPROP_REF(type, apiName, dataField) \
-    public: const type& apiName() const { return m_game.dataField; } \
-    CPROP_Q(type, apiName)
-
-#define CPROP_POD(type, apiName, dataField) \
-    public: type apiName() const { return m_game.dataField; } \
-    CPROP_Q(type, apiName)
+namespace model { class Library; }
 
 
 namespace model {
+/// A view of a single game of the library
 class Game : public QObject {
     Q_OBJECT
 
-    CPROP_REF(QString, title, title)
-    CPROP_REF(QString, summary, summary)
-    CPROP_REF(QString, description, description)
+    Q_PROPERTY(QString title READ title NOTIFY staticDataChanged)
+    Q_PROPERTY(QString summary READ summary NOTIFY staticDataChanged)
+    Q_PROPERTY(QString description READ description NOTIFY staticDataChanged)
 
-    Q_PROPERTY(QString developer READ developerString CONSTANT)
-    Q_PROPERTY(QString publisher READ publisherString CONSTANT)
-    Q_PROPERTY(QString genre READ genreString CONSTANT)
-    CPROP_REF(QStringList, developerList, developers)
-    CPROP_REF(QStringList, publisherList, publishers)
-    CPROP_REF(QStringList, genreList, genres)
+    Q_PROPERTY(QString developer READ developerString NOTIFY staticDataChanged)
+    Q_PROPERTY(QString publisher READ publisherString NOTIFY staticDataChanged)
+    Q_PROPERTY(QString genre READ genreString NOTIFY staticDataChanged)
+    Q_PROPERTY(QStringList developerList READ developerList NOTIFY staticDataChanged)
+    Q_PROPERTY(QStringList publisherList READ publisherList NOTIFY staticDataChanged)
+    Q_PROPERTY(QStringList genreList READ genreList NOTIFY staticDataChanged)
 
-    CPROP_POD(int, players, player_count)
-    CPROP_POD(float, rating, rating)
+    Q_PROPERTY(int players READ players NOTIFY staticDataChanged)
+    Q_PROPERTY(float rating READ rating NOTIFY staticDataChanged)
 
-    CPROP_REF(QDate, release, release_date)
-    CPROP_POD(int, releaseYear, release_date.year())
-    CPROP_POD(int, releaseMonth, release_date.month())
-    CPROP_POD(int, releaseDay, release_date.day())
+    Q_PROPERTY(QDate release READ release NOTIFY staticDataChanged)
+    Q_PROPERTY(int releaseYear READ releaseYear NOTIFY staticDataChanged)
+    Q_PROPERTY(int releaseMonth READ releaseMonth NOTIFY staticDataChanged)
+    Q_PROPERTY(int releaseDay READ releaseDay NOTIFY staticDataChanged)
 
     Q_PROPERTY(bool favorite READ favorite WRITE setFavorite NOTIFY favoriteChanged)
     Q_PROPERTY(int playCount READ playCount NOTIFY playStatsChanged)
@@ -75,22 +63,43 @@ class Game : public QObject {
     QML_OBJMODEL_PROPERTY(model::GameFile, files)
 
 public:
-    explicit Game(modeldata::Game, QObject* parent = nullptr);
+    /// The objects are created by the library, see Library::game
+    explicit Game(Library&, size_t idx, QObject* parent = nullptr);
 
     Q_INVOKABLE void launch();
 
-    const modeldata::Game& data() const { return m_game; }
-    void setFavorite(bool);
+    /// The position of the game in the store of the library
+    size_t index() const { return m_idx; }
+    /// Called by the library when the store gets replaced, and the data
+    /// of this game is now at a different position
+    void updateIndex(size_t);
 
 public:
     // a workaround for const pointer issues with the model
     const QVector<model::GameFile*>& filesConst() const { return m_files.asList(); }
 
-    QString developerString() const { return joined_list(m_game.developers); }
-    QString publisherString() const { return joined_list(m_game.publishers); }
-    QString genreString() const { return joined_list(m_game.genres); }
-
-    bool favorite() const { return m_game.is_favorite; }
+    QString title() const;
+    QString summary() const;
+    QString description() const;
+    QString launchCmd() const;
+    QString launchWorkdir() const;
+
+    QStringList developerList() const;
+    QStringList publisherList() const;
+    QStringList genreList() const;
+    QString developerString() const;
+    QString publisherString() const;
+    QString genreString() const;
+
+    int players() const;
+    float rating() const;
+    QDate release() const;
+    int releaseYear() const { return release().year(); }
+    int releaseMonth() const { return release().month(); }
+    int releaseDay() const { return release().day(); }
+
+    bool favorite() const;
+    void setFavorite(bool);
     int playCount() const;
     qint64 playTime() const;
     QDateTime lastPlayed() const;
@@ -101,14 +110,12 @@ signals:
     void launchFileSelectorRequested();
     void favoriteChanged();
     void playStatsChanged();
+    void staticDataChanged();
 
 private:
-    modeldata::Game m_game;
+    Library& m_library;
+    size_t m_idx;
+    modeldata::GameAssets m_assets_data;
     GameAssets m_assets;
 };
 } // namespace model
-
-
-#undef CPROP_REF
-#undef CPROP_POD
-#undef CPROP_Q
@@ -23,7 +23,7 @@
 
 
 #define SINGLE_ASSET_PROP(api_name, asset_type) \
-    Q_PROPERTY(QString api_name READ api_name CONSTANT) \
+    Q_PROPERTY(QString api_name READ api_name NOTIFY assetsChanged) \
     const QString& api_name() const { return m_assets->single(AssetType::asset_type); }
 
 
@@ -57,12 +57,16 @@ class GameAssets : public QObject {
 
     // TODO: these could be optimized, see
     // https://doc.qt.io/qt-5/qtqml-cppintegration-data.html (Sequence Type to JavaScript Array)
-    Q_PROPERTY(QStringList screenshots READ screenshots CONSTANT)
-    Q_PROPERTY(QStringList videos READ videos CONSTANT)
+    Q_PROPERTY(QStringList screenshots READ screenshots NOTIFY assetsChanged)
+    Q_PROPERTY(QStringList videos READ videos NOTIFY assetsChanged)
 
 public:
     explicit GameAssets(modeldata::GameAssets* const, QObject* parent = nullptr);
 
+signals:
+    // emitted by the owner when the underlying data gets replaced
+    void assetsChanged();
+
 private:
     const QStringList& screenshots() { return m_assets->multi(AssetType::SCREENSHOTS); }
     const QStringList& videos() { return m_assets->multi(AssetType::VIDEOS); }
@@ -17,11 +17,14 @@
 
 #include "GameFile.h"
 
+#include "Library.h"
+
 
 namespace model {
-GameFile::GameFile(modeldata::GameFile data, QObject* parent)
+GameFile::GameFile(Library& library, size_t file_idx, QObject* parent)
     : QObject(parent)
-    , m_data(std::move(data))
+    , m_library(library)
+    , m_idx(file_idx)
 {}
 
 void GameFile::launch()
@@ -29,21 +32,17 @@ void GameFile::launch()
     emit launchRequested();
 }
 
-// This one is for summing the play times provided by multiple Providers.
-void GameFile::addPlayStats(int playcount, qint64 playtime, const QDateTime& last_played)
-{
-    m_data.last_played = std::max(m_data.last_played, last_played);
-    m_data.play_time += playtime;
-    m_data.play_count += playcount;
-    emit playStatsChanged();
-}
+QFileInfo GameFile::fileinfo() const { return m_library.store().fileInfo(m_idx); }
+QString GameFile::path() const { return m_library.store().filePath(m_idx); }
+QString GameFile::name() const { return m_library.store().fileName(m_idx); }
+QString GameFile::canonicalPath() const { return m_library.store().canonicalPath(m_idx); }
+int GameFile::playCount() const { return m_library.store().playCount(m_idx); }
+qint64 GameFile::playTime() const { return m_library.store().playTime(m_idx); }
+QDateTime GameFile::lastPlayed() const { return m_library.store().lastPlayed(m_idx); }
 
-// This one is a single update for playtime when the game finishes.
 void GameFile::updatePlayTime(qint64 duration, QDateTime time_finished)
 {
-    m_data.last_played = std::move(time_finished);
-    m_data.play_time += duration;
-    m_data.play_count++;
-    emit playStatsChanged();
+    // NOTE: the library emits the change signals
+    m_library.updatePlayTime(m_idx, duration, std::move(time_finished));
 }
 } // namespace model
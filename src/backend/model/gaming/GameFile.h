@@ -17,13 +17,16 @@
 
 #pragma once
 
-#include "modeldata/gaming/GameData.h"
-
+#include <QDateTime>
+#include <QFileInfo>
 #include <QObject>
 #include <QString>
 
+namespace model { class Library; }
+
 
 namespace model {
+/// A view of a single file of a game
 class GameFile : public QObject {
     Q_OBJECT
     Q_PROPERTY(QString name READ name CONSTANT)
@@ -33,21 +36,25 @@ class GameFile : public QObject {
     Q_PROPERTY(QDateTime lastPlayed READ lastPlayed NOTIFY playStatsChanged)
 
 public:
-    explicit GameFile(modeldata::GameFile, QObject*);
+    explicit GameFile(Library&, size_t file_idx, QObject*);
 
     Q_INVOKABLE void launch();
 
-    const modeldata::GameFile& data() const { return m_data; }
+    /// The position of the file in the store of the library
+    size_t index() const { return m_idx; }
+    void updateIndex(size_t idx) { m_idx = idx; }
 
 public:
-    const QString& name() const { return m_data.name; }
-    QString path() const { return m_data.fileinfo.filePath(); }
-    int playCount() const { return m_data.play_count; }
-    qint64 playTime() const { return m_data.play_time; }
-    QDateTime lastPlayed() const { return m_data.last_played; }
+    QFileInfo fileinfo() const;
+    QString name() const;
+    QString path() const;
+    QString canonicalPath() const;
+    int playCount() const;
+    qint64 playTime() const;
+    QDateTime lastPlayed() const;
 
 public:
-    void addPlayStats(int playcount, qint64 playtime, const QDateTime& last_played);
+    /// A single update for the play stats when the game finishes
     void updatePlayTime(qint64 duration, QDateTime time_finished);
 
 signals:
@@ -55,6 +62,7 @@ signals:
     void playStatsChanged();
 
 private:
-    modeldata::GameFile m_data;
+    Library& m_library;
+    size_t m_idx;
 };
 } // namespace model
@@ -0,0 +1,304 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "GameList.h"
+
+#include "Game.h"
+#include "Library.h"
+#include "utils/HashMap.h"
+
+#include <algorithm>
+
+
+namespace {
+QString joined_list(const QStringList& list) { return list.join(QLatin1String(", ")); }
+} // namespace
+
+
+namespace model {
+
+GameList::GameList(Library& library, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_library(library)
+{
+    connect(&m_library, &Library::gameChanged,
+            this, &GameList::onGameChanged);
+}
+
+int GameList::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+QHash<int, QByteArray> GameList::roleNames() const
+{
+    // NOTE: the role names match the properties of the game objects
+    static const QHash<int, QByteArray> ROLE_NAMES {
+        { ModelDataRole, QByteArrayLiteral("modelData") },
+        { TitleRole, QByteArrayLiteral("title") },
+        { SummaryRole, QByteArrayLiteral("summary") },
+        { DescriptionRole, QByteArrayLiteral("description") },
+        { DeveloperRole, QByteArrayLiteral("developer") },
+        { PublisherRole, QByteArrayLiteral("publisher") },
+        { GenreRole, QByteArrayLiteral("genre") },
+        { DeveloperListRole, QByteArrayLiteral("developerList") },
+        { PublisherListRole, QByteArrayLiteral("publisherList") },
+        { GenreListRole, QByteArrayLiteral("genreList") },
+        { PlayersRole, QByteArrayLiteral("players") },
+        { RatingRole, QByteArrayLiteral("rating") },
+        { ReleaseRole, QByteArrayLiteral("release") },
+        { ReleaseYearRole, QByteArrayLiteral("releaseYear") },
+        { ReleaseMonthRole, QByteArrayLiteral("releaseMonth") },
+        { ReleaseDayRole, QByteArrayLiteral("releaseDay") },
+        { FavoriteRole, QByteArrayLiteral("favorite") },
+        { PlayCountRole, QByteArrayLiteral("playCount") },
+        { PlayTimeRole, QByteArrayLiteral("playTime") },
+        { LastPlayedRole, QByteArrayLiteral("lastPlayed") },
+        { AssetsRole, QByteArrayLiteral("assets") },
+        { FilesRole, QByteArrayLiteral("files") },
+    };
+    return ROLE_NAMES;
+}
+
+QVariant GameList::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= count())
+        return QVariant();
+
+    const size_t idx = m_entries[static_cast<size_t>(index.row())];
+    const modeldata::GameStore& store = m_library.store();
+
+    switch (role) {
+        case ModelDataRole:
+            return QVariant::fromValue(static_cast<QObject*>(m_library.game(idx)));
+        case TitleRole:
+            return store.title(idx);
+        case SummaryRole:
+            return store.summary(idx);
+        case DescriptionRole:
+            return store.description(idx);
+        case DeveloperRole:
+            return joined_list(store.developers(idx));
+        case PublisherRole:
+            return joined_list(store.publishers(idx));
+        case GenreRole:
+            return joined_list(store.genres(idx));
+        case DeveloperListRole:
+            return store.developers(idx);
+        case PublisherListRole:
+            return store.publishers(idx);
+        case GenreListRole:
+            return store.genres(idx);
+        case PlayersRole:
+            return static_cast<int>(store.playerCount(idx));
+        case RatingRole:
+            return store.rating(idx);
+        case ReleaseRole:
+            return store.releaseDate(idx);
+        case ReleaseYearRole:
+            return store.releaseDate(idx).year();
+        case ReleaseMonthRole:
+            return store.releaseDate(idx).month();
+        case ReleaseDayRole:
+            return store.releaseDate(idx).day();
+        case FavoriteRole:
+            return store.isFavorite(idx);
+        case PlayCountRole:
+            return m_library.playCount(idx);
+        case PlayTimeRole:
+            return m_library.playTime(idx);
+        case LastPlayedRole:
+            return m_library.lastPlayed(idx);
+        case AssetsRole:
+            return QVariant::fromValue(m_library.game(idx)->assetsPtr());
+        case FilesRole:
+            return QVariant::fromValue(static_cast<QQmlObjectListModelBase*>(m_library.game(idx)->files()));
+        default:
+            return QVariant();
+    }
+}
+
+bool GameList::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || index.row() >= count() || role != FavoriteRole)
+        return false;
+
+    // NOTE: the change signal is emitted by the library
+    const size_t idx = m_entries[static_cast<size_t>(index.row())];
+    m_library.setFavorite(idx, value.toBool());
+    return true;
+}
+
+Game* GameList::at(int row) const
+{
+    if (row < 0 || row >= count())
+        return nullptr;
+
+    return m_library.game(m_entries[static_cast<size_t>(row)]);
+}
+
+QObject* GameList::get(int row) const
+{
+    return at(row);
+}
+
+int GameList::indexOf(QObject* item) const
+{
+    const Game* const game = qobject_cast<Game*>(item);
+    if (!game)
+        return -1;
+
+    const auto it = std::find(m_entries.cbegin(), m_entries.cend(), game->index());
+    return it != m_entries.cend()
+        ? static_cast<int>(it - m_entries.cbegin())
+        : -1;
+}
+
+QVariantList GameList::toVarArray() const
+{
+    QVariantList list;
+    list.reserve(count());
+    for (const size_t idx : m_entries)
+        list.append(QVariant::fromValue(static_cast<QObject*>(m_library.game(idx))));
+
+    return list;
+}
+
+void GameList::setEntries(std::vector<size_t> entries)
+{
+    const bool count_changed = entries.size() != m_entries.size();
+
+    beginResetModel();
+    m_entries = std::move(entries);
+    endResetModel();
+
+    if (count_changed)
+        emit countChanged();
+}
+
+void GameList::removeEntries(const std::function<bool(size_t)>& predicate)
+{
+    const int old_count = count();
+
+    int row = old_count - 1;
+    while (row >= 0) {
+        if (!predicate(m_entries[static_cast<size_t>(row)])) {
+            row--;
+            continue;
+        }
+
+        const int last = row;
+        while (row > 0 && predicate(m_entries[static_cast<size_t>(row - 1)]))
+            row--;
+
+        beginRemoveRows(QModelIndex(), row, last);
+        m_entries.erase(m_entries.begin() + row, m_entries.begin() + last + 1);
+        endRemoveRows();
+
+        row--;
+    }
+
+    if (old_count != count())
+        emit countChanged();
+}
+
+void GameList::remapEntries(const std::vector<size_t>& new_indices)
+{
+    for (size_t& entry : m_entries) {
+        entry = new_indices[entry];
+        Q_ASSERT(entry != Library::NO_GAME);
+    }
+}
+
+void GameList::insertEntries(const std::vector<size_t>& entries, const std::vector<quint32>& ranks)
+{
+    // NOTE: equal titles are ordered by index
+    const auto rank_less = [&ranks](size_t a, size_t b){
+        return ranks[a] < ranks[b] || (ranks[a] == ranks[b] && a < b);
+    };
+    Q_ASSERT(std::is_sorted(entries.cbegin(), entries.cend(), rank_less));
+
+    if (entries.empty())
+        return;
+
+    // insert the new entries in groups, between the existing ones
+    size_t pos = 0;
+    auto it = entries.cbegin();
+    while (it != entries.cend()) {
+        while (pos < m_entries.size() && !rank_less(*it, m_entries[pos]))
+            pos++;
+
+        auto group_end = it;
+        while (group_end != entries.cend() && (pos == m_entries.size() || rank_less(*group_end, m_entries[pos])))
+            ++group_end;
+
+        const int group_size = static_cast<int>(group_end - it);
+        beginInsertRows(QModelIndex(), static_cast<int>(pos), static_cast<int>(pos) + group_size - 1);
+        m_entries.insert(m_entries.begin() + static_cast<std::ptrdiff_t>(pos), it, group_end);
+        endInsertRows();
+
+        pos += static_cast<size_t>(group_size);
+        it = group_end;
+    }
+
+    emit countChanged();
+}
+
+void GameList::refresh()
+{
+    if (!m_entries.empty())
+        emit dataChanged(index(0), index(count() - 1));
+}
+
+void GameList::sortEntries(const std::vector<quint32>& ranks)
+{
+    emit layoutAboutToBeChanged();
+
+    const std::vector<size_t> old_entries = m_entries;
+    std::sort(m_entries.begin(), m_entries.end(),
+        [&ranks](size_t a, size_t b){ return ranks[a] < ranks[b] || (ranks[a] == ranks[b] && a < b); });
+
+    // the views may still hold indices to the previous rows
+    const QModelIndexList old_persistent = persistentIndexList();
+    if (!old_persistent.isEmpty()) {
+        HashMap<size_t, int> new_rows;
+        new_rows.reserve(m_entries.size());
+        for (size_t row = 0; row < m_entries.size(); row++)
+            new_rows.emplace(m_entries[row], static_cast<int>(row));
+
+        QModelIndexList new_persistent;
+        new_persistent.reserve(old_persistent.size());
+        for (const QModelIndex& old_idx : old_persistent) {
+            const size_t game_idx = old_entries[static_cast<size_t>(old_idx.row())];
+            new_persistent << index(new_rows.at(game_idx), old_idx.column());
+        }
+        changePersistentIndexList(old_persistent, new_persistent);
+    }
+
+    emit layoutChanged();
+}
+
+void GameList::onGameChanged(size_t idx)
+{
+    for (size_t row = 0; row < m_entries.size(); row++) {
+        if (m_entries[row] == idx) {
+            const QModelIndex model_idx = index(static_cast<int>(row));
+            emit dataChanged(model_idx, model_idx);
+        }
+    }
+}
+
+} // namespace model
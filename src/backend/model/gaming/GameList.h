@@ -0,0 +1,112 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QVariantList>
+#include <functional>
+#include <vector>
+
+namespace model { class Game; }
+namespace model { class Library; }
+
+
+namespace model {
+
+/// A list of games, serving its data directly from the library's store.
+/// The game objects are only created when they are explicitly requested
+/// (eg. with `get` or the `modelData` role). For QML, the list provides
+/// the same roles and methods as the object list models.
+class GameList : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit GameList(Library&, QObject* parent = nullptr);
+
+    enum Roles {
+        ModelDataRole = Qt::UserRole + 1,
+        TitleRole,
+        SummaryRole,
+        DescriptionRole,
+        DeveloperRole,
+        PublisherRole,
+        GenreRole,
+        DeveloperListRole,
+        PublisherListRole,
+        GenreListRole,
+        PlayersRole,
+        RatingRole,
+        ReleaseRole,
+        ReleaseYearRole,
+        ReleaseMonthRole,
+        ReleaseDayRole,
+        FavoriteRole,
+        PlayCountRole,
+        PlayTimeRole,
+        LastPlayedRole,
+        AssetsRole,
+        FilesRole,
+    };
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role) override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return static_cast<int>(m_entries.size()); }
+    /// The positions of the games in the library's store, in list order
+    const std::vector<size_t>& entries() const { return m_entries; }
+    /// Returns the object of the game in the row, creating it if necessary
+    Game* at(int row) const;
+
+    Q_INVOKABLE QObject* get(int row) const;
+    Q_INVOKABLE QObject* getFirst() const { return get(0); }
+    Q_INVOKABLE QObject* getLast() const { return get(count() - 1); }
+    Q_INVOKABLE int size() const { return count(); }
+    Q_INVOKABLE bool isEmpty() const { return m_entries.empty(); }
+    Q_INVOKABLE int indexOf(QObject*) const;
+    Q_INVOKABLE bool contains(QObject* item) const { return indexOf(item) >= 0; }
+    /// NOTE: creates the object of every game in the list
+    Q_INVOKABLE QVariantList toVarArray() const;
+
+    /// Replaces the whole list
+    void setEntries(std::vector<size_t>);
+    /// Removes the entries matching the predicate, in continuous ranges
+    void removeEntries(const std::function<bool(size_t)>&);
+    /// Moves every entry to its position in a new store; see Library::replaceStore
+    void remapEntries(const std::vector<size_t>& new_indices);
+    /// Inserts the entries, which are not yet in the list, into their sorted
+    /// position. The list is sorted by the ranks of the entries, and the new
+    /// entries have to be in the same order already (see sort_game_lists).
+    void insertEntries(const std::vector<size_t>&, const std::vector<quint32>& ranks);
+    /// Tells the views that the data of all rows may have changed
+    void refresh();
+    /// Reorders the whole list by new ranks, eg. after a locale change
+    void sortEntries(const std::vector<quint32>& ranks);
+
+signals:
+    void countChanged();
+
+private:
+    Library& m_library;
+    std::vector<size_t> m_entries;
+
+    void onGameChanged(size_t idx);
+};
+
+} // namespace model
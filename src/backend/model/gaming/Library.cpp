@@ -0,0 +1,137 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Library.h"
+
+#include "Game.h"
+#include "GameFile.h"
+
+#include <QQmlEngine>
+#include <algorithm>
+
+
+namespace model {
+
+constexpr size_t Library::NO_GAME;
+
+Library::Library(QObject* parent)
+    : QObject(parent)
+{}
+
+void Library::replaceStore(modeldata::GameStore store, const std::vector<size_t>& old_indices)
+{
+    Q_ASSERT(old_indices.empty() || old_indices.size() == store.size());
+
+    HashMap<size_t, Game*> kept_objects;
+    for (size_t idx = 0; idx < old_indices.size() && !m_objects.empty(); idx++) {
+        const auto it = m_objects.find(old_indices[idx]);
+        if (it == m_objects.end())
+            continue;
+
+        kept_objects.emplace(idx, it->second);
+        m_objects.erase(it);
+    }
+
+    // NOTE: QML may still refer to them, so they cannot be deleted right away
+    for (const auto& entry : m_objects)
+        entry.second->deleteLater();
+
+    m_store = std::move(store);
+    m_objects = std::move(kept_objects);
+
+    for (const auto& entry : m_objects)
+        entry.second->updateIndex(entry.first);
+}
+
+Game* Library::game(size_t idx)
+{
+    Q_ASSERT(idx < m_store.size());
+
+    const auto it = m_objects.find(idx);
+    if (it != m_objects.cend())
+        return it->second;
+
+    auto game = new Game(*this, idx, this);
+    QQmlEngine::setObjectOwnership(game, QQmlEngine::CppOwnership);
+
+    connect(game, &Game::launchFileSelectorRequested,
+            this, [this, game]{ emit launchFileSelectorRequested(game); });
+    for (GameFile* const gamefile : game->filesConst()) {
+        connect(gamefile, &GameFile::launchRequested,
+                this, [this, gamefile]{ emit launchRequested(gamefile); });
+    }
+
+    m_objects.emplace(idx, game);
+    return game;
+}
+
+int Library::playCount(size_t idx) const
+{
+    int sum = 0;
+    for (size_t file_idx = m_store.firstFile(idx); file_idx < m_store.firstFile(idx) + m_store.fileCount(idx); file_idx++)
+        sum += m_store.playCount(file_idx);
+
+    return sum;
+}
+
+qint64 Library::playTime(size_t idx) const
+{
+    qint64 sum = 0;
+    for (size_t file_idx = m_store.firstFile(idx); file_idx < m_store.firstFile(idx) + m_store.fileCount(idx); file_idx++)
+        sum += m_store.playTime(file_idx);
+
+    return sum;
+}
+
+QDateTime Library::lastPlayed(size_t idx) const
+{
+    QDateTime latest;
+    for (size_t file_idx = m_store.firstFile(idx); file_idx < m_store.firstFile(idx) + m_store.fileCount(idx); file_idx++)
+        latest = std::max(latest, m_store.lastPlayed(file_idx));
+
+    return latest;
+}
+
+void Library::setFavorite(size_t idx, bool new_val)
+{
+    m_store.setFavorite(idx, new_val);
+
+    const auto it = m_objects.find(idx);
+    if (it != m_objects.cend())
+        emit it->second->favoriteChanged();
+
+    emit gameChanged(idx);
+    emit favoritesChanged();
+}
+
+void Library::updatePlayTime(size_t file_idx, qint64 duration, QDateTime time_finished)
+{
+    m_store.setPlayStats(file_idx,
+                         m_store.playCount(file_idx) + 1,
+                         m_store.playTime(file_idx) + duration,
+                         time_finished);
+
+    const size_t idx = m_store.fileGame(file_idx);
+    const auto it = m_objects.find(idx);
+    if (it != m_objects.cend()) {
+        const int file_pos = static_cast<int>(file_idx - m_store.firstFile(idx));
+        emit it->second->filesConst().at(file_pos)->playStatsChanged();
+    }
+
+    emit gameChanged(idx);
+}
+
+} // namespace model
@@ -0,0 +1,84 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "modeldata/gaming/GameStore.h"
+#include "utils/HashMap.h"
+
+#include <QDateTime>
+#include <QObject>
+#include <vector>
+
+namespace model { class Game; }
+namespace model { class GameFile; }
+
+
+namespace model {
+
+/// Owns the data of every game. The list models serve their rows directly
+/// from the store; the QML object of a game is only created (and then kept)
+/// when it is actually needed, eg. when a theme asks for a specific game.
+class Library : public QObject {
+    Q_OBJECT
+
+public:
+    explicit Library(QObject* parent = nullptr);
+
+    /// Marks the new games in the index mapping of `replaceStore`
+    static constexpr size_t NO_GAME = static_cast<size_t>(-1);
+
+    const modeldata::GameStore& store() const { return m_store; }
+    size_t count() const { return m_store.size(); }
+
+    /// Replaces the games with the ones of a new store. For each new entry,
+    /// `old_indices` contains the index of the same game in the previous store,
+    /// or NO_GAME. The objects of the kept games are moved to their new index
+    /// and get refreshed, the objects of the removed games get deleted.
+    /// The list models have to be updated by the caller.
+    void replaceStore(modeldata::GameStore, const std::vector<size_t>& old_indices);
+
+    /// Returns the object of the game, creating it on first use
+    Game* game(size_t idx);
+
+    /// Recalculates the sort keys of the games, eg. after a locale change.
+    /// The list models have to be resorted by the caller.
+    void updateSortKeys(const QCollator& collator, bool ignore_articles) {
+        m_store.updateSortKeys(collator, ignore_articles);
+    }
+
+    int playCount(size_t idx) const;
+    qint64 playTime(size_t idx) const;
+    QDateTime lastPlayed(size_t idx) const;
+
+    void setFavorite(size_t idx, bool);
+    /// Registers a finished play session of a file
+    void updatePlayTime(size_t file_idx, qint64 duration, QDateTime time_finished);
+
+signals:
+    /// Emitted when the runtime data (favorite, play stats) of a game changes
+    void gameChanged(size_t idx);
+    void favoritesChanged();
+
+    void launchFileSelectorRequested(model::Game*);
+    void launchRequested(model::GameFile*);
+
+private:
+    modeldata::GameStore m_store;
+    HashMap<size_t, Game*> m_objects;
+};
+
+} // namespace model
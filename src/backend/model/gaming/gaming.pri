@@ -2,10 +2,14 @@ HEADERS += \
     $$PWD/Collection.h \
     $$PWD/Game.h \
     $$PWD/GameAssets.h \
-    $$PWD/GameFile.h
+    $$PWD/GameFile.h \
+    $$PWD/GameList.h \
+    $$PWD/Library.h
 
 SOURCES += \
     $$PWD/Collection.cpp \
     $$PWD/Game.cpp \
     $$PWD/GameAssets.cpp \
-    $$PWD/GameFile.cpp
+    $$PWD/GameFile.cpp \
+    $$PWD/GameList.cpp \
+    $$PWD/Library.cpp
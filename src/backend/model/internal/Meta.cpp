@@ -34,6 +34,7 @@ Meta::Meta(QObject* parent)
     , m_loading(true)
     , m_loading_progress(0.f)
     , m_game_count(0)
+    , m_rescanning(false)
 {
 }
 
@@ -43,6 +44,16 @@ void Meta::clearQMLCache()
     emit qmlClearCacheRequested();
 }
 
+void Meta::rescan(int providerMask)
+{
+    emit rescanRequested(static_cast<unsigned>(providerMask));
+}
+
+void Meta::cancelRescan()
+{
+    emit rescanCancelRequested();
+}
+
 void Meta::onFirstPhaseCompleted(qint64 elapsedTime)
 {
     qInfo().noquote() << tr_log("Games found in %1ms").arg(elapsedTime);
@@ -65,6 +76,23 @@ void Meta::onUiReady()
     emit loadingChanged();
 }
 
+void Meta::setProviderNames(QStringList names)
+{
+    m_provider_names = std::move(names);
+}
+
+void Meta::onRescanStarted()
+{
+    m_rescanning = true;
+    emit rescanningChanged();
+}
+
+void Meta::onRescanFinished()
+{
+    m_rescanning = false;
+    emit rescanningChanged();
+}
+
 void Meta::onGameCountUpdate(int game_count)
 {
     if (m_game_count != game_count) {
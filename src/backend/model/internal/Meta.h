@@ -18,6 +18,7 @@
 #pragma once
 
 #include <QObject>
+#include <QStringList>
 
 
 namespace model {
@@ -31,6 +32,9 @@ class Meta : public QObject {
 
     Q_PROPERTY(int gameCount READ gameCount NOTIFY gameCountChanged)
 
+    Q_PROPERTY(bool rescanning READ isRescanning NOTIFY rescanningChanged)
+    Q_PROPERTY(QStringList providerNames MEMBER m_provider_names CONSTANT)
+
     Q_PROPERTY(QString gitRevision MEMBER m_git_revision CONSTANT)
     Q_PROPERTY(QString gitDate MEMBER m_git_date CONSTANT)
     Q_PROPERTY(QString logFilePath MEMBER m_log_path CONSTANT)
@@ -39,14 +43,21 @@ public:
     explicit Meta(QObject* parent = nullptr);
 
     void onUiReady();
+    void setProviderNames(QStringList);
 
 public:
     Q_INVOKABLE void clearQMLCache();
 
+    /// Searches the library again. Bit N of the mask selects the Nth entry of
+    /// `providerNames`; by default every provider is searched again.
+    Q_INVOKABLE void rescan(int providerMask = -1);
+    Q_INVOKABLE void cancelRescan();
+
     bool isLoading() const { return m_loading; }
     float loadingProgress() const { return m_loading_progress; }
 
     int gameCount() const { return m_game_count; }
+    bool isRescanning() const { return m_rescanning; }
 
 public slots:
     void onFirstPhaseCompleted(qint64 elapsedTime);
@@ -54,12 +65,18 @@ public slots:
 
     void onGameCountUpdate(int game_count);
 
+    void onRescanStarted();
+    void onRescanFinished();
+
 signals:
     void loadingChanged();
     void loadingProgressChanged();
     void gameCountChanged();
+    void rescanningChanged();
 
     void qmlClearCacheRequested();
+    void rescanRequested(unsigned provider_mask);
+    void rescanCancelRequested();
 
 private:
     static const QString m_git_revision;
@@ -70,6 +87,9 @@ private:
     float m_loading_progress;
 
     int m_game_count;
+
+    bool m_rescanning;
+    QStringList m_provider_names;
 };
 
 } // namespace model
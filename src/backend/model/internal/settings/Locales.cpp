@@ -157,10 +157,13 @@ void Locales::setCurrentIndex(int idx_int)
     // load
     m_current_idx = idx;
     load_selected_locale();
+
+    // NOTE: the new value is set before the change is signaled,
+    // as sorting reads it from the settings
+    AppSettings::general.locale = m_locales.at(idx).bcp47tag;
     emit localeChanged();
 
     // remember
-    AppSettings::general.locale = m_locales.at(idx).bcp47tag;
     AppSettings::save_config();
 }
 
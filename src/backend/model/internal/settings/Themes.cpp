@@ -21,6 +21,7 @@
 #include "ConfigFile.h"
 #include "LocaleUtils.h"
 #include "Paths.h"
+#include "utils/Collation.h"
 #include "utils/HashMap.h"
 #include "utils/PathCheck.h"
 
@@ -28,6 +29,7 @@
 #include <QDirIterator>
 #include <QStringBuilder>
 #include <QUrl>
+#include <numeric>
 
 
 namespace {
@@ -57,6 +59,28 @@ HashMap<QString, QString> read_metafile(const QString& config_file_path)
     return result;
 }
 
+std::vector<model::ThemeEntry> sort_themes(std::vector<model::ThemeEntry> themes)
+{
+    const QCollator collator = collation::create_collator(AppSettings::general.locale);
+
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(themes.size());
+    for (const model::ThemeEntry& theme : themes)
+        keys.emplace_back(collator.sortKey(theme.name));
+
+    std::vector<size_t> order(themes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&keys](size_t a, size_t b){ return keys[a] < keys[b]; });
+
+    std::vector<model::ThemeEntry> sorted;
+    sorted.reserve(themes.size());
+    for (const size_t idx : order)
+        sorted.emplace_back(std::move(themes[idx]));
+
+    return sorted;
+}
+
 std::vector<model::ThemeEntry> find_available_themes()
 {
     constexpr auto filters = QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
@@ -124,13 +148,7 @@ std::vector<model::ThemeEntry> find_available_themes()
         }
     }
 
-    std::sort(themes.begin(), themes.end(),
-        [](const model::ThemeEntry& a, const model::ThemeEntry& b) {
-            return QString::localeAwareCompare(a.name, b.name);
-        }
-    );
-
-    return themes;
+    return sort_themes(std::move(themes));
 }
 } // namespace
 
@@ -40,6 +40,10 @@ struct GameAssets {
     void setSingle(AssetType, QString);
     void appendMulti(AssetType, QString);
 
+    // NOTE: may contain empty entries
+    const HashMap<AssetType, QString, EnumHash>& singleAssets() const { return m_single_assets; }
+    const HashMap<AssetType, QStringList, EnumHash>& multiAssets() const { return m_multi_assets; }
+
 private:
     // TODO: merge these two
     HashMap<AssetType, QString, EnumHash> m_single_assets;
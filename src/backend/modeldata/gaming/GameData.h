@@ -32,6 +32,8 @@ namespace modeldata {
 
 struct GameFile {
     QFileInfo fileinfo;
+    /// Resolved once during the search (see PathCache); empty if not known yet
+    QString canonical_path;
     QString name;
     // TODO: in the future...
     // QString summary;
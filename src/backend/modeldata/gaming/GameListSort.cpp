@@ -0,0 +1,69 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "GameListSort.h"
+
+#include "Trace.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <numeric>
+
+
+namespace {
+class RankLess {
+public:
+    explicit RankLess(const std::vector<quint32>& ranks)
+        : m_ranks(ranks)
+    {}
+
+    bool operator()(size_t a, size_t b) const {
+        return m_ranks[a] < m_ranks[b] || (m_ranks[a] == m_ranks[b] && a < b);
+    }
+
+private:
+    const std::vector<quint32>& m_ranks;
+};
+} // namespace
+
+
+namespace modeldata {
+
+std::vector<size_t> sort_game_lists(HashMap<QString, std::vector<size_t>>& lists,
+                                    const std::vector<quint32>& title_ranks)
+{
+    const TraceSpan span("sort_game_lists", QString::number(lists.size()));
+
+    std::vector<size_t> all_games(title_ranks.size());
+    std::iota(all_games.begin(), all_games.end(), 0);
+
+    // NOTE: the list of all games is usually the longest, so it goes first
+    std::vector<std::vector<size_t>*> tasks;
+    tasks.reserve(lists.size() + 1);
+    tasks.push_back(&all_games);
+    for (auto& entry : lists)
+        tasks.push_back(&entry.second);
+
+    const RankLess rank_less(title_ranks);
+    QtConcurrent::blockingMap(tasks, [&rank_less](std::vector<size_t>* const list){
+        std::sort(list->begin(), list->end(), rank_less);
+        list->erase(std::unique(list->begin(), list->end()), list->end());
+    });
+
+    return all_games;
+}
+
+} // namespace modeldata
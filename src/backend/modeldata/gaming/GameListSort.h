@@ -0,0 +1,34 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "utils/HashMap.h"
+
+#include <QString>
+#include <vector>
+
+
+namespace modeldata {
+
+/// Puts the game lists into title order, as the list models expect them:
+/// sorts every list of the map in place by the title ranks (equal titles by
+/// index), dropping the duplicates, then returns every game of the library
+/// in the same order. The lists are sorted as parallel tasks.
+std::vector<size_t> sort_game_lists(HashMap<QString, std::vector<size_t>>& lists,
+                                    const std::vector<quint32>& title_ranks);
+
+} // namespace modeldata
@@ -0,0 +1,275 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "GameStore.h"
+
+#include "utils/Collation.h"
+
+#include <limits>
+
+
+namespace {
+static constexpr qint64 NO_DATETIME = std::numeric_limits<qint64>::min();
+} // namespace
+
+
+namespace modeldata {
+
+StringColumn::StringColumn()
+    : m_offsets(1, 0)
+{}
+
+void StringColumn::reserve(size_t count, size_t total_length)
+{
+    m_offsets.reserve(count + 1);
+    m_chars.reserve(total_length);
+}
+
+void StringColumn::append(const QString& str)
+{
+    m_chars.insert(m_chars.end(), str.cbegin(), str.cend());
+    m_offsets.push_back(static_cast<quint32>(m_chars.size()));
+}
+
+QString StringColumn::at(size_t idx) const
+{
+    return QString(m_chars.data() + m_offsets[idx], length(idx));
+}
+
+QString StringColumn::view(size_t idx) const
+{
+    return QString::fromRawData(m_chars.data() + m_offsets[idx], length(idx));
+}
+
+
+DictColumn::DictColumn()
+    : m_offsets(1, 0)
+{}
+
+void DictColumn::append_value(const QString& str)
+{
+    const auto it = m_value_ids.find(str);
+    if (it != m_value_ids.cend()) {
+        m_items.push_back(it->second);
+        return;
+    }
+
+    const auto id = static_cast<quint32>(m_values.size());
+    m_values.push_back(str);
+    m_value_ids.emplace(str, id);
+    m_items.push_back(id);
+}
+
+void DictColumn::append(const QString& str)
+{
+    if (!str.isEmpty())
+        append_value(str);
+
+    m_offsets.push_back(static_cast<quint32>(m_items.size()));
+}
+
+void DictColumn::append(const QStringList& list)
+{
+    for (const QString& str : list)
+        append_value(str);
+
+    m_offsets.push_back(static_cast<quint32>(m_items.size()));
+}
+
+QString DictColumn::first(size_t idx) const
+{
+    if (count(idx) == 0)
+        return QString();
+
+    return m_values[m_items[m_offsets[idx]]];
+}
+
+QStringList DictColumn::at(size_t idx) const
+{
+    QStringList list;
+    list.reserve(count(idx));
+    for (quint32 i = m_offsets[idx]; i < m_offsets[idx + 1]; i++)
+        list.append(m_values[m_items[i]]);
+
+    return list;
+}
+
+
+GameStore::GameStore()
+    : m_file_offsets(1, 0)
+    , m_asset_offsets(1, 0)
+{}
+
+void GameStore::reserve(size_t game_count)
+{
+    // NOTE: the text columns grow on demand, as their lengths are not known
+    m_player_counts.reserve(game_count);
+    m_ratings.reserve(game_count);
+    m_release_dates.reserve(game_count);
+    m_favorites.reserve(game_count);
+    m_file_offsets.reserve(game_count + 1);
+    m_asset_offsets.reserve(game_count + 1);
+
+    // most games have a single file
+    m_file_games.reserve(game_count);
+    m_play_counts.reserve(game_count);
+    m_play_times.reserve(game_count);
+    m_last_played.reserve(game_count);
+}
+
+size_t GameStore::append(Game&& game)
+{
+    const size_t idx = size();
+
+    m_titles.append(game.title);
+    m_summaries.append(game.summary);
+    m_descriptions.append(game.description);
+    m_launch_cmds.append(game.launch_cmd);
+    m_launch_workdirs.append(game.launch_workdir);
+    m_developers.append(game.developers);
+    m_publishers.append(game.publishers);
+    m_genres.append(game.genres);
+
+    m_player_counts.push_back(game.player_count);
+    m_ratings.push_back(game.rating);
+    m_release_dates.push_back(game.release_date);
+    m_favorites.push_back(game.is_favorite);
+
+    for (GameFile& file : game.files) {
+        // NOTE: normally the search has resolved the paths already
+        const QString canonical_path = file.canonical_path.isEmpty()
+            ? file.fileinfo.canonicalFilePath()
+            : file.canonical_path;
+        const QString found_path = file.fileinfo.filePath();
+        m_file_paths.append(canonical_path);
+        m_file_found_paths.append(found_path == canonical_path ? QString() : found_path);
+        m_file_games.push_back(idx);
+        m_file_names.append(file.name);
+        m_play_counts.push_back(file.play_count);
+        m_play_times.push_back(file.play_time);
+        m_last_played.push_back(file.last_played.isValid()
+            ? file.last_played.toMSecsSinceEpoch()
+            : NO_DATETIME);
+    }
+    m_file_offsets.push_back(m_file_games.size());
+
+    for (const auto& entry : game.assets.singleAssets()) {
+        if (entry.second.isEmpty())
+            continue;
+
+        m_asset_types.push_back(entry.first);
+        m_asset_values.append(entry.second);
+    }
+    for (const auto& entry : game.assets.multiAssets()) {
+        for (const QString& value : entry.second) {
+            m_asset_types.push_back(entry.first);
+            m_asset_values.append(value);
+        }
+    }
+    m_asset_offsets.push_back(m_asset_types.size());
+
+    return idx;
+}
+
+QString GameStore::filePath(size_t file_idx) const
+{
+    return m_file_found_paths.length(file_idx) > 0
+        ? m_file_found_paths.at(file_idx)
+        : m_file_paths.at(file_idx);
+}
+
+Game GameStore::game(size_t idx) const
+{
+    Game game(title(idx));
+    game.summary = summary(idx);
+    game.description = description(idx);
+    game.launch_cmd = launchCmd(idx);
+    game.launch_workdir = launchWorkdir(idx);
+    game.developers = developers(idx);
+    game.publishers = publishers(idx);
+    game.genres = genres(idx);
+
+    game.player_count = playerCount(idx);
+    game.rating = rating(idx);
+    game.release_date = releaseDate(idx);
+    game.is_favorite = isFavorite(idx);
+
+    game.files.reserve(fileCount(idx));
+    for (size_t file_idx = m_file_offsets[idx]; file_idx < m_file_offsets[idx + 1]; file_idx++) {
+        game.files.emplace_back(fileInfo(file_idx));
+
+        GameFile& file = game.files.back();
+        file.canonical_path = canonicalPath(file_idx);
+        file.name = fileName(file_idx);
+        file.play_count = playCount(file_idx);
+        file.play_time = playTime(file_idx);
+        file.last_played = lastPlayed(file_idx);
+    }
+
+    game.assets = assets(idx);
+    return game;
+}
+
+GameAssets GameStore::assets(size_t idx) const
+{
+    GameAssets assets;
+    for (size_t asset_idx = m_asset_offsets[idx]; asset_idx < m_asset_offsets[idx + 1]; asset_idx++)
+        assets.addUrlMaybe(m_asset_types[asset_idx], m_asset_values.at(asset_idx));
+
+    return assets;
+}
+
+QDateTime GameStore::lastPlayed(size_t file_idx) const
+{
+    const qint64 msecs = m_last_played[file_idx];
+    return msecs != NO_DATETIME
+        ? QDateTime::fromMSecsSinceEpoch(msecs)
+        : QDateTime();
+}
+
+void GameStore::setPlayStats(size_t file_idx, int play_count, qint64 play_time, const QDateTime& last_played)
+{
+    m_play_counts[file_idx] = play_count;
+    m_play_times[file_idx] = play_time;
+    m_last_played[file_idx] = last_played.isValid()
+        ? last_played.toMSecsSinceEpoch()
+        : NO_DATETIME;
+}
+
+void GameStore::updateSortKeys(const QCollator& collator, bool ignore_articles)
+{
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(size());
+    for (size_t idx = 0; idx < size(); idx++)
+        keys.emplace_back(collator.sortKey(collation::sort_title(m_titles.view(idx), ignore_articles)));
+
+    m_sort_keys = std::move(keys);
+}
+
+void GameStore::appendSortKeys(const QCollator& collator, bool ignore_articles)
+{
+    m_sort_keys.reserve(size());
+    for (size_t idx = m_sort_keys.size(); idx < size(); idx++)
+        m_sort_keys.emplace_back(collator.sortKey(collation::sort_title(m_titles.view(idx), ignore_articles)));
+}
+
+std::vector<quint32> GameStore::titleRanks() const
+{
+    Q_ASSERT(m_sort_keys.size() == size());
+    return collation::ranks_of(m_sort_keys);
+}
+
+} // namespace modeldata
@@ -0,0 +1,208 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "GameData.h"
+#include "types/AssetType.h"
+#include "utils/HashMap.h"
+
+#include <QCollator>
+#include <QDate>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+
+namespace modeldata {
+
+/// Stores the characters of all values in one contiguous buffer,
+/// with the start of each value kept in a separate offset array
+class StringColumn {
+public:
+    explicit StringColumn();
+    StringColumn(StringColumn&&) = default;
+    StringColumn& operator=(StringColumn&&) = default;
+
+    size_t size() const { return m_offsets.size() - 1; }
+    void reserve(size_t count, size_t total_length);
+    void append(const QString&);
+
+    int length(size_t idx) const { return static_cast<int>(m_offsets[idx + 1] - m_offsets[idx]); }
+    /// Returns a copy of the value
+    QString at(size_t idx) const;
+    /// Returns the value without copying it.
+    /// NOTE: Only valid until the column is modified or destroyed.
+    QString view(size_t idx) const;
+
+private:
+    std::vector<QChar> m_chars;
+    std::vector<quint32> m_offsets;
+
+    friend class GameStore;
+    StringColumn(const StringColumn&) = default;
+    StringColumn& operator=(const StringColumn&) = delete;
+};
+
+
+/// Stores lists of strings, with every distinct value stored only once.
+/// Suitable for values that repeat a lot between games, like genres or
+/// launch commands. A single string is stored as a list of one item.
+class DictColumn {
+public:
+    explicit DictColumn();
+    DictColumn(DictColumn&&) = default;
+    DictColumn& operator=(DictColumn&&) = default;
+
+    size_t size() const { return m_offsets.size() - 1; }
+    size_t distinctCount() const { return m_values.size(); }
+
+    void append(const QString&);
+    void append(const QStringList&);
+
+    int count(size_t idx) const { return static_cast<int>(m_offsets[idx + 1] - m_offsets[idx]); }
+    /// Returns the first item of the entry, or an empty string
+    QString first(size_t idx) const;
+    QStringList at(size_t idx) const;
+
+private:
+    std::vector<QString> m_values;
+    HashMap<QString, quint32> m_value_ids;
+    std::vector<quint32> m_items;
+    std::vector<quint32> m_offsets;
+
+    void append_value(const QString&);
+
+    friend class GameStore;
+    DictColumn(const DictColumn&) = default;
+    DictColumn& operator=(const DictColumn&) = delete;
+};
+
+
+/// A columnar storage of games. Instead of one struct per game, each field
+/// is stored in its own contiguous array, making linear passes over large
+/// libraries (eg. sorting or filtering) cache friendly, and reducing the
+/// number of allocations considerably. The files of the games are stored
+/// in a flat array too, with each game referring to a range of it.
+///
+/// The providers still work with modeldata::Game structs; `append` moves
+/// them into the store and `game` recreates them.
+class GameStore {
+public:
+    explicit GameStore();
+    GameStore(GameStore&&) = default;
+    GameStore& operator=(GameStore&&) = default;
+
+    /// Copies the store. As the data is kept in a few flat arrays, this is
+    /// much cheaper than copying the games one by one.
+    GameStore clone() const { return GameStore(*this); }
+
+    size_t size() const { return m_player_counts.size(); }
+    void reserve(size_t game_count);
+
+    /// Moves the game into the store and returns its index
+    size_t append(Game&&);
+    /// Creates a standalone copy of the stored game
+    Game game(size_t idx) const;
+
+
+    QString title(size_t idx) const { return m_titles.at(idx); }
+    QString summary(size_t idx) const { return m_summaries.at(idx); }
+    QString description(size_t idx) const { return m_descriptions.at(idx); }
+    QString launchCmd(size_t idx) const { return m_launch_cmds.first(idx); }
+    QString launchWorkdir(size_t idx) const { return m_launch_workdirs.first(idx); }
+    QStringList developers(size_t idx) const { return m_developers.at(idx); }
+    QStringList publishers(size_t idx) const { return m_publishers.at(idx); }
+    QStringList genres(size_t idx) const { return m_genres.at(idx); }
+    GameAssets assets(size_t idx) const;
+
+    short playerCount(size_t idx) const { return m_player_counts[idx]; }
+    float rating(size_t idx) const { return m_ratings[idx]; }
+    const QDate& releaseDate(size_t idx) const { return m_release_dates[idx]; }
+    bool isFavorite(size_t idx) const { return m_favorites[idx]; }
+    void setFavorite(size_t idx, bool val) { m_favorites[idx] = val; }
+
+
+    /// Files are addressed by their position in the store-wide file array
+    size_t fileCount(size_t game_idx) const { return m_file_offsets[game_idx + 1] - m_file_offsets[game_idx]; }
+    size_t firstFile(size_t game_idx) const { return m_file_offsets[game_idx]; }
+    size_t totalFileCount() const { return m_file_games.size(); }
+    /// Returns the game the file belongs to
+    size_t fileGame(size_t file_idx) const { return m_file_games[file_idx]; }
+
+    /// The path of the file as it was found
+    QString filePath(size_t file_idx) const;
+    /// NOTE: created on demand, only the paths are stored
+    QFileInfo fileInfo(size_t file_idx) const { return QFileInfo(filePath(file_idx)); }
+    QString canonicalPath(size_t file_idx) const { return m_file_paths.at(file_idx); }
+    QString fileName(size_t file_idx) const { return m_file_names.at(file_idx); }
+    int playCount(size_t file_idx) const { return m_play_counts[file_idx]; }
+    qint64 playTime(size_t file_idx) const { return m_play_times[file_idx]; }
+    QDateTime lastPlayed(size_t file_idx) const;
+    void setPlayStats(size_t file_idx, int play_count, qint64 play_time, const QDateTime& last_played);
+
+
+    /// Calculates the collation keys of the titles. Has to be called after
+    /// the last game was added, and again if the locale changes.
+    void updateSortKeys(const QCollator&, bool ignore_articles);
+    /// Calculates the collation keys only for the games added since the last update
+    void appendSortKeys(const QCollator&, bool ignore_articles);
+    /// Returns the position of each game when ordered by title. Games with
+    /// equal titles get the same rank. Requires up to date sort keys.
+    std::vector<quint32> titleRanks() const;
+
+private:
+    // per game
+    StringColumn m_titles;
+    StringColumn m_summaries;
+    StringColumn m_descriptions;
+    DictColumn m_launch_cmds;
+    DictColumn m_launch_workdirs;
+    DictColumn m_developers;
+    DictColumn m_publishers;
+    DictColumn m_genres;
+
+    std::vector<short> m_player_counts;
+    std::vector<float> m_ratings;
+    std::vector<QDate> m_release_dates;
+    std::vector<bool> m_favorites;
+    std::vector<QCollatorSortKey> m_sort_keys;
+
+    std::vector<size_t> m_file_offsets;
+    std::vector<size_t> m_asset_offsets;
+
+    // per file
+    std::vector<size_t> m_file_games;
+    StringColumn m_file_paths;
+    /// The path the file was found at, if it differs from the canonical one
+    /// (eg. because of symlinks), otherwise empty
+    StringColumn m_file_found_paths;
+    StringColumn m_file_names;
+    std::vector<int> m_play_counts;
+    std::vector<qint64> m_play_times;
+    std::vector<qint64> m_last_played;
+
+    // per asset
+    std::vector<AssetType> m_asset_types;
+    StringColumn m_asset_values;
+
+    GameStore(const GameStore&) = default;
+    GameStore& operator=(const GameStore&) = delete;
+};
+
+} // namespace modeldata
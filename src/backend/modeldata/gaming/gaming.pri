@@ -1,9 +1,13 @@
 HEADERS += \
     $$PWD/CollectionData.h \
     $$PWD/GameData.h \
-    $$PWD/GameAssetsData.h
+    $$PWD/GameAssetsData.h \
+    $$PWD/GameListSort.h \
+    $$PWD/GameStore.h
 
 SOURCES += \
     $$PWD/CollectionData.cpp \
     $$PWD/GameData.cpp \
-    $$PWD/GameAssetsData.cpp
+    $$PWD/GameAssetsData.cpp \
+    $$PWD/GameListSort.cpp \
+    $$PWD/GameStore.cpp
@@ -0,0 +1,170 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "DataStream.h"
+
+#include "modeldata/gaming/CollectionData.h"
+#include "modeldata/gaming/GameData.h"
+
+
+namespace {
+AssetType read_asset_type(QDataStream& stream)
+{
+    quint8 raw_type = 0;
+    stream >> raw_type;
+
+    if (raw_type == 0 || static_cast<quint8>(AssetType::VIDEOS) < raw_type) {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return AssetType::UNKNOWN;
+    }
+    return static_cast<AssetType>(raw_type);
+}
+} // namespace
+
+
+namespace providers {
+namespace datastream {
+
+quint32 read_count(QDataStream& stream)
+{
+    quint32 count = 0;
+    stream >> count;
+    if (count > stream.device()->bytesAvailable()) {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return 0;
+    }
+    return count;
+}
+
+bool stream_ok(const QDataStream& stream)
+{
+    return stream.status() == QDataStream::Ok;
+}
+
+void write_assets(QDataStream& stream, const modeldata::GameAssets& assets)
+{
+    stream << static_cast<quint32>(assets.singleAssets().size());
+    for (const auto& entry : assets.singleAssets())
+        stream << static_cast<quint8>(entry.first) << entry.second;
+
+    stream << static_cast<quint32>(assets.multiAssets().size());
+    for (const auto& entry : assets.multiAssets())
+        stream << static_cast<quint8>(entry.first) << entry.second;
+}
+
+void read_assets(QDataStream& stream, modeldata::GameAssets& assets)
+{
+    const quint32 single_count = read_count(stream);
+    for (quint32 i = 0; i < single_count && stream_ok(stream); i++) {
+        const AssetType type = read_asset_type(stream);
+        QString value;
+        stream >> value;
+
+        if (stream_ok(stream) && !value.isEmpty())
+            assets.setSingle(type, std::move(value));
+    }
+
+    const quint32 multi_count = read_count(stream);
+    for (quint32 i = 0; i < multi_count && stream_ok(stream); i++) {
+        const AssetType type = read_asset_type(stream);
+        QStringList values;
+        stream >> values;
+
+        if (stream_ok(stream)) {
+            for (QString& value : values)
+                assets.appendMulti(type, std::move(value));
+        }
+    }
+}
+
+void write_collection(QDataStream& stream, const modeldata::Collection& coll)
+{
+    stream << coll.name << coll.shortName()
+           << coll.summary << coll.description
+           << coll.launch_cmd << coll.launch_workdir;
+    write_assets(stream, coll.assets);
+}
+
+modeldata::Collection read_collection(QDataStream& stream)
+{
+    QString name;
+    QString short_name;
+    stream >> name >> short_name;
+
+    modeldata::Collection coll(std::move(name));
+    if (!short_name.isEmpty())
+        coll.setShortName(short_name);
+
+    stream >> coll.summary >> coll.description
+           >> coll.launch_cmd >> coll.launch_workdir;
+    read_assets(stream, coll.assets);
+
+    return coll;
+}
+
+void write_game(QDataStream& stream, const modeldata::Game& game)
+{
+    stream << game.title << game.summary << game.description
+           << game.launch_cmd << game.launch_workdir
+           << static_cast<qint16>(game.player_count) << game.is_favorite
+           << game.rating << game.release_date
+           << game.developers << game.publishers << game.genres;
+
+    stream << static_cast<quint32>(game.files.size());
+    for (const modeldata::GameFile& file : game.files) {
+        stream << file.fileinfo.filePath() << file.canonical_path << file.name
+               << file.last_played << file.play_time << static_cast<qint32>(file.play_count);
+    }
+
+    write_assets(stream, game.assets);
+}
+
+modeldata::Game read_game(QDataStream& stream)
+{
+    QString title;
+    stream >> title;
+
+    modeldata::Game game(std::move(title));
+    qint16 player_count = 1;
+    stream >> game.summary >> game.description
+           >> game.launch_cmd >> game.launch_workdir
+           >> player_count >> game.is_favorite
+           >> game.rating >> game.release_date
+           >> game.developers >> game.publishers >> game.genres;
+    game.player_count = player_count;
+
+    const quint32 file_count = read_count(stream);
+    game.files.reserve(file_count);
+    for (quint32 i = 0; i < file_count && stream_ok(stream); i++) {
+        QString path;
+        stream >> path;
+        game.files.emplace_back(QFileInfo(path));
+
+        modeldata::GameFile& file = game.files.back();
+        qint32 play_count = 0;
+        stream >> file.canonical_path >> file.name >> file.last_played >> file.play_time >> play_count;
+        file.play_count = play_count;
+    }
+
+    read_assets(stream, game.assets);
+
+    return game;
+}
+
+} // namespace datastream
+} // namespace providers
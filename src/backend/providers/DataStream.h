@@ -0,0 +1,48 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include "utils/FwdDeclModelData.h"
+
+#include <QDataStream>
+
+
+namespace providers {
+namespace datastream {
+
+/// The QDataStream version used by every binary cache of the providers
+constexpr auto STREAM_VERSION = QDataStream::Qt_5_6;
+
+/// Reads an element count, with a basic sanity check against corrupted data
+quint32 read_count(QDataStream&);
+bool stream_ok(const QDataStream&);
+
+void write_assets(QDataStream&, const modeldata::GameAssets&);
+void read_assets(QDataStream&, modeldata::GameAssets&);
+
+void write_collection(QDataStream&, const modeldata::Collection&);
+/// The result is only valid if the stream is still ok after the call
+modeldata::Collection read_collection(QDataStream&);
+
+void write_game(QDataStream&, const modeldata::Game&);
+/// The result is only valid if the stream is still ok after the call
+modeldata::Game read_game(QDataStream&);
+
+} // namespace datastream
+} // namespace providers
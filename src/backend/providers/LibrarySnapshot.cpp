@@ -0,0 +1,388 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "LibrarySnapshot.h"
+
+#include "DataStream.h"
+#include "LocaleUtils.h"
+#include "Paths.h"
+#include "Trace.h"
+#include "modeldata/gaming/CollectionData.h"
+#include "modeldata/gaming/GameData.h"
+#include "utils/HashMap.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <limits>
+
+
+namespace {
+using namespace providers::datastream;
+
+static constexpr auto MSG_PREFIX = "Snapshot:";
+
+constexpr quint32 SNAPSHOT_MAGIC = 0x50475353; // "PGSS"
+// NOTE: increase this when the serialized fields change
+constexpr quint32 SNAPSHOT_VERSION = 3;
+
+
+/// NOTE: missing paths are stored with -1 values, so if they get created
+/// later, the snapshot becomes outdated
+struct SourceStamp {
+    qint64 mtime;
+    qint64 size;
+};
+
+SourceStamp stamp_of(const QString& path)
+{
+    const QFileInfo finfo(path);
+    if (!finfo.exists())
+        return { -1, -1 };
+
+    return { finfo.lastModified().toMSecsSinceEpoch(), finfo.size() };
+}
+
+void clear_results(providers::SearchContext& sctx)
+{
+    sctx.games.clear();
+    sctx.collections.clear();
+    sctx.collection_childs.clear();
+    sctx.path_to_gameidx.clear();
+    sctx.source_paths.clear();
+}
+
+
+void write_sources(QDataStream& stream, std::vector<QString> sources)
+{
+    std::sort(sources.begin(), sources.end());
+    sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+    // NOTE: the stamps are taken after the scan, so a change during the scan
+    // will only be noticed after the next modification of the same path
+    stream << static_cast<quint32>(sources.size());
+    for (const QString& path : sources) {
+        const SourceStamp stamp = stamp_of(path);
+        stream << path << stamp.mtime << stamp.size;
+    }
+}
+
+/// If `changed_paths` is set, every path is checked and the changed ones are
+/// collected, otherwise the checks stop at the first change
+bool read_sources(QDataStream& stream, std::vector<QString>& sources, bool* is_outdated,
+                  HashMap<QString, bool>* changed_paths)
+{
+    const quint32 count = read_count(stream);
+    sources.reserve(count);
+
+    bool changed = false;
+    for (quint32 i = 0; i < count && stream_ok(stream); i++) {
+        QString path;
+        SourceStamp stored { -1, -1 };
+        stream >> path >> stored.mtime >> stored.size;
+
+        if (!changed || changed_paths) {
+            const SourceStamp current = stamp_of(path);
+            if (current.mtime != stored.mtime || current.size != stored.size) {
+                qInfo().noquote() << MSG_PREFIX
+                    << tr_log("`%1` has changed since the last run").arg(path);
+                if (!is_outdated)
+                    return false;
+
+                changed = true;
+                if (changed_paths)
+                    changed_paths->emplace(path, true);
+            }
+        }
+
+        sources.emplace_back(std::move(path));
+    }
+
+    if (is_outdated)
+        *is_outdated = changed;
+
+    return stream_ok(stream);
+}
+
+/// Checks the sources stored at the beginning of the serialized list results
+bool list_sources_changed(const QByteArray& list_results, const HashMap<QString, bool>& changed_paths)
+{
+    QDataStream stream(list_results);
+    stream.setVersion(STREAM_VERSION);
+
+    const quint32 count = read_count(stream);
+    for (quint32 i = 0; i < count && stream_ok(stream); i++) {
+        QString path;
+        stream >> path;
+        if (changed_paths.count(path))
+            return true;
+    }
+
+    return !stream_ok(stream);
+}
+
+quint32 read_game_index(QDataStream& stream, const providers::SearchContext& sctx)
+{
+    quint32 game_idx = 0;
+    stream >> game_idx;
+    if (sctx.games.size() <= game_idx)
+        stream.setStatus(QDataStream::ReadCorruptData);
+
+    return game_idx;
+}
+
+void write_results(QDataStream& stream, const providers::SearchContext& sctx)
+{
+    stream << static_cast<quint32>(sctx.collections.size());
+    for (const auto& entry : sctx.collections)
+        write_collection(stream, entry.second);
+
+    stream << static_cast<quint32>(sctx.games.size());
+    for (const modeldata::Game& game : sctx.games)
+        write_game(stream, game);
+
+    stream << static_cast<quint32>(sctx.collection_childs.size());
+    for (const auto& entry : sctx.collection_childs) {
+        stream << entry.first << static_cast<quint32>(entry.second.size());
+        for (const size_t game_idx : entry.second)
+            stream << static_cast<quint32>(game_idx);
+    }
+
+    stream << static_cast<quint32>(sctx.path_to_gameidx.size());
+    for (const auto& entry : sctx.path_to_gameidx)
+        stream << entry.first << static_cast<quint32>(entry.second);
+}
+
+bool read_results(QDataStream& stream, providers::SearchContext& sctx)
+{
+    const quint32 coll_count = read_count(stream);
+    sctx.collections.reserve(coll_count);
+    for (quint32 i = 0; i < coll_count && stream_ok(stream); i++) {
+        modeldata::Collection coll = read_collection(stream);
+        if (stream_ok(stream))
+            sctx.collections.emplace(coll.name, std::move(coll));
+    }
+
+    const quint32 game_count = read_count(stream);
+    sctx.games.reserve(game_count);
+    for (quint32 i = 0; i < game_count && stream_ok(stream); i++) {
+        modeldata::Game game = read_game(stream);
+        if (stream_ok(stream))
+            sctx.games.emplace_back(std::move(game));
+    }
+
+    const quint32 childlist_count = read_count(stream);
+    sctx.collection_childs.reserve(childlist_count);
+    for (quint32 i = 0; i < childlist_count && stream_ok(stream); i++) {
+        QString coll_name;
+        stream >> coll_name;
+
+        std::vector<size_t>& childs = sctx.collection_childs[coll_name];
+        const quint32 child_count = read_count(stream);
+        childs.reserve(child_count);
+        for (quint32 j = 0; j < child_count && stream_ok(stream); j++)
+            childs.emplace_back(read_game_index(stream, sctx));
+    }
+
+    const quint32 path_count = read_count(stream);
+    sctx.path_to_gameidx.reserve(path_count);
+    for (quint32 i = 0; i < path_count && stream_ok(stream); i++) {
+        QString path;
+        stream >> path;
+        const quint32 game_idx = read_game_index(stream, sctx);
+        sctx.path_to_gameidx.emplace(std::move(path), game_idx);
+    }
+
+    return stream_ok(stream);
+}
+
+/// The results of the providers with changed sources are left empty
+bool read_list_results(QDataStream& stream, const HashMap<QString, bool>& changed_paths,
+                       std::vector<QByteArray>& list_results)
+{
+    const quint32 count = read_count(stream);
+    list_results.clear();
+    list_results.reserve(count);
+
+    for (quint32 i = 0; i < count && stream_ok(stream); i++) {
+        QByteArray entry;
+        stream >> entry;
+        if (list_sources_changed(entry, changed_paths))
+            entry.clear();
+
+        list_results.emplace_back(std::move(entry));
+    }
+
+    return stream_ok(stream);
+}
+} // namespace
+
+
+namespace providers {
+namespace snapshot {
+
+QString default_path()
+{
+    return paths::writableCacheDir() + QStringLiteral("/library.snapshot");
+}
+
+QByteArray serialize(const SearchContext& sctx, const QString& config_key,
+                     const std::vector<QByteArray>& list_results)
+{
+    Q_ASSERT(sctx.sources_trackable);
+    const TraceSpan span("snapshot::serialize");
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+
+    stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << config_key;
+    write_sources(stream, sctx.source_paths);
+    write_results(stream, sctx);
+
+    stream << static_cast<quint32>(list_results.size());
+    for (const QByteArray& entry : list_results)
+        stream << entry;
+
+    return bytes;
+}
+
+QByteArray serialize_list_results(const SearchContext& sctx)
+{
+    const TraceSpan span("snapshot::serialize_list_results");
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+
+    stream << static_cast<quint32>(sctx.source_paths.size());
+    for (const QString& path : sctx.source_paths)
+        stream << path;
+    stream << sctx.sources_trackable;
+
+    write_results(stream, sctx);
+    return bytes;
+}
+
+bool deserialize_list_results(const QByteArray& bytes, SearchContext& sctx)
+{
+    Q_ASSERT(sctx.games.empty());
+    Q_ASSERT(sctx.collections.empty());
+    const TraceSpan span("snapshot::deserialize_list_results");
+
+    QDataStream stream(bytes);
+    stream.setVersion(STREAM_VERSION);
+
+    const quint32 source_count = read_count(stream);
+    sctx.source_paths.reserve(source_count);
+    for (quint32 i = 0; i < source_count && stream_ok(stream); i++) {
+        QString path;
+        stream >> path;
+        sctx.source_paths.emplace_back(std::move(path));
+    }
+    stream >> sctx.sources_trackable;
+
+    if (!stream_ok(stream) || !read_results(stream, sctx)) {
+        clear_results(sctx);
+        return false;
+    }
+
+    return true;
+}
+
+bool write(const QString& path, const QByteArray& bytes)
+{
+    const TraceSpan span("snapshot::write", path);
+
+    // NOTE: QSaveFile discards the changes if they are not committed
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        qWarning().noquote() << MSG_PREFIX
+            << tr_log("could not write the library snapshot `%1`").arg(path);
+        return false;
+    }
+
+    return true;
+}
+
+bool load(const QString& path, const QString& config_key, SearchContext& sctx, bool* is_outdated,
+          std::vector<QByteArray>* list_results)
+{
+    Q_ASSERT(sctx.games.empty());
+    Q_ASSERT(sctx.collections.empty());
+    const TraceSpan span("snapshot::load", path);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 file_size = file.size();
+    if (file_size <= 0 || std::numeric_limits<int>::max() < file_size)
+        return false;
+
+    // the mapping stays valid until the file is closed; strings are copied out during reading
+    const uchar* const mapping = file.map(0, file_size);
+    const QByteArray bytes = mapping
+        ? QByteArray::fromRawData(reinterpret_cast<const char*>(mapping), static_cast<int>(file_size))
+        : file.readAll();
+
+    QDataStream stream(bytes);
+    stream.setVersion(STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+        qInfo().noquote() << MSG_PREFIX << tr_log("snapshot format changed, library will be rescanned");
+        return false;
+    }
+
+    QString stored_key;
+    stream >> stored_key;
+    if (stored_key != config_key) {
+        qInfo().noquote() << MSG_PREFIX << tr_log("settings changed, library will be rescanned");
+        return false;
+    }
+
+    // NOTE: used as a set
+    HashMap<QString, bool> changed_paths;
+    HashMap<QString, bool>* const changed_paths_ptr = (is_outdated && list_results) ? &changed_paths : nullptr;
+
+    if (!read_sources(stream, sctx.source_paths, is_outdated, changed_paths_ptr)
+        || !read_results(stream, sctx)
+        || (list_results && !read_list_results(stream, changed_paths, *list_results)))
+    {
+        if (!stream_ok(stream)) {
+            qWarning().noquote() << MSG_PREFIX
+                << tr_log("`%1` seems to be corrupted, library will be rescanned").arg(path);
+        }
+        clear_results(sctx);
+        if (list_results)
+            list_results->clear();
+        return false;
+    }
+
+    qInfo().noquote() << MSG_PREFIX
+        << tr_log("library loaded from `%1`, %2 games found").arg(path, QString::number(sctx.games.size()));
+    return true;
+}
+
+} // namespace snapshot
+} // namespace providers
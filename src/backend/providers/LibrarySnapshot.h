@@ -0,0 +1,62 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "providers/Provider.h"
+
+#include <QByteArray>
+#include <QString>
+#include <vector>
+
+
+namespace providers {
+namespace snapshot {
+
+/// Returns the default location of the library snapshot
+QString default_path();
+
+/// Serializes the search results, along with the state of their source files.
+/// The config key should describe the settings that affect the results.
+/// The first stage results of the providers (see `serialize_list_results`)
+/// can be stored too, for reusing them when only some sources changed.
+QByteArray serialize(const SearchContext&, const QString& config_key,
+                     const std::vector<QByteArray>& list_results = {});
+
+/// Saves the serialized search results at the path.
+/// Returns false on error.
+bool write(const QString& path, const QByteArray&);
+
+/// Tries to restore the search results from a previously written snapshot.
+/// Returns false if there is no snapshot at the path, it was created with
+/// a different config key, or any of its source files changed since then.
+/// If `is_outdated` is set, changed sources do not fail the loading, instead
+/// the pointed value is set to true. If `list_results` is also set, it receives
+/// the stored first stage results of the providers, with the ones built from
+/// changed sources left empty.
+bool load(const QString& path, const QString& config_key, SearchContext&, bool* is_outdated = nullptr,
+          std::vector<QByteArray>* list_results = nullptr);
+
+/// Serializes what a single provider found during the first stage of the search,
+/// for reusing it in later searches. The state of the sources is not included.
+QByteArray serialize_list_results(const SearchContext&);
+
+/// Restores the results of `serialize_list_results`. Returns false on error.
+bool deserialize_list_results(const QByteArray&, SearchContext&);
+
+} // namespace snapshot
+} // namespace providers
@@ -0,0 +1,168 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "LibraryWatcher.h"
+
+#include "LocaleUtils.h"
+#include "utils/HashMap.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QStringList>
+#include <algorithm>
+#include <iterator>
+
+
+namespace {
+static constexpr auto MSG_PREFIX = "Watcher:";
+
+// NOTE: file operations often come in bursts, eg. when syncing a directory
+constexpr int CHANGE_DELAY_MS = 1500;
+
+QStringRef without_trailing_slash(const QString& path)
+{
+    return path.endsWith(QLatin1Char('/')) ? path.leftRef(path.length() - 1) : path.leftRef(-1);
+}
+
+/// Selects the files, and the directories not under another selected directory
+QStringList select_top_level(const QStringList& paths)
+{
+    std::vector<bool> is_dir(paths.size(), false);
+    // NOTE: used as a set
+    HashMap<QString, bool> dirs;
+    for (int i = 0; i < paths.size(); i++) {
+        is_dir[i] = QFileInfo(paths.at(i)).isDir();
+        if (is_dir[i])
+            dirs.emplace(without_trailing_slash(paths.at(i)).toString(), true);
+    }
+
+    QStringList selected;
+    for (int i = 0; i < paths.size(); i++) {
+        if (is_dir[i]) {
+            QStringRef dir = without_trailing_slash(paths.at(i));
+            bool nested = false;
+            int sep = dir.lastIndexOf(QLatin1Char('/'));
+            while (sep > 0 && !nested) {
+                dir = dir.left(sep);
+                nested = dirs.count(dir) > 0;
+                sep = dir.lastIndexOf(QLatin1Char('/'));
+            }
+            if (nested)
+                continue;
+        }
+
+        selected.append(paths.at(i));
+    }
+    return selected;
+}
+} // namespace
+
+
+namespace providers {
+
+LibraryWatcher::LibraryWatcher(QObject* parent)
+    : QObject(parent)
+{
+    m_delay.setSingleShot(true);
+    m_delay.setInterval(CHANGE_DELAY_MS);
+
+    connect(&m_delay, &QTimer::timeout,
+            this, &LibraryWatcher::changed);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &LibraryWatcher::onPathChanged);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &LibraryWatcher::onPathChanged);
+}
+
+void LibraryWatcher::setPaths(std::vector<QString> paths)
+{
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    QStringList existing_paths;
+    existing_paths.reserve(static_cast<int>(paths.size()));
+    for (QString& path : paths) {
+        if (QFileInfo::exists(path))
+            existing_paths.append(std::move(path));
+    }
+
+    QStringList failed_paths = applyPaths(existing_paths);
+    if (failed_paths.isEmpty())
+        return;
+
+    // NOTE: the number of watches is limited by the system (eg. to 8192 by default
+    // on Linux), which a library with lots of game subdirectories could reach
+    const QStringList top_level_paths = select_top_level(existing_paths);
+    qWarning().noquote() << MSG_PREFIX
+        << tr_log("could not watch %1 of %2 paths for changes, the system limit may have been reached; "
+                  "only the %3 top-level paths are watched, changes in their subdirectories "
+                  "will be noticed after a restart")
+           .arg(QString::number(failed_paths.size()), QString::number(existing_paths.size()),
+                QString::number(top_level_paths.size()));
+
+    failed_paths = applyPaths(top_level_paths);
+    if (!failed_paths.isEmpty()) {
+        qWarning().noquote() << MSG_PREFIX
+            << tr_log("could not watch %1 of the top-level paths either (eg. `%2`)")
+               .arg(QString::number(failed_paths.size()), failed_paths.first());
+    }
+}
+
+QStringList LibraryWatcher::applyPaths(const QStringList& paths)
+{
+    QStringList watched_paths = m_watcher.files() + m_watcher.directories();
+    std::sort(watched_paths.begin(), watched_paths.end());
+
+    // NOTE: only the difference is applied, so the unchanged paths
+    // remain watched during the update
+    QStringList removed_paths;
+    std::set_difference(watched_paths.cbegin(), watched_paths.cend(),
+                        paths.cbegin(), paths.cend(),
+                        std::back_inserter(removed_paths));
+    if (!removed_paths.isEmpty())
+        m_watcher.removePaths(removed_paths);
+
+    QStringList added_paths;
+    std::set_difference(paths.cbegin(), paths.cend(),
+                        watched_paths.cbegin(), watched_paths.cend(),
+                        std::back_inserter(added_paths));
+    if (added_paths.isEmpty())
+        return QStringList();
+
+    return m_watcher.addPaths(added_paths);
+}
+
+void LibraryWatcher::clear()
+{
+    m_delay.stop();
+
+    const QStringList files = m_watcher.files();
+    if (!files.isEmpty())
+        m_watcher.removePaths(files);
+
+    const QStringList dirs = m_watcher.directories();
+    if (!dirs.isEmpty())
+        m_watcher.removePaths(dirs);
+}
+
+void LibraryWatcher::onPathChanged(const QString& path)
+{
+    qInfo().noquote() << MSG_PREFIX << tr_log("`%1` changed").arg(path);
+    m_delay.start();
+}
+
+} // namespace providers
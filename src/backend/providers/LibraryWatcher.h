@@ -0,0 +1,57 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <vector>
+
+
+namespace providers {
+
+/// Watches the files and directories the search results were built from,
+/// and reports if any of them changes. Changes happening in quick succession
+/// (eg. copying multiple files) are reported only once.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcher(QObject* parent = nullptr);
+
+    /// Replaces the watched paths. Paths that do not exist are ignored. If the
+    /// system cannot watch all of them, only the files and the directories not
+    /// under other directories are watched.
+    void setPaths(std::vector<QString>);
+    void clear();
+
+signals:
+    void changed();
+
+private:
+    QFileSystemWatcher m_watcher;
+    QTimer m_delay;
+
+    /// Watches the sorted paths instead of the current ones, returns the ones that failed
+    QStringList applyPaths(const QStringList&);
+    void onPathChanged(const QString&);
+};
+
+} // namespace providers
@@ -0,0 +1,210 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "ParseCache.h"
+
+#include "DataStream.h"
+#include "LocaleUtils.h"
+#include "Paths.h"
+#include "Trace.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringBuilder>
+#include <limits>
+
+
+namespace {
+using namespace providers::datastream;
+
+static constexpr auto MSG_PREFIX = "Parse cache:";
+
+constexpr quint32 CACHE_MAGIC = 0x50475043; // "PGPC"
+// NOTE: increase this when the format of the cache file, or of the data
+// stored by any of the providers changes
+constexpr quint32 CACHE_VERSION = 1;
+
+// Files modified this recently may change again within the precision of the
+// file system timestamps, which would go unnoticed, so they are not cached
+constexpr qint64 RACY_PERIOD_MS = 3000;
+
+
+QString entry_key(const QString& provider, const QString& path)
+{
+    return provider % QLatin1Char('\n') % path;
+}
+} // namespace
+
+
+namespace providers {
+
+ParseCache::ParseCache(QString file_path)
+    : m_file_path(std::move(file_path))
+    , m_changed(false)
+{}
+
+QString ParseCache::defaultPath()
+{
+    return paths::writableCacheDir() + QStringLiteral("/parse.cache");
+}
+
+ParseCache::FileStamp ParseCache::stampOf(const QString& path)
+{
+    const QFileInfo finfo(path);
+    if (!finfo.isFile())
+        return {};
+
+    FileStamp stamp;
+    stamp.size = finfo.size();
+    stamp.mtime = finfo.lastModified().toMSecsSinceEpoch();
+    return stamp;
+}
+
+bool ParseCache::load()
+{
+    const TraceSpan span("parse_cache::load", m_file_path);
+
+    QFile file(m_file_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 file_size = file.size();
+    if (file_size <= 0 || std::numeric_limits<int>::max() < file_size)
+        return false;
+
+    // the mapping stays valid until the file is closed; the entries are copied out during reading
+    const uchar* const mapping = file.map(0, file_size);
+    const QByteArray bytes = mapping
+        ? QByteArray::fromRawData(reinterpret_cast<const char*>(mapping), static_cast<int>(file_size))
+        : file.readAll();
+
+    QDataStream stream(bytes);
+    stream.setVersion(STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+        return false;
+
+    HashMap<QString, Entry> entries;
+    const quint32 count = read_count(stream);
+    entries.reserve(count);
+    for (quint32 i = 0; i < count && stream_ok(stream); i++) {
+        QString key;
+        Entry entry { {}, {}, false };
+        stream >> key >> entry.stamp.size >> entry.stamp.mtime >> entry.data;
+
+        if (stream_ok(stream))
+            entries.emplace(std::move(key), std::move(entry));
+    }
+
+    if (!stream_ok(stream)) {
+        qWarning().noquote() << MSG_PREFIX
+            << tr_log("`%1` seems to be corrupted, ignored").arg(m_file_path);
+        return false;
+    }
+
+    QMutexLocker lock(&m_lock);
+    m_entries = std::move(entries);
+    m_changed = false;
+    return true;
+}
+
+bool ParseCache::save()
+{
+    QMutexLocker lock(&m_lock);
+    if (!m_changed)
+        return true;
+
+    const TraceSpan span("parse_cache::save", m_file_path);
+
+    QByteArray bytes;
+    {
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream.setVersion(STREAM_VERSION);
+
+        stream << CACHE_MAGIC << CACHE_VERSION << static_cast<quint32>(m_entries.size());
+        for (const auto& entry : m_entries)
+            stream << entry.first << entry.second.stamp.size << entry.second.stamp.mtime << entry.second.data;
+    }
+
+    // NOTE: QSaveFile discards the changes if they are not committed
+    QSaveFile file(m_file_path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        qWarning().noquote() << MSG_PREFIX
+            << tr_log("could not write the cache file `%1`").arg(m_file_path);
+        return false;
+    }
+
+    m_changed = false;
+    return true;
+}
+
+void ParseCache::dropUnused()
+{
+    QMutexLocker lock(&m_lock);
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+        if (it->second.used) {
+            ++it;
+            continue;
+        }
+
+        it = m_entries.erase(it);
+        m_changed = true;
+    }
+}
+
+QByteArray ParseCache::find(const QString& provider, const QString& path, FileStamp& stamp)
+{
+    stamp = stampOf(path);
+    if (!stamp.isValid())
+        return {};
+
+    const QString key = entry_key(provider, path);
+
+    QMutexLocker lock(&m_lock);
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->second.stamp != stamp)
+        return {};
+
+    it->second.used = true;
+    return it->second.data;
+}
+
+void ParseCache::insert(const QString& provider, const QString& path, const FileStamp& stamp, QByteArray data)
+{
+    if (!stamp.isValid() || data.isEmpty())
+        return;
+
+    const bool is_racy = QDateTime::currentMSecsSinceEpoch() - RACY_PERIOD_MS < stamp.mtime;
+    if (is_racy)
+        return;
+
+    QString key = entry_key(provider, path);
+
+    QMutexLocker lock(&m_lock);
+    m_entries[std::move(key)] = Entry { stamp, std::move(data), true };
+    m_changed = true;
+}
+
+} // namespace providers
@@ -0,0 +1,85 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+#include "utils/NoCopyNoMove.h"
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+
+namespace providers {
+
+/// Stores the parsed contents of the input files of the providers (eg. metadata
+/// files), in a provider-specific binary form, so unchanged files don't have
+/// to be parsed again on the next run. Entries are identified by the provider
+/// and the file path, and are only valid while the size and the modification
+/// time of the file stays the same. Thread safe.
+class ParseCache {
+public:
+    /// The state of a file at the time it was read
+    struct FileStamp {
+        qint64 size = -1;
+        qint64 mtime = -1;
+
+        bool isValid() const { return 0 <= size && 0 <= mtime; }
+        bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    explicit ParseCache(QString file_path = defaultPath());
+    NO_COPY_NO_MOVE(ParseCache)
+
+    static QString defaultPath();
+    static FileStamp stampOf(const QString& path);
+
+    /// Reads the entries from the disk. Returns false if there was no usable cache file.
+    bool load();
+    /// Writes the entries to the disk, if anything changed since loading
+    bool save();
+    /// Forgets the entries that were not looked up since loading,
+    /// eg. the ones of deleted files
+    void dropUnused();
+
+    /// Returns the cached data of the file, or an empty array if there is no
+    /// valid entry. `stamp` is set to the current state of the file, and should
+    /// be passed to `insert()` after parsing, so changes made during the parsing
+    /// will be noticed later.
+    QByteArray find(const QString& provider, const QString& path, FileStamp& stamp);
+    /// Stores the parsed data of the file, if the file was not modified too
+    /// recently to reliably notice further changes
+    void insert(const QString& provider, const QString& path, const FileStamp& stamp, QByteArray data);
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        QByteArray data;
+        bool used;
+    };
+
+    const QString m_file_path;
+
+    QMutex m_lock;
+    HashMap<QString, Entry> m_entries;
+    bool m_changed;
+};
+
+} // namespace providers
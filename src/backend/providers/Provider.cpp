@@ -20,8 +20,14 @@
 
 namespace providers {
 
-Provider::Provider(QObject* parent)
+Provider::Provider(unsigned char flags, QObject* parent)
+    : Provider(flags, {}, parent)
+{}
+
+Provider::Provider(unsigned char flags, QStringList enhanced_collections, QObject* parent)
     : QObject(parent)
+    , m_flags(flags)
+    , m_enhanced_collections(std::move(enhanced_collections))
 {}
 
 Provider::~Provider() = default;
@@ -18,53 +18,113 @@
 #pragma once
 
 #include "modeldata/gaming/GameData.h"
+#include "modeldata/gaming/GameStore.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "utils/FwdDeclModel.h"
 #include "utils/HashMap.h"
+#include "providers/ParseCache.h"
+#include "utils/DirListingCache.h"
+#include "utils/PathCache.h"
+#include "utils/StringPool.h"
 
 #include <QString>
+#include <QStringList>
 #include <QObject>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 
 namespace providers {
 
+/// Describes which initialization stages a provider takes part in
+enum ProviderFlags : unsigned char {
+    PROVIDES_LISTS = 1 << 0,
+    PROVIDES_STATIC_DATA = 1 << 1,
+    PROVIDES_DYNAMIC_DATA = 1 << 2,
+};
+
 struct SearchContext {
     std::vector<modeldata::Game> games;
     HashMap<QString, modeldata::Collection> collections;
     HashMap<QString, std::vector<size_t>> collection_childs;
     HashMap<QString, size_t> path_to_gameidx;
+
+    /// Files and directories the results were built from. If any of them changes
+    /// (eg. a file gets added to a directory), the results are considered outdated.
+    /// The paths do not have to exist.
+    std::vector<QString> source_paths;
+    /// False if some of the results came from sources that cannot be described
+    /// by paths (eg. the Windows registry), thus cannot be checked for changes
+    bool sources_trackable = true;
+
+    /// Set when the search gets cancelled. Providers should check it in their
+    /// longer loops (eg. directory walks, file parsing) and return early.
+    std::shared_ptr<const std::atomic<bool>> cancel_flag;
+
+    bool cancelled() const { return cancel_flag && cancel_flag->load(); }
+
+    /// Every directory is resolved only once during a search, so the canonical
+    /// paths of the files should be looked up through this cache. It is shared
+    /// between the providers of the same search.
+    std::shared_ptr<PathCache> path_cache = std::make_shared<PathCache>();
+    /// Similarly, every directory is read only once during a search, so the
+    /// directory walks should go through this cache.
+    std::shared_ptr<DirListingCache> dir_cache = std::make_shared<DirListingCache>();
+    /// The repeated text fields of the games (eg. developers, launch commands)
+    /// should be interned through this pool, so they share their memory.
+    std::shared_ptr<StringPool> string_pool = std::make_shared<StringPool>();
+
+    /// The parsed contents of the input files from the previous runs, if available.
+    /// Providers reading files may use it to skip parsing the unchanged ones.
+    std::shared_ptr<ParseCache> parse_cache;
 };
 
 class Provider : public QObject {
     Q_OBJECT
 
 public:
-    explicit Provider(QObject* parent = nullptr);
+    explicit Provider(unsigned char flags, QObject* parent = nullptr);
+    explicit Provider(unsigned char flags, QStringList enhanced_collections, QObject* parent = nullptr);
     virtual ~Provider();
 
+    unsigned char flags() const { return m_flags; }
+    /// The collections whose games may be modified during the second stage.
+    /// If empty, any game may be modified.
+    const QStringList& enhancedCollections() const { return m_enhanced_collections; }
+
     /// Initialization first stage:
     /// Find all games and collections.
+    /// NOTE: The providers run in parallel, each with its own, initially empty
+    /// search context. The results are merged in the order of the providers.
     virtual void findLists(SearchContext&) {}
 
     /// Initialization second stage:
     /// Enhance the previously found games and collections with metadata and assets.
+    /// NOTE: Providers with non-overlapping enhanced collections may run in parallel,
+    /// thus they should not modify anything else in the search context.
     virtual void findStaticData(SearchContext&) {}
 
     /// Initialization third stage:
-    /// Find data that may change during the runtime for all games
+    /// Find data that may change during the runtime for the newly found games.
+    /// The path map has the canonical paths of their files, with the index
+    /// of the file in the store as value.
     virtual void findDynamicData(const QVector<model::Collection*>&,
-                                 const QVector<model::Game*>&,
-                                 const HashMap<QString, model::GameFile*>&) {}
+                                 modeldata::GameStore&,
+                                 const HashMap<QString, size_t>&) {}
 
 
     // events
-    virtual void onGameFavoriteChanged(const QVector<model::Game*>&) {}
+    virtual void onGameFavoriteChanged(const modeldata::GameStore&) {}
     virtual void onGameLaunched(model::GameFile* const) {}
     virtual void onGameFinished(model::GameFile* const) {}
 
 signals:
     void gameCountChanged(int);
+
+private:
+    const unsigned char m_flags;
+    const QStringList m_enhanced_collections;
 };
 
 } // namespace providers
@@ -19,33 +19,100 @@
 
 #include "AppSettings.h"
 #include "EnabledProviders.h"
+#include "LibrarySnapshot.h"
 #include "LocaleUtils.h"
+#include "Trace.h"
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
+#include "modeldata/gaming/GameListSort.h"
+#include "modeldata/gaming/GameStore.h"
+#include "utils/Collation.h"
 #include "utils/HashMap.h"
 
 #include "QtQmlTricks/QQmlObjectListModel.h"
 #include <QDebug>
 #include <QtConcurrent/QtConcurrent>
+#include <functional>
+#include <numeric>
+#include <unordered_set>
+
+
+/// The search results, as handed over to the UI thread
+struct PublishedResults {
+    std::unique_ptr<providers::SearchContext> ctx;
+    modeldata::GameStore games;
+    /// The games of the library are the first games of the store, unchanged
+    bool extends_library = false;
+    std::vector<quint32> title_ranks;
+    /// Every game, in title order
+    std::vector<size_t> all_games;
+    /// The locale the games were sorted for
+    QString sort_locale;
+};
 
 
 namespace {
-void sort_games(QVector<model::Game*>& games)
+/// Orders the games of the results, as well as the game lists of the collections
+void sort_results(PublishedResults& results, const QString& sort_locale)
 {
-    std::sort(games.begin(), games.end(),
-        [](const model::Game* const a, const model::Game* const b) {
-            return QString::localeAwareCompare(a->title(), b->title()) < 0;
-        }
-    );
+    const TraceSpan span("sort_results", QString::number(results.games.size()));
+
+    results.games.updateSortKeys(collation::create_collator(sort_locale), AppSettings::general.sort_ignore_articles);
+    results.title_ranks = results.games.titleRanks();
+    results.all_games = modeldata::sort_game_lists(results.ctx->collection_childs, results.title_ranks);
+    results.sort_locale = sort_locale;
 }
 
-void sort_collections(QVector<model::Collection*>& collections)
+/// Returns the collation keys of the collection names, in list order
+std::vector<QCollatorSortKey> collection_sort_keys(const QQmlObjectListModel<model::Collection>& collection_model,
+                                                   const QCollator& collator)
 {
-    std::sort(collections.begin(), collections.end(),
-        [](const model::Collection* const a, const model::Collection* const b) {
-            return QString::localeAwareCompare(a->name(), b->name()) < 0;
-        }
-    );
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(static_cast<size_t>(collection_model.count()));
+    for (const model::Collection* const q_coll : collection_model.asList())
+        keys.emplace_back(collator.sortKey(q_coll->name()));
+
+    return keys;
+}
+
+void sort_collection_model(QQmlObjectListModel<model::Collection>& collection_model, const QCollator& collator)
+{
+    const TraceSpan span("sort_collections", QString::number(collection_model.count()));
+
+    const std::vector<QCollatorSortKey> keys = collection_sort_keys(collection_model, collator);
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&keys](size_t a, size_t b){ return keys[a] < keys[b]; });
+
+    // NOTE: the items are moved one by one to keep the QML side intact
+    const QVector<model::Collection*> items = collection_model.asList();
+    for (size_t row = 0; row < order.size(); row++) {
+        const int current_row = collection_model.indexOf(items[static_cast<int>(order[row])]);
+        if (current_row != static_cast<int>(row))
+            collection_model.move(current_row, static_cast<int>(row));
+    }
+}
+
+QString provider_name(const providers::Provider& provider)
+{
+    return QString::fromLatin1(provider.metaObject()->className());
+}
+
+QString create_snapshot_key(const std::vector<ProviderPtr>& providers)
+{
+    // the snapshot is only valid for the same set of providers and game directories
+    QStringList key_parts;
+    for (const ProviderPtr& ptr : providers)
+        key_parts << provider_name(*ptr);
+
+    AppSettings::parse_gamedirs([&key_parts](const QString& line){
+        key_parts << line;
+    });
+
+    return key_parts.join(QLatin1Char('\n'));
 }
 
 void remove_empty_collections(providers::SearchContext& ctx)
@@ -67,166 +134,1016 @@ void remove_empty_collections(providers::SearchContext& ctx)
     }
 }
 
-void run_list_providers(providers::SearchContext& ctx, const std::vector<ProviderPtr>& providers)
+void merge_collection(modeldata::Collection& target, modeldata::Collection& source)
 {
-    for (const ProviderPtr& ptr : providers)
-        ptr->findLists(ctx);
+    // later providers may override the values found by the previous ones
+    if (!source.shortName().isEmpty())
+        target.setShortName(source.shortName());
+    if (!source.summary.isEmpty())
+        target.summary = std::move(source.summary);
+    if (!source.description.isEmpty())
+        target.description = std::move(source.description);
+    if (!source.launch_cmd.isEmpty())
+        target.launch_cmd = std::move(source.launch_cmd);
+    if (!source.launch_workdir.isEmpty())
+        target.launch_workdir = std::move(source.launch_workdir);
+}
+
+std::vector<std::vector<QString>> find_paths_of_games(const providers::SearchContext& ctx, size_t game_count)
+{
+    std::vector<std::vector<QString>> paths_of_game(game_count);
+    for (const auto& entry : ctx.path_to_gameidx)
+        paths_of_game.at(entry.second).emplace_back(entry.first);
+
+    return paths_of_game;
+}
+
+/// Moves the results of a single provider into the common search context.
+/// Games that are already known by one of their paths are not added again,
+/// in which case the collections refer to the existing entry.
+void merge_results(providers::SearchContext& target, providers::SearchContext& source)
+{
+    std::vector<std::vector<QString>> paths_of_game = find_paths_of_games(source, source.games.size());
+
+    std::vector<size_t> gameidx_map(source.games.size());
+    for (size_t idx = 0; idx < source.games.size(); idx++) {
+        std::vector<QString>& paths = paths_of_game[idx];
+
+        size_t target_idx = target.games.size();
+        for (const QString& path : paths) {
+            const auto it = target.path_to_gameidx.find(path);
+            if (it != target.path_to_gameidx.cend())
+                target_idx = std::min(target_idx, it->second);
+        }
+
+        if (target_idx == target.games.size())
+            target.games.emplace_back(std::move(source.games[idx]));
+
+        for (QString& path : paths) {
+            if (!target.path_to_gameidx.count(path))
+                target.path_to_gameidx.emplace(std::move(path), target_idx);
+        }
+        gameidx_map[idx] = target_idx;
+    }
+
+    for (auto& entry : source.collections) {
+        const auto it = target.collections.find(entry.first);
+        if (it == target.collections.end())
+            target.collections.emplace(entry.first, std::move(entry.second));
+        else
+            merge_collection(it->second, entry.second);
+    }
+
+    for (const auto& entry : source.collection_childs) {
+        std::vector<size_t>& childs = target.collection_childs[entry.first];
+        childs.reserve(childs.size() + entry.second.size());
+        for (const size_t game_idx : entry.second)
+            childs.emplace_back(gameidx_map.at(game_idx));
+    }
+
+    target.source_paths.insert(target.source_paths.end(),
+        std::make_move_iterator(source.source_paths.begin()),
+        std::make_move_iterator(source.source_paths.end()));
+    target.sources_trackable &= source.sources_trackable;
+}
+
+void copy_assets(const modeldata::GameAssets& source, modeldata::GameAssets& target)
+{
+    for (const auto& entry : source.singleAssets()) {
+        if (!entry.second.isEmpty())
+            target.setSingle(entry.first, entry.second);
+    }
+    for (const auto& entry : source.multiAssets()) {
+        for (const QString& value : entry.second)
+            target.appendMulti(entry.first, value);
+    }
+}
+
+modeldata::Game clone_game(const modeldata::Game& game)
+{
+    modeldata::Game copy(game.title);
+    copy.summary = game.summary;
+    copy.description = game.description;
+    copy.launch_cmd = game.launch_cmd;
+    copy.launch_workdir = game.launch_workdir;
+    copy.player_count = game.player_count;
+    copy.is_favorite = game.is_favorite;
+    copy.rating = game.rating;
+    copy.release_date = game.release_date;
+    copy.developers = game.developers;
+    copy.publishers = game.publishers;
+    copy.genres = game.genres;
+    copy_assets(game.assets, copy.assets);
+
+    copy.files.reserve(game.files.size());
+    for (const modeldata::GameFile& file : game.files) {
+        copy.files.emplace_back(file.fileinfo);
+        modeldata::GameFile& file_copy = copy.files.back();
+        file_copy.canonical_path = file.canonical_path;
+        file_copy.name = file.name;
+        file_copy.last_played = file.last_played;
+        file_copy.play_time = file.play_time;
+        file_copy.play_count = file.play_count;
+    }
+
+    return copy;
+}
+
+modeldata::Collection clone_collection(const modeldata::Collection& coll)
+{
+    modeldata::Collection copy(coll.name);
+    if (!coll.shortName().isEmpty())
+        copy.setShortName(coll.shortName());
+    copy.summary = coll.summary;
+    copy.description = coll.description;
+    copy.launch_cmd = coll.launch_cmd;
+    copy.launch_workdir = coll.launch_workdir;
+    copy_assets(coll.assets, copy.assets);
+    return copy;
+}
+
+/// Prepares the results of an unfinished search for publishing. During the first
+/// stage the games are only ever appended, so only the new ones are added to the
+/// store of the previously published games, and the store gets copied as a whole.
+std::unique_ptr<PublishedResults> create_partial_results(const providers::SearchContext& ctx,
+                                                         modeldata::GameStore& published_games,
+                                                         const QCollator& collator,
+                                                         const QString& sort_locale)
+{
+    for (size_t idx = published_games.size(); idx < ctx.games.size(); idx++)
+        published_games.append(clone_game(ctx.games[idx]));
+    published_games.appendSortKeys(collator, AppSettings::general.sort_ignore_articles);
+
+    std::unique_ptr<PublishedResults> results(new PublishedResults());
+    results->ctx.reset(new providers::SearchContext());
+    for (const auto& entry : ctx.collection_childs) {
+        const auto coll_it = ctx.collections.find(entry.first);
+        if (entry.second.empty() || coll_it == ctx.collections.cend())
+            continue;
+
+        results->ctx->collections.emplace(entry.first, clone_collection(coll_it->second));
+        results->ctx->collection_childs.emplace(entry.first, entry.second);
+    }
+
+    results->games = published_games.clone();
+    results->extends_library = true;
+    results->title_ranks = results->games.titleRanks();
+    results->all_games = modeldata::sort_game_lists(results->ctx->collection_childs, results->title_ranks);
+    results->sort_locale = sort_locale;
+    return results;
+}
+
+/// The providers without reusable results in the cache, as a provider mask
+unsigned find_uncached_providers(const ListCache& list_cache)
+{
+    unsigned mask = 0;
+    for (size_t i = 0; i < list_cache.size(); i++) {
+        if (list_cache[i].isEmpty())
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+/// Runs the first stage of the search. If a cache is provided, the results of the
+/// providers not selected by the mask are taken from it, and it gets updated with the
+/// new results. An empty cache is filled with the results of every provider.
+/// Returns true if every provider was searched.
+bool run_list_providers(providers::SearchContext& ctx, const std::vector<ProviderPtr>& providers,
+                        unsigned provider_mask, ListCache* const list_cache,
+                        const std::function<void(const providers::SearchContext&)>& on_partial_results)
+{
+    const bool use_cache = list_cache && list_cache->size() == providers.size();
+
+    // each provider gets its own search context, and the results are merged
+    // in a fixed order afterwards, independently of which one finished first
+    std::vector<providers::SearchContext> partials(providers.size());
+    std::vector<QFuture<void>> tasks(providers.size());
+    std::vector<bool> searched(providers.size(), false);
+    bool searched_all = true;
+
+    for (size_t i = 0; i < providers.size(); i++) {
+        providers::Provider* const provider = providers[i].get();
+        if (!(provider->flags() & providers::PROVIDES_LISTS))
+            continue;
+        if (use_cache && !(provider_mask & (1u << i))) {
+            searched_all = false;
+            continue;
+        }
+
+        providers::SearchContext* const partial = &partials[i];
+        partial->cancel_flag = ctx.cancel_flag;
+        partial->path_cache = ctx.path_cache;
+        partial->dir_cache = ctx.dir_cache;
+        partial->string_pool = ctx.string_pool;
+        partial->parse_cache = ctx.parse_cache;
+        searched[i] = true;
+        tasks[i] = QtConcurrent::run([provider, partial]{
+            const TraceSpan span("findLists", provider_name(*provider));
+            provider->findLists(*partial);
+        });
+    }
+
+    if (list_cache && !use_cache) {
+        list_cache->clear();
+        list_cache->resize(providers.size());
+    }
+
+    for (size_t i = 0; i < providers.size(); i++) {
+        tasks[i].waitForFinished();
+        if (ctx.cancelled())
+            continue;
+
+        // NOTE: the cache is kept serialized, as a single allocation per provider
+        // instead of the many small ones of copied games and collections
+        if (list_cache) {
+            QByteArray& cached = (*list_cache)[i];
+            if (searched[i])
+                cached = providers::snapshot::serialize_list_results(partials[i]);
+            else if (!cached.isEmpty())
+                providers::snapshot::deserialize_list_results(cached, partials[i]);
+        }
+
+        const size_t game_count_before = ctx.games.size();
+        {
+            const TraceSpan span("merge_results", provider_name(*providers[i]));
+            merge_results(ctx, partials[i]);
+        }
+        if (on_partial_results && game_count_before != ctx.games.size())
+            on_partial_results(ctx);
+    }
+
+    // NOTE: the providers may have stopped halfway, so their results cannot be reused
+    if (ctx.cancelled()) {
+        if (list_cache)
+            list_cache->clear();
+        return false;
+    }
 
     remove_empty_collections(ctx);
+    return searched_all;
+}
+
+/// The games a provider may modify during the second stage, as a sorted list
+/// of game indices. Empty if any game may be modified.
+std::vector<size_t> find_enhanced_games(const providers::SearchContext& ctx,
+                                        const providers::Provider& provider)
+{
+    std::vector<size_t> game_indices;
+
+    for (const QString& coll_name : provider.enhancedCollections()) {
+        const auto it = ctx.collection_childs.find(coll_name);
+        if (it != ctx.collection_childs.cend())
+            game_indices.insert(game_indices.end(), it->second.cbegin(), it->second.cend());
+    }
+
+    std::sort(game_indices.begin(), game_indices.end());
+    game_indices.erase(std::unique(game_indices.begin(), game_indices.end()), game_indices.end());
+    return game_indices;
 }
 
+struct AssetTask {
+    bool everything;
+    std::vector<size_t> game_indices;
+    QFuture<void> future;
+
+    bool overlaps(const AssetTask& other) const {
+        if (everything || other.everything)
+            return true;
+
+        auto it_a = game_indices.cbegin();
+        auto it_b = other.game_indices.cbegin();
+        while (it_a != game_indices.cend() && it_b != other.game_indices.cend()) {
+            if (*it_a == *it_b)
+                return true;
+            if (*it_a < *it_b)
+                ++it_a;
+            else
+                ++it_b;
+        }
+        return false;
+    }
+};
+
 void run_asset_providers(providers::SearchContext& ctx, const std::vector<ProviderPtr>& providers)
 {
-    for (const auto& provider : providers)
-        provider->findStaticData(ctx);
+    // The providers are started in order, each one after all the previous
+    // ones that may touch the same games have finished. This keeps the results
+    // the same as running them one by one.
+    std::vector<AssetTask> tasks;
+    tasks.reserve(providers.size());
+
+    for (const ProviderPtr& ptr : providers) {
+        providers::Provider* const provider = ptr.get();
+        if (!(provider->flags() & providers::PROVIDES_STATIC_DATA))
+            continue;
+        if (ctx.cancelled())
+            break;
+
+        AssetTask task;
+        task.everything = provider->enhancedCollections().isEmpty();
+        if (!task.everything) {
+            task.game_indices = find_enhanced_games(ctx, *provider);
+            if (task.game_indices.empty())
+                continue;
+        }
+
+        for (AssetTask& prev_task : tasks) {
+            if (prev_task.overlaps(task))
+                prev_task.future.waitForFinished();
+        }
+
+        providers::SearchContext* const ctx_ptr = &ctx;
+        task.future = QtConcurrent::run([provider, ctx_ptr]{
+            const TraceSpan span("findStaticData", provider_name(*provider));
+            provider->findStaticData(*ctx_ptr);
+        });
+        tasks.emplace_back(std::move(task));
+    }
+
+    for (AssetTask& task : tasks)
+        task.future.waitForFinished();
 }
 
-void build_ui_layer(providers::SearchContext& ctx,
-                    QThread* const ui_thread,
-                    QQmlObjectListModel<model::Collection>& collection_model,
-                    QQmlObjectListModel<model::Game>& game_model,
-                    HashMap<QString, model::GameFile*>& path_map)
+bool same_assets(const modeldata::GameAssets& a, const modeldata::GameAssets& b)
 {
-    QVector<model::Game*> q_games;
-    q_games.reserve(static_cast<int>(ctx.games.size()));
+    // NOTE: reading a missing asset creates an empty entry, so those are ignored
+    const auto count_nonempty = [](const modeldata::GameAssets& assets){
+        size_t count = 0;
+        for (const auto& entry : assets.singleAssets())
+            count += entry.second.isEmpty() ? 0 : 1;
+        for (const auto& entry : assets.multiAssets())
+            count += entry.second.isEmpty() ? 0 : 1;
+        return count;
+    };
+    if (count_nonempty(a) != count_nonempty(b))
+        return false;
 
-    for (modeldata::Game& game : ctx.games) {
-        auto q_game = new model::Game(std::move(game));
-        q_game->moveToThread(ui_thread);
-        q_games.append(q_game);
+    for (const auto& entry : a.singleAssets()) {
+        const auto it = b.singleAssets().find(entry.first);
+        if (!entry.second.isEmpty() && (it == b.singleAssets().cend() || it->second != entry.second))
+            return false;
+    }
+    for (const auto& entry : a.multiAssets()) {
+        const auto it = b.multiAssets().find(entry.first);
+        if (!entry.second.isEmpty() && (it == b.multiAssets().cend() || it->second != entry.second))
+            return false;
     }
+    return true;
+}
 
+bool same_files(const modeldata::GameStore& old_store, size_t old_idx,
+                const modeldata::GameStore& store, size_t idx)
+{
+    if (old_store.fileCount(old_idx) != store.fileCount(idx))
+        return false;
 
-    QVector<model::Collection*> q_collections;
-    q_collections.reserve(static_cast<int>(ctx.collections.size()));
+    const size_t old_first = old_store.firstFile(old_idx);
+    const size_t first = store.firstFile(idx);
+    for (size_t i = 0; i < store.fileCount(idx); i++) {
+        if (old_store.filePath(old_first + i) != store.filePath(first + i)
+            || old_store.fileName(old_first + i) != store.fileName(first + i))
+            return false;
+    }
+    return true;
+}
+
+/// Keeps the data that may have changed during the runtime
+void copy_dynamic_data(const modeldata::GameStore& old_store, size_t old_idx,
+                       modeldata::GameStore& store, size_t idx)
+{
+    store.setFavorite(idx, old_store.isFavorite(old_idx));
 
-    for (auto& keyval : ctx.collections) {
-        auto q_coll = new model::Collection(std::move(keyval.second));
-        q_coll->moveToThread(ui_thread);
-        q_collections.append(q_coll);
+    const size_t old_first = old_store.firstFile(old_idx);
+    const size_t first = store.firstFile(idx);
+    for (size_t i = 0; i < store.fileCount(idx); i++) {
+        store.setPlayStats(first + i,
+                           old_store.playCount(old_first + i),
+                           old_store.playTime(old_first + i),
+                           old_store.lastPlayed(old_first + i));
     }
+}
 
-    sort_collections(q_collections);
-    collection_model.append(q_collections);
+bool same_static_data(const modeldata::Collection& a, const modeldata::Collection& b)
+{
+    return a.shortName() == b.shortName()
+        && a.summary == b.summary
+        && a.description == b.description
+        && a.launch_cmd == b.launch_cmd
+        && a.launch_workdir == b.launch_workdir
+        && same_assets(a.assets, b.assets);
+}
 
+/// Moves the found games into a columnar store, which then becomes
+/// the store of the library
+modeldata::GameStore create_game_store(std::vector<modeldata::Game>& games)
+{
+    const TraceSpan span("create_game_store", QString::number(games.size()));
 
-    for (model::Collection* const q_coll : q_collections) {
-        const std::vector<size_t>& game_indices = ctx.collection_childs[q_coll->name()];
+    modeldata::GameStore store;
+    store.reserve(games.size());
+    for (modeldata::Game& game : games)
+        store.append(std::move(game));
 
-        QVector<model::Game*> q_childs;
-        q_childs.reserve(static_cast<int>(game_indices.size()));
+    games.clear();
+    return store;
+}
 
-        for (size_t game_idx : game_indices)
-            q_childs.append(q_games.at(static_cast<int>(game_idx)));
+/// Finds the games of the search results that are already in the library,
+/// by any of their paths. Games whose files have changed are considered new.
+/// Returns the previous index of every game, or NO_GAME for the new ones.
+/// The runtime data of the known games is copied into the results.
+std::vector<size_t> find_known_games(const modeldata::GameStore& old_store, PublishedResults& results)
+{
+    modeldata::GameStore& store = results.games;
+    std::vector<size_t> old_indices(store.size(), model::Library::NO_GAME);
+    if (old_store.size() == 0)
+        return old_indices;
 
-        sort_games(q_childs);
-        q_coll->setGameList(q_childs);
-    }
+    HashMap<QString, size_t> known_games;
+    known_games.reserve(old_store.totalFileCount());
+    for (size_t file_idx = 0; file_idx < old_store.totalFileCount(); file_idx++)
+        known_games.emplace(old_store.canonicalPath(file_idx), old_store.fileGame(file_idx));
 
+    const std::vector<std::vector<QString>> paths_of_game = find_paths_of_games(*results.ctx, store.size());
+    std::vector<bool> matched(old_store.size(), false);
 
-    path_map.reserve(ctx.path_to_gameidx.size());
-    for (auto entry : ctx.path_to_gameidx) {
-        const model::Game* const q_game = q_games.at(static_cast<int>(entry.second));
+    for (size_t idx = 0; idx < store.size(); idx++) {
+        for (const QString& path : paths_of_game[idx]) {
+            const auto it = known_games.find(path);
+            if (it == known_games.cend() || matched[it->second])
+                continue;
 
-        for (model::GameFile* const q_gamefile : q_game->filesConst()) {
-            QString path = q_gamefile->data().fileinfo.canonicalFilePath();
-            Q_ASSERT(!path.isEmpty());
-            if (Q_LIKELY(!path.isEmpty()))
-                path_map.emplace(std::move(path), q_gamefile);
+            const size_t old_idx = it->second;
+            matched[old_idx] = true;
+
+            if (same_files(old_store, old_idx, store, idx)) {
+                copy_dynamic_data(old_store, old_idx, store, idx);
+                old_indices[idx] = old_idx;
+            }
+            break;
         }
     }
+    return old_indices;
+}
 
+/// Same as find_known_games, for results that only add new games to the library
+std::vector<size_t> find_extended_games(const modeldata::GameStore& old_store, modeldata::GameStore& store)
+{
+    Q_ASSERT(old_store.size() <= store.size());
 
-    sort_games(q_games);
-    game_model.append(q_games);
+    std::vector<size_t> old_indices(store.size(), model::Library::NO_GAME);
+    for (size_t idx = 0; idx < old_store.size(); idx++) {
+        copy_dynamic_data(old_store, idx, store, idx);
+        old_indices[idx] = idx;
+    }
+    return old_indices;
 }
-} // namespace
 
+/// Updates the library and the models to match the search results. Games and
+/// collections already in the models are kept and updated in place. The lists
+/// are changed in three steps: first the removed entries are removed (while
+/// the previous store is still active), then the new store is set and the
+/// remaining entries get remapped, finally the new entries are inserted.
+void apply_search_results(PublishedResults& results,
+                          const std::vector<size_t>& old_indices,
+                          model::Library& library,
+                          model::GameList& game_model,
+                          QQmlObjectListModel<model::Collection>& collection_model)
+{
+    providers::SearchContext& ctx = *results.ctx;
+    const modeldata::GameStore& old_store = library.store();
+    const size_t game_count = results.games.size();
+    const TraceSpan span("apply_search_results", QString::number(game_count));
 
-ProviderManager::ProviderManager(QObject* parent)
-    : QObject(parent)
+    // the games whose title has changed are moved to their new position
+    std::vector<size_t> new_indices(old_store.size(), model::Library::NO_GAME);
+    std::vector<bool> resorted(game_count, false);
+    for (size_t idx = 0; idx < game_count; idx++) {
+        const size_t old_idx = old_indices[idx];
+        if (old_idx == model::Library::NO_GAME)
+            continue;
+
+        new_indices[old_idx] = idx;
+        resorted[idx] = old_store.title(old_idx) != results.games.title(idx);
+    }
+    const auto is_removed = [&new_indices, &resorted](size_t old_idx){
+        return new_indices[old_idx] == model::Library::NO_GAME || resorted[new_indices[old_idx]];
+    };
+
+
+    // step 1: removal
+
+    game_model.removeEntries(is_removed);
+
+    HashMap<QString, model::Collection*> kept_collections;
+    std::vector<bool> wanted(game_count, false);
+    for (int i = collection_model.count() - 1; i >= 0; i--) {
+        model::Collection* const q_coll = collection_model.at(i);
+        const auto it = ctx.collections.find(q_coll->name());
+        if (it == ctx.collections.end()) {
+            collection_model.remove(i);
+            continue;
+        }
+
+        if (!same_static_data(q_coll->data(), it->second))
+            q_coll->updateStaticData(std::move(it->second));
+
+        const std::vector<size_t>& game_indices = ctx.collection_childs[q_coll->name()];
+        for (const size_t game_idx : game_indices)
+            wanted[game_idx] = true;
+
+        q_coll->games().removeEntries([&is_removed, &new_indices, &wanted](size_t old_idx){
+            return is_removed(old_idx) || !wanted[new_indices[old_idx]];
+        });
+
+        for (const size_t game_idx : game_indices)
+            wanted[game_idx] = false;
+
+        kept_collections.emplace(q_coll->name(), q_coll);
+    }
+
+
+    // step 2: remapping
+
+    library.replaceStore(std::move(results.games), old_indices);
+
+    game_model.remapEntries(new_indices);
+    for (const auto& entry : kept_collections)
+        entry.second->games().remapEntries(new_indices);
+
+
+    // step 3: insertion
+
+    const QCollator collator = collation::create_collator(results.sort_locale);
+    std::vector<QCollatorSortKey> collection_keys = collection_sort_keys(collection_model, collator);
+
+    const auto find_missing = [&wanted](const model::GameList& list, std::vector<size_t> game_indices){
+        for (const size_t game_idx : list.entries())
+            wanted[game_idx] = true;
+
+        game_indices.erase(std::remove_if(game_indices.begin(), game_indices.end(),
+                                          [&wanted](size_t game_idx){ return wanted[game_idx]; }),
+                           game_indices.end());
+
+        for (const size_t game_idx : list.entries())
+            wanted[game_idx] = false;
+
+        return game_indices;
+    };
+
+    game_model.insertEntries(find_missing(game_model, std::move(results.all_games)), results.title_ranks);
+    game_model.refresh();
+
+    for (auto& entry : ctx.collections) {
+        const std::vector<size_t>& game_indices = ctx.collection_childs[entry.first];
+
+        const auto it = kept_collections.find(entry.first);
+        if (it != kept_collections.cend()) {
+            model::GameList& list = it->second->games();
+            list.insertEntries(find_missing(list, game_indices), results.title_ranks);
+            list.refresh();
+            continue;
+        }
+
+        auto q_coll = new model::Collection(std::move(entry.second), library);
+        q_coll->games().insertEntries(game_indices, results.title_ranks);
+
+        QCollatorSortKey key = collator.sortKey(q_coll->name());
+        const auto pos = std::lower_bound(collection_keys.begin(), collection_keys.end(), key);
+        const int row = static_cast<int>(pos - collection_keys.begin());
+        collection_keys.insert(pos, std::move(key));
+        collection_model.insert(row, q_coll);
+    }
+}
+
+std::vector<ProviderPtr> create_providers()
 {
-    m_providers.emplace_back(new providers::pegasus::PegasusProvider());
-    m_providers.emplace_back(new providers::favorites::Favorites());
-    m_providers.emplace_back(new providers::playtime::PlaytimeStats());
+    std::vector<ProviderPtr> list;
+    list.emplace_back(new providers::pegasus::PegasusProvider());
+    list.emplace_back(new providers::favorites::Favorites());
+    list.emplace_back(new providers::playtime::PlaytimeStats());
 #ifdef WITH_COMPAT_STEAM
     if (AppSettings::ext_providers.at(ExtProvider::STEAM).enabled)
-        m_providers.emplace_back(new providers::steam::SteamProvider());
+        list.emplace_back(new providers::steam::SteamProvider());
 #endif
 #ifdef WITH_COMPAT_GOG
     if (AppSettings::ext_providers.at(ExtProvider::GOG).enabled)
-        m_providers.emplace_back(new providers::gog::GogProvider());
+        list.emplace_back(new providers::gog::GogProvider());
 #endif
 #ifdef WITH_COMPAT_ES2
     if (AppSettings::ext_providers.at(ExtProvider::ES2).enabled)
-        m_providers.emplace_back(new providers::es2::Es2Provider());
+        list.emplace_back(new providers::es2::Es2Provider());
 #endif
 #ifdef WITH_COMPAT_ANDROIDAPPS
     if (AppSettings::ext_providers.at(ExtProvider::ANDROIDAPPS).enabled)
-        m_providers.emplace_back(new providers::android::AndroidAppsProvider());
+        list.emplace_back(new providers::android::AndroidAppsProvider());
 #endif
 #ifdef WITH_COMPAT_SKRAPER
     if (AppSettings::ext_providers.at(ExtProvider::SKRAPER).enabled)
-        m_providers.emplace_back(new providers::skraper::SkraperAssetsProvider());
+        list.emplace_back(new providers::skraper::SkraperAssetsProvider());
 #endif
+    return list;
+}
+} // namespace
 
-    for (const auto& provider : m_providers) {
-        connect(provider.get(), &providers::Provider::gameCountChanged,
-                this, &ProviderManager::gameCountChanged);
+
+ProviderManager::ProviderManager(QObject* parent)
+    : ProviderManager(create_providers(), parent)
+{}
+
+ProviderManager::ProviderManager(std::vector<ProviderPtr> provider_list, QObject* parent)
+    : QObject(parent)
+    , m_providers(std::move(provider_list))
+    , m_library(nullptr)
+    , m_game_model(nullptr)
+    , m_collection_model(nullptr)
+    , m_ui_ready(false)
+    , m_pending_results_final(false)
+    , m_rescanning(false)
+    , m_rescan_mask(0)
+    , m_rescan_pending_mask(0)
+    , m_game_running(false)
+    , m_favorites_changed(false)
+{
+    // NOTE: the providers search in parallel, each reporting only its own results
+    m_game_counts.resize(m_providers.size(), 0);
+    for (size_t i = 0; i < m_providers.size(); i++) {
+        connect(m_providers[i].get(), &providers::Provider::gameCountChanged,
+                this, [this, i](int count){
+                    m_game_counts[i] = count;
+                    // during a rescan, the count is updated when the results are applied
+                    if (!m_rescanning)
+                        emit gameCountChanged(std::accumulate(m_game_counts.cbegin(), m_game_counts.cend(), 0));
+                });
     }
+
+    connect(this, &ProviderManager::resultsAvailable,
+            this, &ProviderManager::onResultsAvailable, Qt::QueuedConnection);
+    connect(&m_search_watcher, &QFutureWatcher<void>::finished,
+            this, &ProviderManager::onSearchFinished);
+    connect(&m_library_watcher, &providers::LibraryWatcher::changed,
+            this, [this]{
+                qInfo().noquote() << tr_log("Changes detected in the game directories");
+                startRescan(ALL_PROVIDERS);
+            });
 }
 
-void ProviderManager::startSearch(QQmlObjectListModel<model::Game>& game_model,
+ProviderManager::~ProviderManager()
+{
+    if (m_cancel_flag)
+        m_cancel_flag->store(true);
+
+    m_init_seq.waitForFinished();
+}
+
+QStringList ProviderManager::providerNames() const
+{
+    QStringList names;
+    for (const ProviderPtr& ptr : m_providers) {
+        const QString class_name = provider_name(*ptr);
+        names << class_name.mid(class_name.lastIndexOf(QChar(':')) + 1);
+    }
+    return names;
+}
+
+void ProviderManager::startSearch(model::Library& library,
+                                  model::GameList& game_model,
                                   QQmlObjectListModel<model::Collection>& collection_model)
 {
     Q_ASSERT(!m_init_seq.isRunning());
+    Q_ASSERT(!m_library && !m_game_model && !m_collection_model);
+
+    m_library = &library;
+    m_game_model = &game_model;
+    m_collection_model = &collection_model;
+    std::fill(m_game_counts.begin(), m_game_counts.end(), 0);
+    m_search_timer.start();
 
-    m_init_seq = QtConcurrent::run([this, &game_model, &collection_model]{
-        providers::SearchContext ctx;
+    const std::shared_ptr<std::atomic<bool>> cancel_flag = std::make_shared<std::atomic<bool>>(false);
+    m_cancel_flag = cancel_flag;
 
+    const QString sort_locale = AppSettings::general.locale;
+
+    m_init_seq = QtConcurrent::run([this, cancel_flag, sort_locale]{
         QElapsedTimer timer;
         timer.start();
 
+        const QString snapshot_path = providers::snapshot::default_path();
+        const QString snapshot_key = create_snapshot_key(m_providers);
+        std::unique_ptr<providers::SearchContext> ctx(new providers::SearchContext());
+
+        bool snapshot_outdated = false;
+        if (providers::snapshot::load(snapshot_path, snapshot_key, *ctx, &snapshot_outdated, &m_list_cache)) {
+            if (!snapshot_outdated) {
+                emit gameCountChanged(static_cast<int>(ctx->games.size()));
+                emit firstPhaseComplete(timer.restart());
+                emit secondPhaseComplete(0);
+
+                publish_results(std::move(ctx), true, sort_locale);
+                return;
+            }
+
+            // show the previous state of the library until the search finishes
+            publish_results(std::move(ctx), false, sort_locale);
+            ctx.reset(new providers::SearchContext());
+        }
+        ctx->cancel_flag = cancel_flag;
 
-        run_list_providers(ctx, m_providers);
+        m_parse_cache = std::make_shared<providers::ParseCache>();
+        m_parse_cache->load();
+        ctx->parse_cache = m_parse_cache;
+
+        // without a previous state, the games are shown as soon as they are found
+        // NOTE: the providers do not search per collection, so there is no
+        // ordering by the recently used collections; the results are published
+        // after each provider, in the order of the providers
+        modeldata::GameStore published_games;
+        const QCollator collator = collation::create_collator(sort_locale);
+        std::function<void(const providers::SearchContext&)> on_partial_results;
+        if (!snapshot_outdated) {
+            on_partial_results = [this, &published_games, &collator, &sort_locale]
+                                 (const providers::SearchContext& partial){
+                push_results(create_partial_results(partial, published_games, collator, sort_locale), false);
+            };
+        }
+
+        // the providers whose sources did not change reuse their results from the snapshot
+        const bool searched_all = run_list_providers(*ctx, m_providers, find_uncached_providers(m_list_cache),
+                                                     &m_list_cache, on_partial_results);
+        if (ctx->cancelled())
+            return;
         emit firstPhaseComplete(timer.restart());
 
-        run_asset_providers(ctx, m_providers);
+        run_asset_providers(*ctx, m_providers);
+        if (ctx->cancelled())
+            return;
         emit secondPhaseComplete(timer.restart());
 
-        HashMap<QString, model::GameFile*> path_map;
-        build_ui_layer(ctx, parent()->thread(), collection_model, game_model, path_map);
-        emit staticDataReady();
+        qInfo().noquote() << tr_log("String deduplication saved %1 KiB").arg(ctx->string_pool->savedBytes() / 1024);
+
+        // if every provider was searched, the entries not used are outdated
+        if (searched_all)
+            m_parse_cache->dropUnused();
+        m_parse_cache->save();
+
+        if (ctx->sources_trackable) {
+            const QByteArray snapshot = providers::snapshot::serialize(*ctx, snapshot_key, m_list_cache);
+            providers::snapshot::write(snapshot_path, snapshot);
+        }
+
+        publish_results(std::move(ctx), true, sort_locale);
+    });
+    m_search_watcher.setFuture(m_init_seq);
+}
+
+void ProviderManager::startRescan(unsigned provider_mask)
+{
+    m_rescan_pending_mask |= provider_mask;
+    if (!m_rescan_pending_mask)
+        return;
+
+    // the rescan is started after the initial search
+    if (!m_game_model)
+        return;
+
+    if (m_init_seq.isRunning()) {
+        // a running rescan is restarted, including what it was searching for
+        if (m_rescanning) {
+            m_rescan_pending_mask |= m_rescan_mask;
+            m_cancel_flag->store(true);
+        }
+        return;
+    }
+    // NOTE: the currently running game may be removed by the rescan
+    if (m_game_running)
+        return;
+
+    qInfo().noquote() << tr_log("Rescanning the game library...");
+    m_rescan_mask = m_rescan_pending_mask;
+    m_rescan_pending_mask = 0;
+    m_rescanning = true;
+    m_search_timer.start();
+    emit rescanStarted();
 
-        for (const auto& provider : m_providers)
-            provider->findDynamicData(collection_model.asList(), game_model.asList(), path_map);
-        emit thirdPhaseComplete(timer.elapsed());
+    const unsigned mask = m_rescan_mask;
+    const std::shared_ptr<std::atomic<bool>> cancel_flag = std::make_shared<std::atomic<bool>>(false);
+    m_cancel_flag = cancel_flag;
+
+    const QString sort_locale = AppSettings::general.locale;
+
+    m_init_seq = QtConcurrent::run([this, mask, cancel_flag, sort_locale]{
+        std::unique_ptr<providers::SearchContext> ctx(new providers::SearchContext());
+        ctx->cancel_flag = cancel_flag;
+
+        // NOTE: the startup search may have been skipped thanks to the snapshot
+        if (!m_parse_cache) {
+            m_parse_cache = std::make_shared<providers::ParseCache>();
+            m_parse_cache->load();
+        }
+        ctx->parse_cache = m_parse_cache;
+
+        const bool searched_all = run_list_providers(*ctx, m_providers, mask, &m_list_cache, nullptr);
+        if (ctx->cancelled())
+            return;
+
+        run_asset_providers(*ctx, m_providers);
+        if (ctx->cancelled())
+            return;
+
+        qInfo().noquote() << tr_log("String deduplication saved %1 KiB").arg(ctx->string_pool->savedBytes() / 1024);
+
+        // the entries of the providers left out are still valid
+        if (searched_all)
+            m_parse_cache->dropUnused();
+        m_parse_cache->save();
+
+        if (ctx->sources_trackable) {
+            const QByteArray snapshot = providers::snapshot::serialize(*ctx, create_snapshot_key(m_providers), m_list_cache);
+            providers::snapshot::write(providers::snapshot::default_path(), snapshot);
+        }
+
+        publish_results(std::move(ctx), true, sort_locale);
     });
+    m_search_watcher.setFuture(m_init_seq);
+}
+
+void ProviderManager::cancelRescan()
+{
+    m_rescan_pending_mask = 0;
+
+    if (m_rescanning && m_init_seq.isRunning())
+        m_cancel_flag->store(true);
+}
+
+void ProviderManager::publish_results(std::unique_ptr<providers::SearchContext> ctx, bool is_final,
+                                      const QString& sort_locale)
+{
+    // NOTE: the store and the ordering are prepared here, on the search thread,
+    // to keep the work done on the UI thread minimal
+    std::unique_ptr<PublishedResults> results(new PublishedResults());
+    results->games = create_game_store(ctx->games);
+    results->ctx = std::move(ctx);
+    sort_results(*results, sort_locale);
+
+    push_results(std::move(results), is_final);
+}
+
+void ProviderManager::push_results(std::unique_ptr<PublishedResults> results, bool is_final)
+{
+    {
+        QMutexLocker lock(&m_results_guard);
+        m_pending_results = std::move(results);
+        m_pending_results_final |= is_final;
+    }
+    emit resultsAvailable();
 }
 
-void ProviderManager::onGameFavoriteChanged(const QVector<model::Game*>& all_games)
+void ProviderManager::onResultsAvailable()
 {
-    if (m_init_seq.isRunning())
+    // NOTE: the game objects removed by the results would be deleted, including
+    // the running one, so the results are kept waiting until the game finishes
+    if (m_game_running)
         return;
 
+    // NOTE: every published result contains everything found so far,
+    // so if more of them are waiting, only the latest one is used
+    std::unique_ptr<PublishedResults> results;
+    bool is_final = false;
+    {
+        QMutexLocker lock(&m_results_guard);
+        results = std::move(m_pending_results);
+        std::swap(is_final, m_pending_results_final);
+    }
+    if (!results)
+        return;
+
+    // the locale has changed since the results were sorted
+    if (results->sort_locale != AppSettings::general.locale)
+        sort_results(*results, AppSettings::general.locale);
+
+    const std::vector<size_t> old_indices = results->extends_library
+        ? find_extended_games(m_library->store(), results->games)
+        : find_known_games(m_library->store(), *results);
+
+    // the dynamic data is only loaded for the new games, the rest keep their current values
+    modeldata::GameStore& store = results->games;
+    HashMap<QString, size_t> path_map;
+    for (size_t idx = 0; idx < store.size(); idx++) {
+        if (old_indices[idx] != model::Library::NO_GAME)
+            continue;
+
+        const size_t first_file = store.firstFile(idx);
+        for (size_t file_idx = first_file; file_idx < first_file + store.fileCount(idx); file_idx++) {
+            QString path = store.canonicalPath(file_idx);
+            if (Q_LIKELY(!path.isEmpty()))
+                path_map.emplace(std::move(path), file_idx);
+        }
+    }
+    for (const auto& provider : m_providers) {
+        if (provider->flags() & providers::PROVIDES_DYNAMIC_DATA) {
+            const TraceSpan span("findDynamicData", provider_name(*provider));
+            provider->findDynamicData(m_collection_model->asList(), store, path_map);
+        }
+    }
+
+    apply_search_results(*results, old_indices, *m_library, *m_game_model, *m_collection_model);
+
+    if (!m_ui_ready) {
+        m_ui_ready = true;
+        emit staticDataReady();
+    }
+
+    if (is_final) {
+        m_library_watcher.setPaths(std::move(results->ctx->source_paths));
+        emit gameCountChanged(m_game_model->count());
+
+        if (m_rescanning) {
+            qInfo().noquote() << tr_log("Library updated in %1ms").arg(m_search_timer.elapsed());
+            m_rescanning = false;
+            emit rescanFinished();
+        }
+        else {
+            emit thirdPhaseComplete(m_search_timer.elapsed());
+            Trace::write();
+        }
+    }
+}
+
+void ProviderManager::onSearchFinished()
+{
+    // NOTE: the results are applied before the search is reported as finished,
+    // or are waiting for the running game, so if the rescan is still marked
+    // as running without results waiting, it was cancelled
+    bool results_waiting = false;
+    {
+        QMutexLocker lock(&m_results_guard);
+        results_waiting = static_cast<bool>(m_pending_results);
+    }
+    if (m_rescanning && !results_waiting) {
+        qInfo().noquote() << tr_log("Rescan cancelled");
+        m_rescanning = false;
+        emit rescanFinished();
+    }
+
+    if (m_favorites_changed) {
+        m_favorites_changed = false;
+        onGameFavoriteChanged(m_library->store());
+    }
+
+    startRescan(0);
+}
+
+void ProviderManager::onGameFavoriteChanged(const modeldata::GameStore& store)
+{
+    // NOTE: during the initial search the models may be incomplete,
+    // so the change is saved after the search has finished
+    if (m_init_seq.isRunning() && !m_rescanning) {
+        m_favorites_changed = true;
+        return;
+    }
+
     for (const auto& provider : m_providers)
-        provider->onGameFavoriteChanged(all_games);
+        provider->onGameFavoriteChanged(store);
 }
 
-void ProviderManager::onGameLaunched(model::GameFile* const game)
+void ProviderManager::onLocaleChanged()
 {
-    if (m_init_seq.isRunning())
+    // results published later are resorted when they arrive
+    if (!m_library)
         return;
 
+    const TraceSpan span("resort_library", AppSettings::general.locale);
+    const QCollator collator = collation::create_collator(AppSettings::general.locale);
+
+    m_library->updateSortKeys(collator, AppSettings::general.sort_ignore_articles);
+    const std::vector<quint32> ranks = m_library->store().titleRanks();
+
+    m_game_model->sortEntries(ranks);
+    for (model::Collection* const q_coll : m_collection_model->asList())
+        q_coll->games().sortEntries(ranks);
+
+    sort_collection_model(*m_collection_model, collator);
+}
+
+// NOTE: games can only be launched after they were added to the models,
+// so launches are tracked even during the search
+
+void ProviderManager::onGameLaunched(model::GameFile* const game)
+{
+    m_game_running = true;
+
     for (const auto& provider : m_providers)
         provider->onGameLaunched(game);
 }
 
 void ProviderManager::onGameFinished(model::GameFile* const game)
 {
-    if (m_init_seq.isRunning())
-        return;
+    m_game_running = false;
 
     for (const auto& provider : m_providers)
         provider->onGameFinished(game);
+
+    // the results found while the game was running
+    onResultsAvailable();
+    startRescan(0);
 }
@@ -17,15 +17,25 @@
 
 #pragma once
 
+#include "LibraryWatcher.h"
 #include "Provider.h"
 #include "utils/FwdDeclModel.h"
 
+#include <QElapsedTimer>
+#include <QByteArray>
 #include <QObject>
 #include <QFuture>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QStringList>
+#include <atomic>
 #include <memory>
 
 template<typename T> class QQmlObjectListModel;
 using ProviderPtr = std::unique_ptr<providers::Provider>;
+/// The serialized first stage results of each provider
+using ListCache = std::vector<QByteArray>;
+struct PublishedResults;
 
 
 class ProviderManager : public QObject {
@@ -33,13 +43,34 @@ class ProviderManager : public QObject {
 
 public:
     explicit ProviderManager(QObject* parent);
+    /// Uses the provided providers instead of the built-in ones
+    explicit ProviderManager(std::vector<ProviderPtr>, QObject* parent);
+    ~ProviderManager();
+
+    /// Selects every provider in a rescan provider mask
+    static constexpr unsigned ALL_PROVIDERS = ~0u;
 
     size_t providerCount() const { return m_providers.size(); }
+    /// The names of the providers, in the order of their bits in the rescan provider masks
+    QStringList providerNames() const;
 
-    void startSearch(QQmlObjectListModel<model::Game>&, QQmlObjectListModel<model::Collection>&);
+    void startSearch(model::Library&, model::GameList&, QQmlObjectListModel<model::Collection>&);
     void onGameLaunched(model::GameFile* const);
     void onGameFinished(model::GameFile* const);
-    void onGameFavoriteChanged(const QVector<model::Game*>&);
+    void onGameFavoriteChanged(const modeldata::GameStore&);
+    /// Resorts the games and the collections for the current locale
+    void onLocaleChanged();
+
+    /// Searches again for changes in the library, and updates the previously
+    /// filled models. Only the game lists of the providers selected by the mask
+    /// (bit N for the Nth provider) are searched again, the others are reused from
+    /// the previous rescan, if there was one. Metadata and assets are always searched.
+    /// A running rescan gets cancelled and restarted with the new providers included.
+    /// During the initial search, or while a game is being played, the rescan
+    /// is started after it.
+    void startRescan(unsigned provider_mask);
+    /// Stops the currently running rescan, if any, leaving the models unchanged
+    void cancelRescan();
 
 signals:
     void gameCountChanged(int);
@@ -50,7 +81,40 @@ signals:
     void staticDataReady();
     void thirdPhaseComplete(qint64);
 
+    void rescanStarted();
+    void rescanFinished();
+
+    // internal
+    void resultsAvailable();
+
 private:
     std::vector<ProviderPtr> m_providers;
+    std::vector<int> m_game_counts;
     QFuture<void> m_init_seq;
+    QFutureWatcher<void> m_search_watcher;
+    QElapsedTimer m_search_timer;
+
+    model::Library* m_library;
+    model::GameList* m_game_model;
+    QQmlObjectListModel<model::Collection>* m_collection_model;
+    bool m_ui_ready;
+
+    QMutex m_results_guard;
+    std::unique_ptr<PublishedResults> m_pending_results;
+    bool m_pending_results_final;
+
+    providers::LibraryWatcher m_library_watcher;
+    std::shared_ptr<std::atomic<bool>> m_cancel_flag;
+    ListCache m_list_cache;
+    std::shared_ptr<providers::ParseCache> m_parse_cache;
+    bool m_rescanning;
+    unsigned m_rescan_mask;
+    unsigned m_rescan_pending_mask;
+    bool m_game_running;
+    bool m_favorites_changed;
+
+    void publish_results(std::unique_ptr<providers::SearchContext>, bool is_final, const QString& sort_locale);
+    void push_results(std::unique_ptr<PublishedResults>, bool is_final);
+    void onResultsAvailable();
+    void onSearchFinished();
 };
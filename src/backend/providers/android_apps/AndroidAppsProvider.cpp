@@ -29,7 +29,7 @@ namespace providers {
 namespace android {
 
 AndroidAppsProvider::AndroidAppsProvider(QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_LISTS | PROVIDES_STATIC_DATA, { QStringLiteral("Android") }, parent)
 {}
 
 void AndroidAppsProvider::findLists(SearchContext& sctx)
@@ -43,6 +43,9 @@ void AndroidAppsProvider::findLists(SearchContext& sctx)
     static constexpr auto APP_LAUNCH_CPT = "launchComponent";
 
 
+    // NOTE: the app list comes from the system and cannot be tracked
+    sctx.sources_trackable = false;
+
     const QString COLLECTION_TAG(QStringLiteral("Android"));
     if (!sctx.collections.count(COLLECTION_TAG))
         sctx.collections.emplace(COLLECTION_TAG, modeldata::Collection(COLLECTION_TAG));
@@ -20,16 +20,23 @@
 #include "LocaleUtils.h"
 #include "Paths.h"
 #include "PegasusAssets.h"
+#include "Trace.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "modeldata/gaming/GameData.h"
+#include "providers/DataStream.h"
+#include "utils/DirListingCache.h"
+#include "utils/MoveOnly.h"
 #include "utils/PathCheck.h"
+#include "utils/StringPool.h"
 
+#include <QDataStream>
 #include <QDebug>
-#include <QDir>
-#include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QStringBuilder>
 #include <QUrl>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 
 
 namespace pegasus_legacy_assets {
@@ -71,7 +78,8 @@ namespace {
 static constexpr auto MSG_PREFIX = "ES2:";
 
 QString findGamelistFile(const modeldata::Collection& collection,
-                         const QString& collection_dir)
+                         const QString& collection_dir,
+                         std::vector<QString>& source_paths)
 {
     // static const QString FALLBACK_MSG = "`%1` not found, trying next fallback";
 
@@ -90,7 +98,10 @@ QString findGamelistFile(const modeldata::Collection& collection,
             % GAMELISTFILE);
     }
 
+    // a higher priority file may be created later
     for (const auto& path : possible_files) {
+        source_paths.emplace_back(path);
+
         if (::validFile(path)) {
             qInfo().noquote() << MSG_PREFIX << tr_log("found `%1`").arg(path);
             return path;
@@ -108,73 +119,183 @@ void resolveShellChars(QString& path, const QString& containing_dir)
         path.replace(0, 1, paths::homePath());
 }
 
-void convertToCanonicalPath(QString& path, const QString& containing_dir)
+void convertToCanonicalPath(QString& path, const QString& containing_dir, PathCache& path_cache)
 {
     resolveShellChars(path, containing_dir);
-    path = QFileInfo(path).canonicalFilePath();
+    path = path_cache.canonicalFilePath(QFileInfo(path));
 }
 
-void findPegasusAssetsInScrapedir(const QDir& scrapedir,
+void findPegasusAssetsInScrapedir(const QString& scrapedir_path,
+                                  const QString& scrapedir_name,
+                                  DirListingCache& dir_cache,
                                   const HashMap<QString, modeldata::Game* const>& games_by_shortpath)
 {
     // FIXME: except the short path, this function is the same as the Pegasus asset code
-    if (!scrapedir.exists())
-        return;
+    const std::shared_ptr<const DirListing> listing = dir_cache.list(scrapedir_path);
+    for (const DirEntry& entry : *listing) {
+        if (entry.is_dir)
+            continue;
 
-    QDirIterator dir_it(scrapedir, QDirIterator::FollowSymlinks);
-    while (dir_it.hasNext()) {
-        dir_it.next();
-        const QFileInfo fileinfo = dir_it.fileInfo();
-        const auto detection_result = pegasus_legacy_assets::checkFile(fileinfo);
+        const QString file_path = scrapedir_path % QLatin1Char('/') % entry.name;
+        const auto detection_result = pegasus_legacy_assets::checkFile(QFileInfo(file_path));
         if (!detection_result.isValid())
             continue;
 
-        const QString shortpath = scrapedir.dirName() % '/' % detection_result.basename;
+        const QString shortpath = scrapedir_name % '/' % detection_result.basename;
         if (!games_by_shortpath.count(shortpath))
             continue;
 
         modeldata::Game* const game = games_by_shortpath.at(shortpath);
-        game->assets.addFileMaybe(detection_result.asset_type, dir_it.filePath());
+        game->assets.addFileMaybe(detection_result.asset_type, file_path);
     }
 }
 
+/// A gamelist file and the entries read from it
+struct GamelistTask {
+    const modeldata::Collection* collection;
+    QString collection_dir;
+    QString gamelist_path;
+    std::vector<providers::es2::GameEntry> entries;
+
+    explicit GamelistTask(const modeldata::Collection* collection, QString collection_dir, QString gamelist_path)
+        : collection(collection)
+        , collection_dir(std::move(collection_dir))
+        , gamelist_path(std::move(gamelist_path))
+    {}
+    MOVE_ONLY(GamelistTask)
+};
+
 } // namespace
 
 
 namespace providers {
 namespace es2 {
 
-enum class MetaTypes : unsigned char {
-    PATH,
-    NAME,
-    DESC,
-    DEVELOPER,
-    GENRE,
-    PUBLISHER,
-    PLAYERS,
-    RATING,
-    PLAYCOUNT,
-    LASTPLAYED,
-    RELEASE,
-    IMAGE,
-    VIDEO,
-    MARQUEE,
-    FAVORITE,
-};
-
-HashMap<QString, MetaTypes>::const_iterator find_by_strref(const HashMap<QString, MetaTypes>& map,
-                                                           const QStringRef& str)
+/// Finds the type of a `<game>` child element. A candidate is picked by the
+/// length and the first character of the name, then compared in full.
+bool find_meta_type(const QStringRef& name, MetaTypes& type)
 {
-    HashMap<QString, MetaTypes>::const_iterator it;
-    for (it = map.cbegin(); it != map.cend(); ++it)
-        if (it->first == str)
+    // NOTE: in the order of MetaTypes
+    static const QLatin1String KEYS[] {
+        QLatin1String("path"),
+        QLatin1String("name"),
+        QLatin1String("desc"),
+        QLatin1String("developer"),
+        QLatin1String("genre"),
+        QLatin1String("publisher"),
+        QLatin1String("players"),
+        QLatin1String("rating"),
+        QLatin1String("playcount"),
+        QLatin1String("lastplayed"),
+        QLatin1String("releasedate"),
+        QLatin1String("image"),
+        QLatin1String("video"),
+        QLatin1String("marquee"),
+        QLatin1String("favorite"),
+    };
+    static_assert(sizeof(KEYS) / sizeof(KEYS[0]) == std::tuple_size<decltype(GameEntry::fields)>::value,
+                  "all field types should have a key");
+
+    if (name.isEmpty())
+        return false;
+
+    const ushort first = name.at(0).unicode();
+    switch (name.size()) {
+        case 4:
+            if (first == 'p') type = MetaTypes::PATH;
+            else if (first == 'n') type = MetaTypes::NAME;
+            else if (first == 'd') type = MetaTypes::DESC;
+            else return false;
+            break;
+        case 5:
+            if (first == 'g') type = MetaTypes::GENRE;
+            else if (first == 'i') type = MetaTypes::IMAGE;
+            else if (first == 'v') type = MetaTypes::VIDEO;
+            else return false;
+            break;
+        case 6:
+            type = MetaTypes::RATING;
+            break;
+        case 7:
+            if (first == 'p') type = MetaTypes::PLAYERS;
+            else if (first == 'm') type = MetaTypes::MARQUEE;
+            else return false;
+            break;
+        case 8:
+            type = MetaTypes::FAVORITE;
+            break;
+        case 9:
+            if (first == 'd') type = MetaTypes::DEVELOPER;
+            else if (first == 'p' && name.at(1).unicode() == 'u') type = MetaTypes::PUBLISHER;
+            else if (first == 'p') type = MetaTypes::PLAYCOUNT;
+            else return false;
+            break;
+        case 10:
+            type = MetaTypes::LASTPLAYED;
+            break;
+        case 11:
+            type = MetaTypes::RELEASE;
             break;
+        default:
+            return false;
+    }
+
+    return name == KEYS[static_cast<size_t>(type)];
+}
+
+QByteArray serializeEntries(const std::vector<GameEntry>& entries)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(datastream::STREAM_VERSION);
+
+    // NOTE: only the fields with a value are stored
+    stream << static_cast<quint32>(entries.size());
+    for (const GameEntry& entry : entries) {
+        const auto field_count = std::count_if(entry.fields.cbegin(), entry.fields.cend(),
+            [](const QString& field){ return !field.isEmpty(); });
+        stream << static_cast<quint32>(field_count);
+
+        for (size_t i = 0; i < entry.fields.size(); i++) {
+            if (!entry.fields[i].isEmpty())
+                stream << static_cast<quint8>(i) << entry.fields[i];
+        }
+    }
+
+    return bytes;
+}
+
+bool deserializeEntries(const QByteArray& bytes, std::vector<GameEntry>& entries)
+{
+    QDataStream stream(bytes);
+    stream.setVersion(datastream::STREAM_VERSION);
+
+    const quint32 entry_count = datastream::read_count(stream);
+    entries.reserve(entry_count);
+    for (quint32 i = 0; i < entry_count && datastream::stream_ok(stream); i++) {
+        GameEntry entry;
+
+        const quint32 field_count = datastream::read_count(stream);
+        for (quint32 j = 0; j < field_count && datastream::stream_ok(stream); j++) {
+            quint8 raw_type = 0;
+            QString value;
+            stream >> raw_type >> value;
+            if (entry.fields.size() <= raw_type) {
+                stream.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+
+            entry.fields[raw_type] = std::move(value);
+        }
+
+        entries.emplace_back(std::move(entry));
+    }
 
-    return it;
+    return datastream::stream_ok(stream);
 }
 
 void findAssets(modeldata::Game& game,
-                HashMap<MetaTypes, QString, EnumHash>& xml_props,
+                GameEntry& xml_props,
                 const QString& collection_dir)
 {
     const QString rom_dir = collection_dir % '/';
@@ -191,7 +312,7 @@ void findAssets(modeldata::Game& game,
         if (!path.isEmpty() && ::validExtPath(path))
             game.assets.addFileMaybe(AssetType::ARCADE_MARQUEE, path);
     }
-    if (xml_props.count(MetaTypes::VIDEO)) {
+    if (!xml_props[MetaTypes::VIDEO].isEmpty()) {
         QString& path = xml_props[MetaTypes::VIDEO];
         resolveShellChars(path, rom_dir);
         if (!path.isEmpty() && ::validExtPath(path))
@@ -201,23 +322,6 @@ void findAssets(modeldata::Game& game,
 
 MetadataParser::MetadataParser(QObject* parent)
     : QObject(parent)
-    , m_key_types {
-        { QStringLiteral("path"), MetaTypes::PATH },
-        { QStringLiteral("name"), MetaTypes::NAME },
-        { QStringLiteral("desc"), MetaTypes::DESC },
-        { QStringLiteral("developer"), MetaTypes::DEVELOPER },
-        { QStringLiteral("genre"), MetaTypes::GENRE },
-        { QStringLiteral("publisher"), MetaTypes::PUBLISHER },
-        { QStringLiteral("players"), MetaTypes::PLAYERS },
-        { QStringLiteral("rating"), MetaTypes::RATING },
-        { QStringLiteral("playcount"), MetaTypes::PLAYCOUNT },
-        { QStringLiteral("lastplayed"), MetaTypes::LASTPLAYED },
-        { QStringLiteral("releasedate"), MetaTypes::RELEASE },
-        { QStringLiteral("image"), MetaTypes::IMAGE },
-        { QStringLiteral("video"), MetaTypes::VIDEO },
-        { QStringLiteral("marquee"), MetaTypes::MARQUEE },
-        { QStringLiteral("favorite"), MetaTypes::FAVORITE },
-    }
     , m_date_format(QStringLiteral("yyyyMMdd'T'HHmmss"))
     , m_players_regex(QStringLiteral("(\\d+)(-(\\d+))?"))
 {}
@@ -227,6 +331,8 @@ void MetadataParser::enhance(providers::SearchContext& sctx,
 {
     const QString imgdir_base = paths::homePath()
                               % QStringLiteral("/.emulationstation/downloaded_images/");
+    const QString cache_tag = QStringLiteral("es2");
+
     // shortpath: dir name + extensionless filename
     HashMap<QString, modeldata::Game* const> games_by_shortpath;
     games_by_shortpath.reserve(sctx.games.size());
@@ -245,7 +351,12 @@ void MetadataParser::enhance(providers::SearchContext& sctx,
     }
 
 
+    // find the metadata files
+    std::vector<GamelistTask> tasks;
     for (const auto& pair : sctx.collections) {
+        if (sctx.cancelled())
+            return;
+
         const modeldata::Collection& collection = pair.second;
 
         // ignore Steam
@@ -256,38 +367,80 @@ void MetadataParser::enhance(providers::SearchContext& sctx,
         if (!collection_dirs.count(collection.name))
             continue;
 
-        // find the metadata file
-        const QString collection_dir = collection_dirs.at(collection.name);
-        const QString gamelist_path = findGamelistFile(collection, collection_dir);
+        const QString& collection_dir = collection_dirs.at(collection.name);
+        QString gamelist_path = findGamelistFile(collection, collection_dir, sctx.source_paths);
         if (gamelist_path.isEmpty())
             continue;
 
-        // open the file
-        QFile xml_file(gamelist_path);
-        if (!xml_file.open(QIODevice::ReadOnly)) {
-            qWarning().noquote() << MSG_PREFIX
-                                 << tr_log("could not open `%1`").arg(gamelist_path);
-            continue;
-        }
+        tasks.emplace_back(&collection, collection_dir, std::move(gamelist_path));
+    }
+
+    // NOTE: the files are read in parallel, but as games can be shared between
+    // collections, the entries are applied one collection at a time, in order
+    QtConcurrent::blockingMap(tasks, [this, &sctx, &cache_tag](GamelistTask& task){
+        if (sctx.cancelled())
+            return;
+
+        // read the entries of the file, or take them from the cache if it didn't change
+        ParseCache::FileStamp stamp;
+        const QByteArray cached = sctx.parse_cache
+            ? sctx.parse_cache->find(cache_tag, task.gamelist_path, stamp)
+            : QByteArray();
+        if (!cached.isEmpty() && deserializeEntries(cached, task.entries))
+            return;
+
+        task.entries.clear();
+        const bool success = readGamelist(task.gamelist_path, sctx, task.entries);
+
+        // NOTE: files with errors are not cached, so the warnings are printed every time
+        if (success && !sctx.cancelled() && sctx.parse_cache)
+            sctx.parse_cache->insert(cache_tag, task.gamelist_path, stamp, serializeEntries(task.entries));
+    });
+    if (sctx.cancelled())
+        return;
 
-        // parse the file
-        QXmlStreamReader xml(&xml_file);
-        parseGamelistFile(xml, sctx, collection_dir);
-        if (xml.error())
-            qWarning().noquote() << MSG_PREFIX << xml.errorString();
+    for (GamelistTask& task : tasks) {
+        for (GameEntry& entry : task.entries)
+            applyGameEntry(entry, sctx, task.collection_dir);
 
         // search for assets in `downloaded_images`
-        if (!collection.shortName().isEmpty()) {
-            constexpr auto dir_filters = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-            const QDir imgdir(imgdir_base % collection.shortName(), QString(), QDir::NoSort, dir_filters);
-            findPegasusAssetsInScrapedir(imgdir, games_by_shortpath);
+        const QString& shortname = task.collection->shortName();
+        if (!shortname.isEmpty()) {
+            const QString imgdir_path = imgdir_base % shortname;
+            sctx.source_paths.emplace_back(imgdir_path);
+            findPegasusAssetsInScrapedir(imgdir_path, shortname, *sctx.dir_cache, games_by_shortpath);
         }
     }
 }
 
+bool MetadataParser::readGamelist(const QString& gamelist_path,
+                                  const providers::SearchContext& sctx,
+                                  std::vector<GameEntry>& entries) const
+{
+    const TraceSpan span("es2::read_gamelist", gamelist_path);
+
+    // open the file
+    QFile xml_file(gamelist_path);
+    if (!xml_file.open(QIODevice::ReadOnly)) {
+        qWarning().noquote() << MSG_PREFIX
+                             << tr_log("could not open `%1`").arg(gamelist_path);
+        return false;
+    }
+
+    // parse the file
+    QXmlStreamReader xml(&xml_file);
+    parseGamelistFile(xml, sctx, entries);
+    if (xml.error()) {
+        qWarning().noquote() << MSG_PREFIX << xml.errorString();
+        return false;
+    }
+
+    return true;
+}
+
 void MetadataParser::parseGamelistFile(QXmlStreamReader& xml,
-                                       providers::SearchContext& sctx,
-                                       const QString& collection_dir) const
+                                       const providers::SearchContext& sctx,
+                                       std::vector<GameEntry>& entries) const
 {
     // find the root <gameList> element
     if (!xml.readNextStartElement()) {
@@ -302,32 +455,31 @@ void MetadataParser::parseGamelistFile(QXmlStreamReader& xml,
     }
 
     // read all <game> nodes
-    while (xml.readNextStartElement()) {
+    while (xml.readNextStartElement() && !sctx.cancelled()) {
         if (xml.name() != QLatin1String("game")) {
             xml.skipCurrentElement();
             continue;
         }
 
-        parseGameEntry(xml, sctx, collection_dir);
+        parseGameEntry(xml, entries);
     }
 }
 
 void MetadataParser::parseGameEntry(QXmlStreamReader& xml,
-                                    providers::SearchContext& sctx,
-                                    const QString& collection_dir) const
+                                    std::vector<GameEntry>& entries) const
 {
     Q_ASSERT(xml.isStartElement() && xml.name() == "game");
 
-    // read all XML fields into a key-value map
-    HashMap<MetaTypes, QString, EnumHash> xml_props;
+    // read all XML fields
+    GameEntry xml_props;
     while (xml.readNextStartElement()) {
-        const auto map_iter = find_by_strref(m_key_types, xml.name());
-        if (map_iter == m_key_types.cend()) {
+        MetaTypes type;
+        if (!find_meta_type(xml.name(), type)) {
             xml.skipCurrentElement();
             continue;
         }
 
-        xml_props[map_iter->second] = xml.readElementText();
+        xml_props[type] = xml.readElementText();
     }
     if (xml.error()) {
         qWarning().noquote() << MSG_PREFIX << xml.errorString();
@@ -335,8 +487,7 @@ void MetadataParser::parseGameEntry(QXmlStreamReader& xml,
     }
 
     // check if all required params are present
-    QString& game_path = xml_props[MetaTypes::PATH];
-    if (game_path.isEmpty()) {
+    if (xml_props[MetaTypes::PATH].isEmpty()) {
         qWarning().noquote()
             << MSG_PREFIX
             << tr_log("the `<game>` node in `%1` that ends at line %2 has no `<path>` parameter")
@@ -345,9 +496,15 @@ void MetadataParser::parseGameEntry(QXmlStreamReader& xml,
         return;
     }
 
-    // apply
+    entries.emplace_back(std::move(xml_props));
+}
 
-    convertToCanonicalPath(game_path, collection_dir);
+void MetadataParser::applyGameEntry(GameEntry& xml_props,
+                                    providers::SearchContext& sctx,
+                                    const QString& collection_dir) const
+{
+    QString& game_path = xml_props[MetaTypes::PATH];
+    convertToCanonicalPath(game_path, collection_dir, *sctx.path_cache);
     if (!sctx.path_to_gameidx.count(game_path))
         return;
 
@@ -355,10 +512,15 @@ void MetadataParser::parseGameEntry(QXmlStreamReader& xml,
     modeldata::Game& game = sctx.games.at(game_idx);
     applyMetadata(game, xml_props);
     findAssets(game, xml_props, collection_dir);
+
+    StringPool& pool = *sctx.string_pool;
+    pool.intern(game.developers);
+    pool.intern(game.publishers);
+    pool.intern(game.genres);
 }
 
 void MetadataParser::applyMetadata(modeldata::Game& game,
-                                   HashMap<MetaTypes, QString, EnumHash>& xml_props) const
+                                   GameEntry& xml_props) const
 {
     // first, the simple strings
     game.title = xml_props[MetaTypes::NAME];
@@ -24,12 +24,38 @@
 #include <QObject>
 #include <QRegularExpression>
 #include <QXmlStreamReader>
+#include <array>
+#include <vector>
 
 
 namespace providers {
 namespace es2 {
 
-enum class MetaTypes : unsigned char;
+enum class MetaTypes : unsigned char {
+    PATH,
+    NAME,
+    DESC,
+    DEVELOPER,
+    GENRE,
+    PUBLISHER,
+    PLAYERS,
+    RATING,
+    PLAYCOUNT,
+    LASTPLAYED,
+    RELEASE,
+    IMAGE,
+    VIDEO,
+    MARQUEE,
+    FAVORITE,
+};
+
+/// The fields of a `<game>` node, indexed by their type; missing fields are empty
+struct GameEntry {
+    std::array<QString, static_cast<size_t>(MetaTypes::FAVORITE) + 1> fields;
+
+    QString& operator[](MetaTypes type) { return fields[static_cast<size_t>(type)]; }
+    const QString& operator[](MetaTypes type) const { return fields[static_cast<size_t>(type)]; }
+};
 
 class MetadataParser : public QObject {
     Q_OBJECT
@@ -39,19 +65,26 @@ public:
     void enhance(providers::SearchContext& sctx,
                  const HashMap<QString, QString>& collection_dirs);
 
+    /// Reads the `<game>` entries of a gamelist file.
+    /// Returns false if the file could not be read without errors.
+    bool readGamelist(const QString&,
+                      const providers::SearchContext&,
+                      std::vector<GameEntry>&) const;
+
 private:
-    const HashMap<QString, MetaTypes> m_key_types;
     const QString m_date_format;
     const QRegularExpression m_players_regex;
 
     void parseGamelistFile(QXmlStreamReader&,
-                           providers::SearchContext&,
-                           const QString&) const;
+                           const providers::SearchContext&,
+                           std::vector<GameEntry>&) const;
     void parseGameEntry(QXmlStreamReader&,
+                        std::vector<GameEntry>&) const;
+    void applyGameEntry(GameEntry&,
                         providers::SearchContext&,
                         const QString&) const;
     void applyMetadata(modeldata::Game&,
-                       HashMap<MetaTypes, QString, EnumHash>&) const;
+                       GameEntry&) const;
 };
 
 } // namespace es2
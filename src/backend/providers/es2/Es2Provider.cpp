@@ -23,7 +23,7 @@ namespace es2 {
 
 
 Es2Provider::Es2Provider(QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_LISTS | PROVIDES_STATIC_DATA, parent)
     , systems(this)
     , metadata(this)
 {
@@ -33,6 +33,7 @@ Es2Provider::Es2Provider(QObject* parent)
 
 void Es2Provider::findLists(SearchContext& sctx)
 {
+    m_collection_dirs.clear();
     systems.find(sctx, m_collection_dirs);
 }
 
@@ -19,20 +19,31 @@
 
 #include "LocaleUtils.h"
 #include "Paths.h"
+#include "Trace.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "modeldata/gaming/GameData.h"
+#include "utils/DirListingCache.h"
+#include "utils/MoveOnly.h"
 #include "utils/PathCheck.h"
 
 #include <QDebug>
-#include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QStringBuilder>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 
 
 namespace {
 static constexpr auto MSG_PREFIX = "ES2:"; // TODO: don't duplicate
+static constexpr qint64 PROGRESS_INTERVAL_MS = 250;
 
-QString findSystemsFile()
+/// Returns the first existing systems file. The paths checked are added to the
+/// sources, so if a missing one with higher priority gets created, it is noticed.
+QString findSystemsFile(std::vector<QString>& source_paths)
 {
     // static const QString FALLBACK_MSG = "`%1` not found, trying next fallback";
 
@@ -42,6 +53,7 @@ QString findSystemsFile()
     };
 
     for (const auto& path : possible_paths) {
+        source_paths.emplace_back(path);
         if (::validFile(path)) {
             qInfo().noquote() << MSG_PREFIX << tr_log("found `%1`").arg(path);
             return path;
@@ -51,25 +63,65 @@ QString findSystemsFile()
     return QString();
 }
 
-HashMap<QLatin1String, QString>::iterator
-findByStrRef(HashMap<QLatin1String, QString>& map, const QStringRef& str)
+/// A system and the results of scanning its directory
+struct SystemTask {
+    providers::es2::SystemEntry system;
+    std::vector<QString> dirs;
+    std::vector<QFileInfo> files;
+    std::vector<QString> canonical_paths;
+
+    explicit SystemTask(providers::es2::SystemEntry system) : system(std::move(system)) {}
+    MOVE_ONLY(SystemTask)
+};
+
+void scan_system(SystemTask& task, providers::SearchContext& sctx,
+                 const std::function<void(size_t)>& on_files_found)
 {
-    HashMap<QLatin1String, QString>::iterator it;
-    for (it = map.begin(); it != map.end(); ++it)
-        if (it->first == str)
-            break;
+    const QString& system_dir = task.system.path;
+    const TraceSpan span("es2::scan_system", system_dir);
+
+    // all (sub-)directories, but ignore 'media'
+    task.dirs = sctx.dir_cache->findDirs(system_dir);
+    const auto media_it = std::find(task.dirs.begin(), task.dirs.end(), system_dir + QStringLiteral("/media"));
+    if (media_it != task.dirs.end())
+        task.dirs.erase(media_it);
+
+    // NOTE: directories can also be games
+    const providers::es2::ExtensionSet extensions(task.system.extensions);
+    for (const QString& dir_path : task.dirs) {
+        if (sctx.cancelled())
+            return;
+
+        const size_t prev_file_count = task.files.size();
+
+        const std::shared_ptr<const DirListing> listing = sctx.dir_cache->list(dir_path);
+        for (const DirEntry& entry : *listing) {
+            if (!extensions.matches(entry.name))
+                continue;
 
-    return it;
+            task.canonical_paths.emplace_back(sctx.path_cache->canonicalFilePath(dir_path, entry));
+            task.files.emplace_back(dir_path % QLatin1Char('/') % entry.name);
+        }
+
+        if (prev_file_count != task.files.size())
+            on_files_found(task.files.size() - prev_file_count);
+    }
 }
 
-/// returns a list of unique, '*.'-prefixed lowercase file extensions
-QStringList parseFilters(const QString& filters_raw) {
-    QStringList filter_list = filters_raw.split(" ", QString::SkipEmptyParts);
-    for (auto& filter : filter_list)
-        filter = filter.prepend("*").toLower();
+void add_system(const providers::es2::SystemEntry& system,
+                providers::SearchContext& sctx,
+                HashMap<QString, QString>& collection_dirs)
+{
+    // construct the new platform
+    // TODO: only create if it has games
+
+    if (!sctx.collections.count(system.collection_name))
+        sctx.collections.emplace(system.collection_name, modeldata::Collection(system.collection_name));
 
-    filter_list.removeDuplicates();
-    return filter_list;
+    modeldata::Collection& collection = sctx.collections.at(system.collection_name);
+    collection.setShortName(system.shortname);
+    collection.launch_cmd = system.launch_cmd;
+    collection_dirs[system.collection_name] = system.path;
 }
 
 } // namespace
@@ -78,6 +130,37 @@ QStringList parseFilters(const QString& filters_raw) {
 namespace providers {
 namespace es2 {
 
+ExtensionSet::ExtensionSet(const QString& extensions_raw)
+{
+    for (const QStringRef& ext : extensions_raw.splitRef(QLatin1Char(' '), QString::SkipEmptyParts)) {
+        QString suffix = ext.toString().toLower();
+        // some configs list the extensions without the dot
+        if (!suffix.startsWith(QLatin1Char('.')))
+            suffix.prepend(QLatin1Char('.'));
+
+        m_exts.emplace(std::move(suffix), true);
+    }
+}
+
+bool ExtensionSet::matches(const QString& file_name) const
+{
+    for (int dot_idx = file_name.indexOf(QLatin1Char('.')); dot_idx >= 0;
+         dot_idx = file_name.indexOf(QLatin1Char('.'), dot_idx + 1))
+    {
+        const QStringRef suffix = file_name.midRef(dot_idx);
+        const bool has_upper = std::any_of(suffix.cbegin(), suffix.cend(),
+            [](const QChar& c){ return c.isUpper(); });
+
+        const bool found = has_upper
+            ? m_exts.count(suffix.toString().toLower())
+            : m_exts.count(suffix);
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+
 SystemsParser::SystemsParser(QObject* parent)
     : QObject(parent)
 {}
@@ -86,7 +169,7 @@ void SystemsParser::find(providers::SearchContext& sctx,
                          HashMap<QString, QString>& collection_dirs)
 {
     // find the systems file
-    const QString xml_path = findSystemsFile();
+    const QString xml_path = findSystemsFile(sctx.source_paths);
     if (xml_path.isEmpty()) {
         qWarning().noquote() << MSG_PREFIX << tr_log("system config file not found");
         return;
@@ -100,15 +183,78 @@ void SystemsParser::find(providers::SearchContext& sctx,
     }
 
     // parse the systems file
-    QXmlStreamReader xml(&xml_file);
-    readSystemsFile(xml, sctx, collection_dirs);
-    if (xml.error())
-        qWarning().noquote() << MSG_PREFIX << xml.errorString();
+    // NOTE: in case of an error, the systems read before it are still used
+    std::vector<SystemTask> tasks;
+    {
+        std::vector<SystemEntry> systems;
+        QXmlStreamReader xml(&xml_file);
+        readSystemsFile(xml, sctx, systems);
+        if (xml.error())
+            qWarning().noquote() << MSG_PREFIX << xml.errorString();
+
+        tasks.reserve(systems.size());
+        for (SystemEntry& system : systems)
+            tasks.emplace_back(std::move(system));
+    }
+
+    // look for the games of the systems in parallel
+    // NOTE: The progress is reported by the workers, at most a few times per second.
+    // Files shared between systems are only merged later, so until the end, the
+    // reported count can be somewhat higher than the number of games.
+    std::atomic<int> found_count(static_cast<int>(sctx.games.size()));
+    std::atomic<qint64> last_report_ms(0);
+    QElapsedTimer progress_timer;
+    progress_timer.start();
+
+    const std::function<void(size_t)> on_files_found =
+        [this, &found_count, &last_report_ms, &progress_timer](size_t count){
+            const int total = found_count += static_cast<int>(count);
+
+            const qint64 now_ms = progress_timer.elapsed();
+            qint64 prev_ms = last_report_ms.load();
+            if (now_ms - prev_ms < PROGRESS_INTERVAL_MS)
+                return;
+            if (last_report_ms.compare_exchange_strong(prev_ms, now_ms))
+                emit gameCountChanged(total);
+        };
+    QtConcurrent::blockingMap(tasks, [&sctx, &on_files_found](SystemTask& task){
+        if (!sctx.cancelled())
+            scan_system(task, sctx, on_files_found);
+    });
+
+    // NOTE: as games can be shared between systems, they are added in order, on this thread
+    for (SystemTask& task : tasks) {
+        if (sctx.cancelled())
+            return;
+
+        add_system(task.system, sctx, collection_dirs);
+        std::vector<size_t>& childs = sctx.collection_childs[task.system.collection_name];
+        const modeldata::Collection& collection = sctx.collections.at(task.system.collection_name);
+
+        for (QString& dir_path : task.dirs)
+            sctx.source_paths.emplace_back(std::move(dir_path));
+
+        for (size_t i = 0; i < task.files.size(); i++) {
+            const QString& game_path = task.canonical_paths[i];
+            if (!sctx.path_to_gameidx.count(game_path)) {
+                modeldata::Game game(std::move(task.files[i]));
+                game.files.front().canonical_path = game_path;
+                game.launch_cmd = collection.launch_cmd;
+                sctx.path_to_gameidx.emplace(game_path, sctx.games.size());
+                sctx.games.emplace_back(std::move(game));
+            }
+
+            const size_t game_idx = sctx.path_to_gameidx.at(game_path);
+            childs.emplace_back(game_idx);
+        }
+    }
+
+    emit gameCountChanged(static_cast<int>(sctx.games.size()));
 }
 
 void SystemsParser::readSystemsFile(QXmlStreamReader& xml,
-                                    providers::SearchContext& sctx,
-                                    HashMap<QString, QString>& collection_dirs)
+                                    const providers::SearchContext& sctx,
+                                    std::vector<SystemEntry>& systems)
 {
     // read the root <systemList> element
     if (!xml.readNextStartElement()) {
@@ -123,24 +269,18 @@ void SystemsParser::readSystemsFile(QXmlStreamReader& xml,
     }
 
     // read all <system> nodes
-    size_t game_count = sctx.games.size();
-    while (xml.readNextStartElement()) {
+    while (xml.readNextStartElement() && !sctx.cancelled()) {
         if (xml.name() != QLatin1String("system")) {
             xml.skipCurrentElement();
             continue;
         }
 
-        readSystemEntry(xml, sctx, collection_dirs);
-        if (game_count != sctx.games.size()) {
-            game_count = sctx.games.size();
-            emit gameCountChanged(static_cast<int>(game_count));
-        }
+        readSystemEntry(xml, systems);
     }
 }
 
 void SystemsParser::readSystemEntry(QXmlStreamReader& xml,
-                                    providers::SearchContext& sctx,
-                                    HashMap<QString, QString>& collection_dirs)
+                                    std::vector<SystemEntry>& systems)
 {
     Q_ASSERT(xml.isStartElement() && xml.name() == "system");
 
@@ -163,7 +303,8 @@ void SystemsParser::readSystemEntry(QXmlStreamReader& xml,
     };
     // read
     while (xml.readNextStartElement()) {
-        auto it = findByStrRef(xml_props, xml.name());
+        // NOTE: looked up directly by the element name, without creating a QString
+        auto it = xml_props.find(xml.name());
         if (it != xml_props.end())
             it->second = xml.readElementText();
         else
@@ -192,71 +333,20 @@ void SystemsParser::readSystemEntry(QXmlStreamReader& xml,
         .replace("\\", "/")
         .replace("~", paths::homePath());
 
-
-    // construct the new platform
-    // TODO: only create if it has games
-
     const QString& fullname = xml_props[QLatin1String("fullname")];
     const QString& shortname = xml_props[QLatin1String("name")];
-    const QString& collection_name = fullname.isEmpty() ? shortname : fullname;
-
-    if (!sctx.collections.count(collection_name))
-        sctx.collections.emplace(collection_name, modeldata::Collection(collection_name));
-
-    modeldata::Collection& collection = sctx.collections.at(collection_name);
-    std::vector<size_t>& childs = sctx.collection_childs[collection_name];
 
-    collection.setShortName(shortname);
-    collection_dirs[collection_name] = xml_props[QLatin1String("path")];
-
-    const QString launch_cmd = xml_props[QLatin1String("command")]
+    SystemEntry system;
+    system.collection_name = fullname.isEmpty() ? shortname : fullname;
+    system.shortname = shortname;
+    system.path = std::move(xml_props[QLatin1String("path")]);
+    system.extensions = std::move(xml_props[QLatin1String("extension")]);
+    system.launch_cmd = xml_props[QLatin1String("command")]
         .replace(QLatin1String("\"%ROM%\""), QLatin1String("\"{file.path}\"")) // make sure we don't double quote
         .replace(QLatin1String("%ROM%"), QLatin1String("\"{file.path}\""))
         .replace(QLatin1String("%ROM_RAW%"), QLatin1String("{file.path}"))
         .replace(QLatin1String("%BASENAME%"), QLatin1String("{file.basename}"));
-    collection.launch_cmd = launch_cmd;
-
-    // add the games
-
-    // pass 1: find all (sub-)directories, but ignore 'media'
-
-    QStringList dirs;
-    {
-        static constexpr auto subdir_filters = QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
-        static constexpr auto subdir_flags = QDirIterator::FollowSymlinks | QDirIterator::Subdirectories;
-
-        QDirIterator dirs_it(xml_props[QLatin1String("path")], subdir_filters, subdir_flags);
-        while (dirs_it.hasNext()) {
-            dirs << dirs_it.next();
-        }
-        dirs.removeOne(xml_props[QLatin1String("path")] + QStringLiteral("/media"));
-        dirs.append(xml_props[QLatin1String("path")]);
-    }
-
-    // pass 2: scan for game files
-
-    static constexpr auto entry_filters = QDir::Files | QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
-    static constexpr auto entry_flags = QDirIterator::FollowSymlinks;
-    const QStringList name_filters = parseFilters(xml_props[QLatin1String("extension")]);
-
-    for (const QString& dir_path : qAsConst(dirs)) {
-        QDirIterator files_it(dir_path, name_filters, entry_filters, entry_flags);
-        while (files_it.hasNext()) {
-            files_it.next();
-            QFileInfo fileinfo = files_it.fileInfo();
-            const QString game_path = fileinfo.canonicalFilePath();
-
-            if (!sctx.path_to_gameidx.count(game_path)) {
-                modeldata::Game game(fileinfo);
-                game.launch_cmd = collection.launch_cmd;
-                sctx.path_to_gameidx.emplace(game_path, sctx.games.size());
-                sctx.games.emplace_back(std::move(game));
-            }
-
-            const size_t game_idx = sctx.path_to_gameidx.at(game_path);
-            childs.emplace_back(game_idx);
-        }
-    }
+    systems.emplace_back(std::move(system));
 }
 
 } // namespace es2
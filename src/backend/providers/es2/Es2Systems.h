@@ -22,12 +22,38 @@
 #include "utils/HashMap.h"
 
 #include <QObject>
+#include <QString>
 #include <QXmlStreamReader>
+#include <vector>
 
 
 namespace providers {
 namespace es2 {
 
+/// The properties of a `<system>` node
+struct SystemEntry {
+    QString collection_name;
+    QString shortname;
+    QString path;
+    QString extensions;
+    QString launch_cmd;
+};
+
+/// The file extensions of a system, as a set of lowercase suffixes
+class ExtensionSet {
+public:
+    /// Takes the space separated list of a `<extension>` node. As in ES2, the
+    /// extensions should start with a dot, but it is added if missing.
+    explicit ExtensionSet(const QString& extensions_raw);
+
+    /// Returns true if the file name ends with one of the extensions
+    bool matches(const QString& file_name) const;
+
+private:
+    // NOTE: used as a set, the values are not relevant
+    HashMap<QString, bool> m_exts;
+};
+
 class SystemsParser : public QObject {
     Q_OBJECT
     Q_DISABLE_COPY(SystemsParser)
@@ -42,11 +68,10 @@ signals:
 
 private:
     void readSystemsFile(QXmlStreamReader&,
-                         providers::SearchContext&,
-                         HashMap<QString, QString>&);
+                         const providers::SearchContext&,
+                         std::vector<SystemEntry>&);
     void readSystemEntry(QXmlStreamReader&,
-                         providers::SearchContext&,
-                         HashMap<QString, QString>&);
+                         std::vector<SystemEntry>&);
 };
 
 } // namespace es2
@@ -20,6 +20,7 @@
 #include "GogCommon.h"
 #include "LocaleUtils.h"
 #include "Paths.h"
+#include "Trace.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "modeldata/gaming/GameData.h"
 #include "utils/MoveOnly.h"
@@ -46,11 +47,14 @@ struct GogEntry {
     MOVE_ONLY(GogEntry)
 };
 
-std::vector<GogEntry> find_game_entries()
+std::vector<GogEntry> find_game_entries(providers::SearchContext& sctx)
 {
     std::vector<GogEntry> entries;
 
 #ifdef Q_OS_WIN
+    // NOTE: registry changes cannot be tracked
+    sctx.sources_trackable = false;
+
     QSettings reg_base(QStringLiteral("HKEY_LOCAL_MACHINE\\SOFTWARE\\Wow6432Node\\GOG.com\\Games"),
                        QSettings::NativeFormat);
 
@@ -72,14 +76,17 @@ std::vector<GogEntry> find_game_entries()
 
 #ifdef Q_OS_LINUX
     const QString gogdir = paths::homePath() + QStringLiteral("/GOG Games");
+    const TraceSpan span("gog::scan_dir", gogdir);
+    sctx.source_paths.emplace_back(gogdir);
 
     constexpr auto dir_filters = QDir::Dirs | QDir::NoDotAndDotDot;
     constexpr auto dir_flags = QDirIterator::FollowSymlinks;
     const QRegularExpression re_numeric(QStringLiteral("^\\d+$"));
 
     QDirIterator dir_it(gogdir, dir_filters, dir_flags);
-    while (dir_it.hasNext()) {
+    while (dir_it.hasNext() && !sctx.cancelled()) {
         const QString gamedir(dir_it.next());
+        sctx.source_paths.emplace_back(gamedir);
 
         const QString launcher_path(gamedir + QStringLiteral("/start.sh"));
         const QFileInfo launcher_file(launcher_path);
@@ -95,6 +102,7 @@ std::vector<GogEntry> find_game_entries()
         };
 
         const QString gameinfo_path(gamedir + QStringLiteral("/gameinfo"));
+        sctx.source_paths.emplace_back(gameinfo_path);
         QFile config_file(gameinfo_path);
         if (config_file.open(QFile::ReadOnly | QFile::Text)) {
             QTextStream stream(&config_file);
@@ -115,6 +123,7 @@ std::vector<GogEntry> find_game_entries()
     }
 #endif
 
+    Q_UNUSED(sctx);
     return entries;
 }
 
@@ -128,16 +137,17 @@ bool invalid_entry(const GogEntry& entry)
 
 void register_entries(const std::vector<GogEntry>& entries,
                       providers::SearchContext& sctx,
-                      HashMap<size_t, QString>& gogids)
+                      HashMap<QString, QString>& gogids)
 {
     std::vector<size_t>& childs = sctx.collection_childs[providers::gog::gog_tag()];
 
     for (const GogEntry& entry : entries) {
         QFileInfo finfo(entry.exe);
-        const QString game_path = finfo.canonicalFilePath();
+        const QString game_path = sctx.path_cache->canonicalFilePath(finfo);
 
         if (!sctx.path_to_gameidx.count(game_path)) {
             modeldata::Game game(std::move(finfo));
+            game.files.front().canonical_path = game_path;
             game.title = entry.name;
             game.launch_cmd = '"' % entry.launch_cmd % '"';
             game.launch_workdir = entry.workdir;
@@ -150,7 +160,7 @@ void register_entries(const std::vector<GogEntry>& entries,
         childs.emplace_back(game_idx);
 
         if (!entry.id.isEmpty())
-            gogids.emplace(game_idx, entry.id);
+            gogids.emplace(game_path, entry.id);
     }
 }
 } // namespace
@@ -163,12 +173,12 @@ Gamelist::Gamelist(QObject* parent)
     : QObject(parent)
 {}
 
-void Gamelist::find(providers::SearchContext& sctx, HashMap<size_t, QString>& gogids)
+void Gamelist::find(providers::SearchContext& sctx, HashMap<QString, QString>& gogids)
 {
     static constexpr auto MSG_PREFIX = "GOG:";
 
 
-    std::vector<GogEntry> entries(find_game_entries());
+    std::vector<GogEntry> entries(find_game_entries(sctx));
     entries.erase(std::remove_if(entries.begin(), entries.end(), invalid_entry), entries.end());
 
     qInfo().noquote() << MSG_PREFIX << tr_log("%1 games found").arg(entries.size());
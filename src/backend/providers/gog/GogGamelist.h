@@ -33,7 +33,7 @@ class Gamelist : public QObject {
 public:
     explicit Gamelist(QObject* parent);
 
-    void find(providers::SearchContext&, HashMap<size_t, QString>&);
+    void find(providers::SearchContext&, HashMap<QString, QString>&);
 
 signals:
     void gameCountChanged(int count);
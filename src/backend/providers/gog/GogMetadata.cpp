@@ -288,18 +288,27 @@ Metadata::Metadata(QObject* parent)
     : QObject(parent)
 {}
 
-void Metadata::enhance(providers::SearchContext& sctx, HashMap<size_t, QString>& gogid_map)
+void Metadata::enhance(providers::SearchContext& sctx, HashMap<QString, QString>& gogid_map)
 {
     const QString GOG_TAG(QStringLiteral("GOG"));
     if (!sctx.collection_childs.count(GOG_TAG))
         return;
 
+    // NOTE: the ids are stored by path, as the game indices may change
+    // when the results of the providers get merged
+    HashMap<size_t, QString> gameidx_to_gogid;
+    for (const auto& entry : gogid_map) {
+        const auto it = sctx.path_to_gameidx.find(entry.first);
+        if (it != sctx.path_to_gameidx.cend())
+            gameidx_to_gogid.emplace(it->second, entry.second);
+    }
+
     std::vector<GogEntry> entries;
 
     const std::vector<size_t>& childs = sctx.collection_childs.at(GOG_TAG);
     for (const size_t game_idx : childs) {
-        if (Q_LIKELY(gogid_map.count(game_idx)))
-            entries.emplace_back(gogid_map.at(game_idx), &sctx.games.at(game_idx));
+        if (Q_LIKELY(gameidx_to_gogid.count(game_idx)))
+            entries.emplace_back(gameidx_to_gogid.at(game_idx), &sctx.games.at(game_idx));
     }
 
     // try to fill using cached jsons
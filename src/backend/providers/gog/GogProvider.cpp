@@ -17,12 +17,14 @@
 
 #include "GogProvider.h"
 
+#include "GogCommon.h"
+
 
 namespace providers {
 namespace gog {
 
 GogProvider::GogProvider(QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_LISTS | PROVIDES_STATIC_DATA, { gog_tag() }, parent)
     , gamelist(this)
     , metadata(this)
 {
@@ -32,6 +34,7 @@ GogProvider::GogProvider(QObject* parent)
 
 void GogProvider::findLists(SearchContext& sctx)
 {
+    m_gogids.clear();
     gamelist.find(sctx, m_gogids);
 }
 
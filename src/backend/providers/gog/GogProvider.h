@@ -36,7 +36,7 @@ public:
     void findStaticData(SearchContext&) final;
 
 private:
-    HashMap<size_t, QString> m_gogids;
+    HashMap<QString, QString> m_gogids;
 
     Gamelist gamelist;
     Metadata metadata;
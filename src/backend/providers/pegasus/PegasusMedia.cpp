@@ -18,10 +18,10 @@
 #include "PegasusMedia.h"
 
 #include "PegasusAssets.h"
+#include "Trace.h"
 #include "modeldata/gaming/GameData.h"
+#include "utils/DirListingCache.h"
 
-#include <QDir>
-#include <QDirIterator>
 #include <QFileInfo>
 #include <QStringBuilder>
 
@@ -41,42 +41,69 @@ AssetType detect_asset_type(const QString& basename, const QString& ext)
 namespace providers {
 namespace pegasus {
 
-void find_assets(const std::vector<QString>& dir_list, std::vector<modeldata::Game>& games)
+void find_assets(const std::vector<QString>& dir_list, SearchContext& sctx)
 {
+    std::vector<modeldata::Game>& games = sctx.games;
+
     // shortpath: canonical path to dir + extensionless filename
     HashMap<QString, modeldata::Game* const> games_by_shortpath;
     games_by_shortpath.reserve(games.size());
     for (modeldata::Game& game : games) {
         for (const modeldata::GameFile& gf_entry : qAsConst(game.files)) {
-            const QFileInfo& fi = gf_entry.fileinfo;
+            // NOTE: the canonical paths were resolved when the games were found
+            const QString& path = gf_entry.canonical_path;
+            if (path.isEmpty())
+                continue;
 
-            QString shortpath = fi.canonicalPath() % '/' % fi.completeBaseName();
+            QString shortpath = path.leftRef(path.lastIndexOf('/')) % '/' % gf_entry.fileinfo.completeBaseName();
             games_by_shortpath.emplace(std::move(shortpath), &game);
         }
     }
 
+    {
+        std::vector<QString> media_dirs;
+        media_dirs.reserve(dir_list.size());
+        for (const QString& dir_base : dir_list)
+            media_dirs.emplace_back(dir_base + QStringLiteral("/media"));
 
-    constexpr auto dir_filters = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto dir_flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
+        const TraceSpan span("pegasus::prefetch_media_dirs");
+        sctx.dir_cache->prefetch(media_dirs);
+    }
 
     for (const QString& dir_base : dir_list) {
+        if (sctx.cancelled())
+            return;
+
         const QString media_dir = dir_base + QStringLiteral("/media");
+        const TraceSpan span("pegasus::scan_media_dir", media_dir);
 
-        QDirIterator dir_it(media_dir, dir_filters, dir_flags);
-        while (dir_it.hasNext()) {
-            dir_it.next();
-            const QFileInfo fileinfo = dir_it.fileInfo();
+        // NOTE: directories are also listed, to be able to track their changes
+        for (const QString& subdir : sctx.dir_cache->findDirs(media_dir)) {
+            sctx.source_paths.emplace_back(subdir);
 
-            const QString shortpath = fileinfo.canonicalPath().remove(dir_base.length(), 6); // len of `/media`
-            if (!games_by_shortpath.count(shortpath))
+            // the assets of a game are in the directory of the same name
+            const QString shortpath = sctx.path_cache->canonicalDir(subdir)
+                .remove(dir_base.length(), 6); // len of `/media`
+            const auto game_it = games_by_shortpath.find(shortpath);
+            if (game_it == games_by_shortpath.cend())
                 continue;
 
-            const AssetType asset_type = detect_asset_type(fileinfo.completeBaseName(), fileinfo.suffix());
-            if (asset_type == AssetType::UNKNOWN)
-                continue;
+            modeldata::Game* const game = game_it->second;
+
+            const std::shared_ptr<const DirListing> listing = sctx.dir_cache->list(subdir);
+            for (const DirEntry& entry : *listing) {
+                if (entry.is_dir)
+                    continue;
+
+                const QString file_path = subdir % QLatin1Char('/') % entry.name;
+                const QFileInfo fileinfo(file_path);
+
+                const AssetType asset_type = detect_asset_type(fileinfo.completeBaseName(), fileinfo.suffix());
+                if (asset_type == AssetType::UNKNOWN)
+                    continue;
 
-            modeldata::Game* const game = games_by_shortpath[shortpath];
-            game->assets.addFileMaybe(asset_type, dir_it.filePath());
+                game->assets.addFileMaybe(asset_type, file_path);
+            }
         }
     }
 }
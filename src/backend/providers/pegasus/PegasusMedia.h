@@ -17,7 +17,7 @@
 
 #pragma once
 
-#include "utils/FwdDeclModelData.h"
+#include "providers/Provider.h"
 
 #include <QString>
 #include <vector>
@@ -26,7 +26,7 @@
 namespace providers {
 namespace pegasus {
 
-void find_assets(const std::vector<QString>&, std::vector<modeldata::Game>&);
+void find_assets(const std::vector<QString>&, SearchContext&);
 
 } // namespace pegasus
 } // namespace providers
@@ -23,20 +23,26 @@
 #include "PegasusAssets.h"
 #include "PegasusParser.h"
 #include "PegasusUtils.h"
+#include "Trace.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "modeldata/gaming/GameData.h"
+#include "providers/DataStream.h"
+#include "utils/DirListingCache.h"
 #include "utils/PathCheck.h"
 #include "utils/StdHelpers.h"
+#include "utils/StringPool.h"
 
+#include <QDataStream>
 #include <QDebug>
-#include <QDirIterator>
 #include <QRegularExpression>
 #include <QStringBuilder>
+#include <QtConcurrent/QtConcurrent>
 
 
 namespace {
 using namespace providers::pegasus::parser;
 using namespace providers::pegasus::utils;
+namespace datastream = providers::datastream;
 
 static constexpr auto MSG_PREFIX = "Collections:";
 
@@ -107,11 +113,12 @@ void parse_collection_entry(ParserContext& ctx, const config::Entry& entry)
             break;
         case CollAttrib::DIRECTORIES:
             for (const QString& value : entry.values) {
+                // NOTE: resolved later, so the results don't depend on the file system
                 QFileInfo finfo(value);
                 if (finfo.isRelative())
                     finfo.setFile(ctx.dir_path % '/' % value);
 
-                ctx.cur_filter->directories.append(finfo.canonicalFilePath());
+                ctx.cur_filter->directories.append(finfo.filePath());
             }
             break;
         case CollAttrib::EXTENSIONS:
@@ -270,6 +277,7 @@ void parse_entry(ParserContext& ctx, const config::Entry& entry)
             game.launch_workdir = ctx.cur_coll->launch_workdir;
         }
         ctx.outvars.games.emplace_back(std::move(game));
+        ctx.outvars.game_collections.emplace_back(ctx.cur_coll ? ctx.cur_coll->name : QString());
         ctx.cur_game = &ctx.outvars.games.back();
         return;
     }
@@ -293,8 +301,9 @@ void parse_entry(ParserContext& ctx, const config::Entry& entry)
         parse_collection_entry(ctx, entry);
 }
 
-void read_metafile(const QString& metafile_path, OutputVars& output, const ParserHelpers& helpers)
+bool read_metafile(const QString& metafile_path, OutputVars& output, const ParserHelpers& helpers)
 {
+    const TraceSpan span("pegasus::read_metafile", metafile_path);
     ParserContext ctx(metafile_path, output, helpers);
 
     const auto on_error = [&](const config::Error& error){
@@ -307,22 +316,227 @@ void read_metafile(const QString& metafile_path, OutputVars& output, const Parse
     if (!config::readFile(metafile_path, on_entry, on_error)) {
         qWarning().noquote() << MSG_PREFIX
             << tr_log("Failed to read metadata file %1, file ignored").arg(metafile_path);
+        return false;
+    }
+
+    return true;
+}
+
+void write_filter_group(QDataStream& stream, const FileFilterGroup& group)
+{
+    stream << group.extensions << group.files << group.regex;
+}
+
+void read_filter_group(QDataStream& stream, FileFilterGroup& group)
+{
+    stream >> group.extensions >> group.files >> group.regex;
+}
+
+QByteArray serialize_results(const OutputVars& results)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(datastream::STREAM_VERSION);
+
+    stream << static_cast<quint32>(results.collections.size());
+    for (const auto& entry : results.collections)
+        datastream::write_collection(stream, entry.second);
+
+    stream << static_cast<quint32>(results.games.size());
+    for (size_t i = 0; i < results.games.size(); i++) {
+        datastream::write_game(stream, results.games[i]);
+        stream << results.game_collections[i];
+    }
+
+    stream << static_cast<quint32>(results.filters.size());
+    for (const FileFilter& filter : results.filters) {
+        stream << filter.collection_name << filter.directories;
+        write_filter_group(stream, filter.include);
+        write_filter_group(stream, filter.exclude);
+    }
+
+    return bytes;
+}
+
+bool deserialize_results(const QByteArray& bytes, OutputVars& results)
+{
+    QDataStream stream(bytes);
+    stream.setVersion(datastream::STREAM_VERSION);
+
+    const quint32 coll_count = datastream::read_count(stream);
+    results.collections.reserve(coll_count);
+    for (quint32 i = 0; i < coll_count && datastream::stream_ok(stream); i++) {
+        modeldata::Collection coll = datastream::read_collection(stream);
+        results.collections.emplace(coll.name, std::move(coll));
+    }
+
+    const quint32 game_count = datastream::read_count(stream);
+    results.games.reserve(game_count);
+    results.game_collections.reserve(game_count);
+    for (quint32 i = 0; i < game_count && datastream::stream_ok(stream); i++) {
+        results.games.emplace_back(datastream::read_game(stream));
+
+        QString coll_name;
+        stream >> coll_name;
+        results.game_collections.emplace_back(std::move(coll_name));
+    }
+
+    const quint32 filter_count = datastream::read_count(stream);
+    results.filters.reserve(filter_count);
+    for (quint32 i = 0; i < filter_count && datastream::stream_ok(stream); i++) {
+        QString coll_name;
+        QStringList directories;
+        stream >> coll_name >> directories;
+        if (coll_name.isEmpty() || directories.isEmpty()) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        results.filters.emplace_back(std::move(coll_name), directories.takeFirst());
+        FileFilter& filter = results.filters.back();
+        filter.directories.append(directories);
+        read_filter_group(stream, filter.include);
+        read_filter_group(stream, filter.exclude);
+    }
+
+    return datastream::stream_ok(stream);
+}
+
+/// Reads the metadata file, or takes its contents from the cache if it didn't change
+void read_metafile_cached(const QString& metafile_path, OutputVars& output, const ParserHelpers& helpers,
+                          providers::ParseCache* const cache)
+{
+    if (!cache) {
+        read_metafile(metafile_path, output, helpers);
         return;
     }
+
+    const QString cache_tag = QStringLiteral("pegasus");
+
+    providers::ParseCache::FileStamp stamp;
+    const QByteArray cached = cache->find(cache_tag, metafile_path, stamp);
+    if (!cached.isEmpty()) {
+        if (deserialize_results(cached, output))
+            return;
+
+        output = OutputVars();
+    }
+
+    if (read_metafile(metafile_path, output, helpers))
+        cache->insert(cache_tag, metafile_path, stamp, serialize_results(output));
 }
 
-// collect collection and game information
-void collect_metadata(const std::vector<QString>& dir_list, OutputVars& results)
+/// A metadata file and the results of reading it
+struct MetafileTask {
+    QString path;
+    OutputVars results;
+
+    explicit MetafileTask(QString path) : path(std::move(path)) {}
+    MOVE_ONLY(MetafileTask)
+};
+
+void merge_collection(modeldata::Collection& target, modeldata::Collection& source)
 {
-    const ParserHelpers helpers;
+    // properties defined later override the earlier ones...
+    if (!source.shortName().isEmpty())
+        target.setShortName(source.shortName());
+    if (!source.launch_cmd.isEmpty())
+        target.launch_cmd = std::move(source.launch_cmd);
+    if (!source.launch_workdir.isEmpty())
+        target.launch_workdir = std::move(source.launch_workdir);
+    if (!source.summary.isEmpty())
+        target.summary = std::move(source.summary);
+    if (!source.description.isEmpty())
+        target.description = std::move(source.description);
+
+    // ...except the assets, where the first one wins
+    for (const auto& entry : source.assets.singleAssets()) {
+        if (!entry.second.isEmpty())
+            target.assets.addUrlMaybe(entry.first, entry.second);
+    }
+    for (const auto& entry : source.assets.multiAssets()) {
+        for (const QString& url : entry.second)
+            target.assets.addUrlMaybe(entry.first, url);
+    }
+}
+
+/// Moves the results of a metadata file into the search context, with the same
+/// outcome as if the file was read directly into it after the previous ones
+void merge_results(OutputVars& source, providers::SearchContext& sctx, std::vector<FileFilter>& filters)
+{
+    Q_ASSERT(source.games.size() == source.game_collections.size());
+
+    // Games copy the launch parameters of their collection when defined. If these
+    // weren't set in this file (yet), they'd come from the previous files.
+    for (size_t i = 0; i < source.games.size(); i++) {
+        modeldata::Game& game = source.games[i];
+
+        const auto coll_it = sctx.collections.find(source.game_collections[i]);
+        if (coll_it == sctx.collections.cend())
+            continue;
+
+        if (game.launch_cmd.isEmpty())
+            game.launch_cmd = coll_it->second.launch_cmd;
+        if (game.launch_workdir.isEmpty())
+            game.launch_workdir = coll_it->second.launch_workdir;
+    }
 
+    // NOTE: the files are parsed (or read from the cache) separately, so the
+    // same values in different files are only shared after interning
+    StringPool& pool = *sctx.string_pool;
+    sctx.games.reserve(sctx.games.size() + source.games.size());
+    for (modeldata::Game& game : source.games) {
+        pool.intern(game.launch_cmd);
+        pool.intern(game.launch_workdir);
+        pool.intern(game.developers);
+        pool.intern(game.publishers);
+        pool.intern(game.genres);
+        sctx.games.emplace_back(std::move(game));
+    }
+
+    for (auto& entry : source.collections) {
+        const auto it = sctx.collections.find(entry.first);
+        if (it == sctx.collections.end())
+            sctx.collections.emplace(entry.first, std::move(entry.second));
+        else
+            merge_collection(it->second, entry.second);
+    }
+
+    for (FileFilter& filter : source.filters)
+        filters.emplace_back(std::move(filter));
+}
+
+// collect collection and game information
+std::vector<FileFilter> collect_metadata(const std::vector<QString>& dir_list, providers::SearchContext& sctx)
+{
+    std::vector<MetafileTask> tasks;
     for (const QString& dir_path : dir_list) {
-        const QString metafile = find_metafile_in(dir_path);
+        if (sctx.cancelled())
+            return {};
+
+        // a metadata file may be created in the directory later
+        sctx.source_paths.emplace_back(dir_path);
+
+        QString metafile = find_metafile_in(dir_path);
         if (metafile.isEmpty())
             continue;
 
-        read_metafile(metafile, results, helpers);
+        sctx.source_paths.emplace_back(metafile);
+        tasks.emplace_back(std::move(metafile));
     }
+
+    // NOTE: the files are read in parallel, then merged in the original order
+    const ParserHelpers helpers;
+    QtConcurrent::blockingMap(tasks, [&helpers, &sctx](MetafileTask& task){
+        if (!sctx.cancelled())
+            read_metafile_cached(task.path, task.results, helpers, sctx.parse_cache.get());
+    });
+
+    std::vector<FileFilter> filters;
+    for (MetafileTask& task : tasks)
+        merge_results(task.results, sctx, filters);
+
+    return filters;
 }
 
 void remove_empty_games(std::vector<modeldata::Game>& games)
@@ -338,28 +552,33 @@ void remove_empty_games(std::vector<modeldata::Game>& games)
     games.erase(it, games.end());
 }
 
-void build_path_map(const std::vector<modeldata::Game>& games,
-                    HashMap<QString, size_t>& path_to_gameidx)
+void build_path_map(std::vector<modeldata::Game>& games,
+                    HashMap<QString, size_t>& path_to_gameidx,
+                    PathCache& path_cache)
 {
     for (size_t i = 0; i < games.size(); i++) {
         // empty games should have been removed already
         Q_ASSERT(games[i].files.size() > 0);
 
-        for (const modeldata::GameFile& entry : games[i].files) {
-            QString path = entry.fileinfo.canonicalFilePath();
+        for (modeldata::GameFile& entry : games[i].files) {
+            entry.canonical_path = path_cache.canonicalFilePath(entry.fileinfo);
 
             // File s are added to the game only if they exist;
             // the canonical path will be empty only if the file was deleted since this check
-            Q_ASSERT(!path.isEmpty());
-            if (Q_LIKELY(!path.isEmpty()))
-                path_to_gameidx.emplace(std::move(path), i);
+            Q_ASSERT(!entry.canonical_path.isEmpty());
+            if (Q_LIKELY(!entry.canonical_path.isEmpty()))
+                path_to_gameidx.emplace(entry.canonical_path, i);
         }
     }
 }
 
-void tidy_filters(std::vector<FileFilter>& filters)
+void tidy_filters(std::vector<FileFilter>& filters, PathCache& path_cache)
 {
     for (FileFilter& filter : filters) {
+        // the first one is the directory of the metadata file, the rest were set by the user
+        for (int i = 1; i < filter.directories.size(); i++)
+            filter.directories[i] = path_cache.canonicalDir(filter.directories.at(i));
+
         filter.directories.removeDuplicates();
         filter.include.extensions.removeDuplicates();
         filter.include.files.removeDuplicates();
@@ -369,52 +588,31 @@ void tidy_filters(std::vector<FileFilter>& filters)
 }
 
 // Find all dirs and subdirectories, but ignore 'media'
-QVector<QString> filter_find_dirs(const QString& filter_dir)
+std::vector<QString> filter_find_dirs(const QString& filter_dir, DirListingCache& dir_cache)
 {
-    constexpr auto subdir_filters = QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto subdir_flags = QDirIterator::FollowSymlinks | QDirIterator::Subdirectories;
-
-    QVector<QString> result;
+    const TraceSpan span("pegasus::find_dirs", filter_dir);
 
-    QDirIterator dirs_it(filter_dir, subdir_filters, subdir_flags);
-    while (dirs_it.hasNext())
-        result << dirs_it.next();
+    std::vector<QString> result = dir_cache.findDirs(filter_dir);
 
-    result.removeOne(filter_dir + QStringLiteral("/media"));
-    result.append(filter_dir + QStringLiteral("/")); // added "/" so all entries have base + 1 length
+    const QString media_dir = filter_dir + QStringLiteral("/media");
+    const auto media_it = std::find(result.begin(), result.end(), media_dir);
+    if (media_it != result.end())
+        result.erase(media_it);
 
     return result;
 }
 
-bool file_passes_filter(const QFileInfo& fileinfo, const FileFilter& filter, const QString filter_dir,
-                        const FileFilterHelpers& helpers)
-{
-    const QString relative_path = fileinfo.filePath().mid(filter_dir.length() + 1);
-
-    const bool exclude = filter.exclude.extensions.contains(fileinfo.suffix())
-        || filter.exclude.files.contains(relative_path)
-        || (!filter.exclude.regex.isEmpty() && helpers.rx_exclude.match(fileinfo.filePath()).hasMatch());
-    if (exclude)
-        return false;
-
-    const bool include = filter.include.extensions.contains(fileinfo.suffix())
-        || filter.include.files.contains(relative_path)
-        || (!filter.include.regex.isEmpty() && helpers.rx_include.match(fileinfo.filePath()).hasMatch());
-    if (!include)
-        return false;
-
-    return true;
-}
-
-void accept_filtered_file(const QFileInfo& fileinfo, const modeldata::Collection& parent,
-                          providers::SearchContext& sctx)
+void accept_filtered_file(const QString& dir_path, const DirEntry& entry, const QString& file_path,
+                          const modeldata::Collection& parent, providers::SearchContext& sctx)
 {
-    const QString game_path = fileinfo.canonicalFilePath();
+    const QString game_path = sctx.path_cache->canonicalFilePath(dir_path, entry);
     if (!sctx.path_to_gameidx.count(game_path)) {
         // This means there weren't any game entries with matching file entry
         // in any of the parsed metadata files. There is no existing game data
         // created yet either.
+        const QFileInfo fileinfo(file_path);
         modeldata::Game game(fileinfo);
+        game.files.front().canonical_path = game_path;
         game.launch_cmd = parent.launch_cmd;
         game.launch_workdir = parent.launch_workdir;
 
@@ -434,25 +632,37 @@ void accept_filtered_file(const QFileInfo& fileinfo, const modeldata::Collection
 
 void process_filters(const std::vector<FileFilter>& filters, providers::SearchContext& sctx)
 {
-    constexpr auto entry_filters = QDir::Files | QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto entry_flags = QDirIterator::FollowSymlinks;
+    // read all the directory trees in parallel first
+    {
+        std::vector<QString> filter_dirs;
+        for (const FileFilter& filter : filters)
+            filter_dirs.insert(filter_dirs.end(), filter.directories.cbegin(), filter.directories.cend());
+
+        const TraceSpan span("pegasus::prefetch_dirs");
+        sctx.dir_cache->prefetch(filter_dirs);
+    }
 
     for (const FileFilter& filter : filters) {
         const modeldata::Collection& collection = sctx.collections.at(filter.collection_name);
-        const FileFilterHelpers helpers(filter);
+        const FileFilterMatcher matcher(filter);
 
         for (const QString& filter_dir : filter.directories) {
             // ie. all dirs and subdirs except /media
-            const QVector<QString> dirs_to_check = filter_find_dirs(filter_dir);
+            const std::vector<QString> dirs_to_check = filter_find_dirs(filter_dir, *sctx.dir_cache);
 
             for (const QString& subdir : dirs_to_check) {
-                QDirIterator subdir_it(subdir, entry_filters, entry_flags);
-                while (subdir_it.hasNext()) {
-                    subdir_it.next();
-                    const QFileInfo fileinfo = subdir_it.fileInfo();
+                if (sctx.cancelled())
+                    return;
 
-                    if (file_passes_filter(fileinfo, filter, filter_dir, helpers))
-                        accept_filtered_file(fileinfo, collection, sctx);
+                const TraceSpan span("pegasus::scan_dir", subdir);
+                sctx.source_paths.emplace_back(subdir);
+
+                // NOTE: directories can also be games
+                const std::shared_ptr<const DirListing> listing = sctx.dir_cache->list(subdir);
+                for (const DirEntry& entry : *listing) {
+                    const QString file_path = subdir % QLatin1Char('/') % entry.name;
+                    if (matcher.passes(file_path, filter_dir))
+                        accept_filtered_file(subdir, entry, file_path, collection, sctx);
                 }
             }
         }
@@ -474,14 +684,15 @@ namespace pegasus {
 
 void find_in_dirs(const std::vector<QString>& dir_list, providers::SearchContext& sctx)
 {
-    OutputVars results(sctx.collections, sctx.games);
-    collect_metadata(dir_list, results);
+    std::vector<FileFilter> filters = collect_metadata(dir_list, sctx);
+    if (sctx.cancelled())
+        return;
 
     remove_empty_games(sctx.games);
-    build_path_map(sctx.games, sctx.path_to_gameidx);
+    build_path_map(sctx.games, sctx.path_to_gameidx, *sctx.path_cache);
 
-    tidy_filters(results.filters);
-    process_filters(results.filters, sctx);
+    tidy_filters(filters, *sctx.path_cache);
+    process_filters(filters, sctx);
 }
 
 } // namespace pegasus
@@ -40,18 +40,54 @@ FileFilter::FileFilter(QString collection, QString base_dir)
     Q_ASSERT(!directories.front().isEmpty());
 }
 
-FileFilterHelpers::FileFilterHelpers(const FileFilter& filter)
-    : rx_include(filter.include.regex)
-    , rx_exclude(filter.exclude.regex)
-{}
+FileFilterGroupMatcher::FileFilterGroupMatcher(const FileFilterGroup& group)
+    : regex(group.regex)
+    , has_regex(!group.regex.isEmpty())
+{
+    extensions.reserve(group.extensions.size());
+    for (const QString& ext : group.extensions)
+        extensions.emplace(ext, true);
 
+    files.reserve(group.files.size());
+    for (const QString& file : group.files)
+        files.emplace(file, true);
+
+    // compile now instead of at the first match
+    if (has_regex)
+        regex.optimize();
+}
+
+bool FileFilterGroupMatcher::matches(const QString& path, const QStringRef& relative_path,
+                                     const QStringRef& suffix) const
+{
+    return extensions.count(suffix)
+        || files.count(relative_path)
+        || (has_regex && regex.match(path).hasMatch());
+}
 
-OutputVars::OutputVars(HashMap<QString, modeldata::Collection>& collections,
-                       std::vector<modeldata::Game>& games)
-    : collections(collections)
-    , games(games)
+FileFilterMatcher::FileFilterMatcher(const FileFilter& filter)
+    : include(filter.include)
+    , exclude(filter.exclude)
 {}
 
+bool FileFilterMatcher::passes(const QString& file_path, const QString& filter_dir) const
+{
+    // NOTE: the same as QFileInfo::suffix(), but without allocating
+    const int name_start = file_path.lastIndexOf(QLatin1Char('/')) + 1;
+    const int last_dot = file_path.lastIndexOf(QLatin1Char('.'));
+    const QStringRef suffix = name_start <= last_dot
+        ? file_path.midRef(last_dot + 1)
+        : QStringRef();
+
+    const QStringRef relative_path = file_path.midRef(filter_dir.length() + 1);
+
+    return !exclude.matches(file_path, relative_path, suffix)
+        && include.matches(file_path, relative_path, suffix);
+}
+
+
+OutputVars::OutputVars() = default;
+
 
 ParserHelpers::ParserHelpers()
     : coll_attribs {
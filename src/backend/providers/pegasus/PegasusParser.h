@@ -85,20 +85,40 @@ struct FileFilter {
     explicit FileFilter(QString collection, QString base_dir);
     MOVE_ONLY(FileFilter)
 };
-struct FileFilterHelpers {
-    const QRegularExpression rx_include;
-    const QRegularExpression rx_exclude;
+/// A filter group prepared for checking lots of files
+struct FileFilterGroupMatcher {
+    // NOTE: used as sets, the values are not relevant
+    HashMap<QString, bool> extensions;
+    HashMap<QString, bool> files;
+    QRegularExpression regex;
+    bool has_regex;
+
+    explicit FileFilterGroupMatcher(const FileFilterGroup&);
+    MOVE_ONLY(FileFilterGroupMatcher)
+
+    bool matches(const QString& path, const QStringRef& relative_path, const QStringRef& suffix) const;
+};
+struct FileFilterMatcher {
+    const FileFilterGroupMatcher include;
+    const FileFilterGroupMatcher exclude;
+
+    explicit FileFilterMatcher(const FileFilter&);
+    MOVE_ONLY(FileFilterMatcher)
 
-    explicit FileFilterHelpers(const FileFilter&);
-    MOVE_ONLY(FileFilterHelpers)
+    /// Returns true if the file, found under one of the filter directories, passes the filter.
+    /// Extensions are compared case sensitively.
+    bool passes(const QString& file_path, const QString& filter_dir) const;
 };
 
+/// The results of reading a single metadata file
 struct OutputVars {
-    HashMap<QString, modeldata::Collection>& collections;
-    std::vector<modeldata::Game>& games;
+    HashMap<QString, modeldata::Collection> collections;
+    std::vector<modeldata::Game> games;
+    /// For each game, the name of the collection it was defined under, if any
+    std::vector<QString> game_collections;
     std::vector<FileFilter> filters;
 
-    explicit OutputVars(decltype(collections), decltype(games));
+    explicit OutputVars();
     MOVE_ONLY(OutputVars)
 };
 
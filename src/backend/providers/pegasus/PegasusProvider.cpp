@@ -65,7 +65,7 @@ PegasusProvider::PegasusProvider(QObject* parent)
 {}
 
 PegasusProvider::PegasusProvider(std::vector<QString> game_dirs, QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_LISTS | PROVIDES_STATIC_DATA, parent)
     , m_game_dirs(std::move(game_dirs))
 {}
 
@@ -77,7 +77,7 @@ void PegasusProvider::findLists(SearchContext& ctx)
 
 void PegasusProvider::findStaticData(SearchContext& ctx)
 {
-    find_assets(m_game_dirs, ctx.games);
+    find_assets(m_game_dirs, ctx);
 }
 
 } // namespace pegasus
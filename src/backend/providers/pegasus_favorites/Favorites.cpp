@@ -19,7 +19,6 @@
 
 #include "LocaleUtils.h"
 #include "Paths.h"
-#include "model/gaming/Game.h"
 
 #include <QDebug>
 #include <QFile>
@@ -46,13 +45,13 @@ Favorites::Favorites(QObject* parent)
 {}
 
 Favorites::Favorites(QString db_path, QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_DYNAMIC_DATA, parent)
     , m_db_path(std::move(db_path))
 {}
 
 void Favorites::findDynamicData(const QVector<model::Collection*>&,
-                                const QVector<model::Game*>&,
-                                const HashMap<QString, model::GameFile*>& path_map)
+                                modeldata::GameStore& store,
+                                const HashMap<QString, size_t>& path_map)
 {
     if (!QFileInfo::exists(m_db_path))
         return;
@@ -71,26 +70,27 @@ void Favorites::findDynamicData(const QVector<model::Collection*>&,
         if (line.startsWith('#'))
             continue;
 
-        if (path_map.count(line)) {
-            auto parent = static_cast<model::Game* const>(path_map.at(line)->parent());
-            parent->setFavorite(true);
-        }
+        const auto it = path_map.find(line);
+        if (it != path_map.cend())
+            store.setFavorite(store.fileGame(it->second), true);
     }
 }
 
-void Favorites::onGameFavoriteChanged(const QVector<model::Game*>& game_list)
+void Favorites::onGameFavoriteChanged(const modeldata::GameStore& store)
 {
     QMutexLocker lock(&m_task_guard);
 
     m_pending_task.clear();
     m_pending_task << QStringLiteral("# List of favorites, one path per line");
-    for (const model::Game* const game : game_list) {
-        if (game->favorite()) {
-            for (const model::GameFile* const file : game->filesConst()) {
-                const QString path = file->data().fileinfo.canonicalFilePath();
-                if (Q_LIKELY(!path.isEmpty()))
-                    m_pending_task << path;
-            }
+    for (size_t idx = 0; idx < store.size(); idx++) {
+        if (!store.isFavorite(idx))
+            continue;
+
+        const size_t first_file = store.firstFile(idx);
+        for (size_t file_idx = first_file; file_idx < first_file + store.fileCount(idx); file_idx++) {
+            const QString path = store.canonicalPath(file_idx);
+            if (Q_LIKELY(!path.isEmpty()))
+                m_pending_task << path;
         }
     }
 
@@ -33,9 +33,9 @@ public:
     explicit Favorites(QString db_path, QObject* parent = nullptr);
 
     void findDynamicData(const QVector<model::Collection*>&,
-                         const QVector<model::Game*>&,
-                         const HashMap<QString, model::GameFile*>&) final;
-    void onGameFavoriteChanged(const QVector<model::Game*>&) final;
+                         modeldata::GameStore&,
+                         const HashMap<QString, size_t>&) final;
+    void onGameFavoriteChanged(const modeldata::GameStore&) final;
 
 signals:
     void startedWriting();
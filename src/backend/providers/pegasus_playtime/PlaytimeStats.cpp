@@ -19,7 +19,7 @@
 
 #include "LocaleUtils.h"
 #include "Paths.h"
-#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
 
 #include <QDebug>
 #include <QFileInfo>
@@ -186,13 +186,13 @@ PlaytimeStats::PlaytimeStats(QObject* parent)
 {}
 
 PlaytimeStats::PlaytimeStats(QString db_path, QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_DYNAMIC_DATA, parent)
     , m_db_path(std::move(db_path))
 {}
 
 void PlaytimeStats::findDynamicData(const QVector<model::Collection*>&,
-                                    const QVector<model::Game*>&,
-                                    const HashMap<QString, model::GameFile*>& path_map)
+                                    modeldata::GameStore& store,
+                                    const HashMap<QString, size_t>& path_map)
 {
     if (!QFileInfo::exists(m_db_path))
         return;
@@ -240,11 +240,14 @@ void PlaytimeStats::findDynamicData(const QVector<model::Collection*>&,
         stats.playtime += std::max(static_cast<qint64>(0), duration);
         stats.playcount++;
     }
-    // trigger update only once
+    // summing the play times provided by multiple providers
     for (const auto& pair : stat_map) {
-        model::GameFile* gamefile = path_map.at(pair.first);
-        const Stats& stats = stat_map.at(pair.first);
-        gamefile->addPlayStats(stats.playcount, stats.playtime, stats.last_played);
+        const size_t file_idx = path_map.at(pair.first);
+        const Stats& stats = pair.second;
+        store.setPlayStats(file_idx,
+                           store.playCount(file_idx) + stats.playcount,
+                           store.playTime(file_idx) + stats.playtime,
+                           std::max(store.lastPlayed(file_idx), stats.last_played));
     }
 }
 
@@ -264,8 +267,11 @@ void PlaytimeStats::onGameFinished(model::GameFile* const gamefile)
     const auto now = QDateTime::currentDateTimeUtc();
     const auto duration = m_last_launch_time.secsTo(now);
 
+    // NOTE: the model is updated here, on the thread it belongs to
+    update_modelgame(gamefile, m_last_launch_time, duration);
+
     m_pending_tasks.emplace_back(
-        gamefile,
+        gamefile->canonicalPath(),
         m_last_launch_time,
         duration
     );
@@ -298,13 +304,11 @@ void PlaytimeStats::start_processing()
                 break;
 
             for (const QueueEntry& entry : m_active_tasks) {
-                const QString path = entry.gamefile->data().fileinfo.canonicalFilePath();
-                const int path_id = get_path_id(path);
+                const int path_id = get_path_id(entry.path);
                 if (path_id == -1)
                     continue;
 
                 save_play_entry(path_id, entry.launch_time, entry.duration);
-                update_modelgame(entry.gamefile, entry.launch_time, entry.duration);
             }
 
             channel.commit();
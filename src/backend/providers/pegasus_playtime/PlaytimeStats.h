@@ -34,8 +34,8 @@ public:
     explicit PlaytimeStats(QString db_path, QObject* parent = nullptr);
 
     void findDynamicData(const QVector<model::Collection*>&,
-                         const QVector<model::Game*>&,
-                         const HashMap<QString, model::GameFile*>&) final;
+                         modeldata::GameStore&,
+                         const HashMap<QString, size_t>&) final;
     void onGameLaunched(model::GameFile* const) final;
     void onGameFinished(model::GameFile* const) final;
 
@@ -49,12 +49,12 @@ private:
     QDateTime m_last_launch_time;
 
     struct QueueEntry {
-        model::GameFile* const gamefile;
+        const QString path;
         const QDateTime launch_time;
         const qint64 duration;
 
-        QueueEntry(model::GameFile* const gamefile, QDateTime launch_time, qint64 duration)
-            : gamefile(std::move(gamefile))
+        QueueEntry(QString path, QDateTime launch_time, qint64 duration)
+            : path(std::move(path))
             , launch_time(std::move(launch_time))
             , duration(std::move(duration))
         {}
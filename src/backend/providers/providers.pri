@@ -1,9 +1,17 @@
 HEADERS += \
+    $$PWD/DataStream.h \
+    $$PWD/LibrarySnapshot.h \
+    $$PWD/LibraryWatcher.h \
+    $$PWD/ParseCache.h \
     $$PWD/Provider.h \
     $$PWD/ProviderManager.h \
     $$PWD/EnabledProviders.h
 
 SOURCES += \
+    $$PWD/DataStream.cpp \
+    $$PWD/LibrarySnapshot.cpp \
+    $$PWD/LibraryWatcher.cpp \
+    $$PWD/ParseCache.cpp \
     $$PWD/Provider.cpp \
     $$PWD/ProviderManager.cpp \
 
@@ -19,11 +19,14 @@
 
 #include "AppSettings.h"
 #include "LocaleUtils.h"
+#include "Trace.h"
 #include "modeldata/gaming/GameData.h"
+#include "utils/DirListingCache.h"
 
 #include <QDebug>
-#include <QDirIterator>
+#include <QFileInfo>
 #include <QStringBuilder>
+#include <algorithm>
 
 
 namespace {
@@ -40,21 +43,35 @@ std::vector<QString> get_game_dirs()
     return game_dirs;
 }
 
-HashMap<QString, modeldata::Game* const> build_gamepath_db(std::vector<modeldata::Game>& games)
+/// The games of a directory, by their extensionless file name
+using GamesByBasename = HashMap<QString, modeldata::Game*>;
+
+/// The games by their directory path and extensionless file name
+HashMap<QString, GamesByBasename> build_gamepath_db(std::vector<modeldata::Game>& games)
 {
-    HashMap<QString, modeldata::Game* const> map;
+    HashMap<QString, GamesByBasename> map;
 
     for (modeldata::Game& game : games) {
         for (const modeldata::GameFile& file_entry : game.files) {
-            const QFileInfo& finfo = file_entry.fileinfo;
+            // NOTE: the canonical paths were resolved when the games were found
+            const QString& canonical_path = file_entry.canonical_path;
+            if (canonical_path.isEmpty())
+                continue;
 
-            QString path = finfo.canonicalPath() % '/' % finfo.completeBaseName();
-            map.emplace(std::move(path), &game);
+            QString dir_path = canonical_path.left(canonical_path.lastIndexOf('/'));
+            map[std::move(dir_path)].emplace(file_entry.fileinfo.completeBaseName(), &game);
         }
     }
 
     return map;
 }
+
+/// Returns the file name without its last extension, like `QFileInfo::completeBaseName`
+QStringRef complete_basename(const QString& file_name)
+{
+    const int dot_idx = file_name.lastIndexOf(QLatin1Char('.'));
+    return dot_idx < 0 ? QStringRef(&file_name) : file_name.leftRef(dot_idx);
+}
 } // namespace
 
 
@@ -68,7 +85,7 @@ SkraperAssetsProvider::SkraperDir::SkraperDir(AssetType type, QString dir)
 
 
 SkraperAssetsProvider::SkraperAssetsProvider(QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_STATIC_DATA, parent)
     , m_asset_dirs {
         // NOTE: The entries are ordered by priority
         { AssetType::ARCADE_MARQUEE, QStringLiteral("screenmarquee") },
@@ -89,10 +106,14 @@ SkraperAssetsProvider::SkraperAssetsProvider(QObject* parent)
         { AssetType::VIDEOS, QStringLiteral("videos") },
     }
     , m_media_dirs {
-        QStringLiteral("/skraper/"),
-        QStringLiteral("/media/"),
+        QStringLiteral("/skraper"),
+        QStringLiteral("/media"),
     }
-{}
+{
+    m_asset_dir_priority.reserve(m_asset_dirs.size());
+    for (size_t i = 0; i < m_asset_dirs.size(); i++)
+        m_asset_dir_priority.emplace(m_asset_dirs[i].dir_name, i);
+}
 
 void SkraperAssetsProvider::findStaticData(SearchContext& sctx)
 {
@@ -100,36 +121,91 @@ void SkraperAssetsProvider::findStaticData(SearchContext& sctx)
     unsigned found_assets_cnt = 0;
 
     const std::vector<QString> game_dirs = get_game_dirs();
-    const HashMap<QString, modeldata::Game* const> extless_path_to_game = build_gamepath_db(sctx.games);
+    const HashMap<QString, GamesByBasename> games_by_dir = build_gamepath_db(sctx.games);
 
-    constexpr auto dir_filters = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto dir_flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
+    // pass 1: find the asset directories in the media roots, with one listing per root
 
+    struct AssetSearchDir {
+        QString path;
+        size_t asset_dir_idx;
+        int game_dir_len;
+        int subpath_len;
+    };
+    std::vector<AssetSearchDir> search_dirs;
 
     for (const QString& game_dir : game_dirs) {
         for (const QString& media_dir : m_media_dirs) {
             const QString game_media_dir = game_dir % media_dir;
-            if (!QFileInfo::exists(game_media_dir))
+            sctx.source_paths.emplace_back(game_media_dir % QLatin1Char('/'));
+
+            const size_t first_found = search_dirs.size();
+
+            const std::shared_ptr<const DirListing> listing = sctx.dir_cache->list(game_media_dir);
+            for (const DirEntry& entry : *listing) {
+                if (!entry.is_dir)
+                    continue;
+
+                const auto priority_it = m_asset_dir_priority.find(entry.name);
+                if (priority_it == m_asset_dir_priority.cend())
+                    continue;
+
+                search_dirs.emplace_back(AssetSearchDir {
+                    game_media_dir % QLatin1Char('/') % entry.name,
+                    priority_it->second,
+                    game_dir.length(),
+                    media_dir.length() + 1 + entry.name.length(),
+                });
+            }
+
+            // the assets of the same game are added in the order of priority
+            std::sort(search_dirs.begin() + static_cast<std::ptrdiff_t>(first_found), search_dirs.end(),
+                [](const AssetSearchDir& a, const AssetSearchDir& b){ return a.asset_dir_idx < b.asset_dir_idx; });
+        }
+    }
+
+    // read all the asset directory trees in parallel
+    {
+        std::vector<QString> search_paths;
+        search_paths.reserve(search_dirs.size());
+        for (const AssetSearchDir& search_dir : search_dirs)
+            search_paths.emplace_back(search_dir.path);
+
+        const TraceSpan span("skraper::prefetch_dirs");
+        sctx.dir_cache->prefetch(search_paths);
+    }
+
+    // pass 2: match the files to the games
+
+    for (const AssetSearchDir& search_dir : search_dirs) {
+        if (sctx.cancelled())
+            return;
+
+        const TraceSpan span("skraper::scan_dir", search_dir.path);
+        const AssetType asset_type = m_asset_dirs[search_dir.asset_dir_idx].asset_type;
+
+        // NOTE: directories are also listed, to be able to track their changes
+        for (const QString& subdir : sctx.dir_cache->findDirs(search_dir.path)) {
+            sctx.source_paths.emplace_back(subdir);
+
+            const QString game_dir_path = sctx.path_cache->canonicalDir(subdir)
+                                            .remove(search_dir.game_dir_len, search_dir.subpath_len);
+            const auto games_it = games_by_dir.find(game_dir_path);
+            if (games_it == games_by_dir.cend())
                 continue;
 
-            for (const SkraperDir& asset_dir : m_asset_dirs) {
-                const QString search_dir = game_media_dir % asset_dir.dir_name;
-                const int subpath_len = media_dir.length() + asset_dir.dir_name.length();
+            const GamesByBasename& games = games_it->second;
 
-                QDirIterator dir_it(search_dir, dir_filters, dir_flags);
-                while (dir_it.hasNext()) {
-                    dir_it.next();
-                    const QFileInfo finfo = dir_it.fileInfo();
+            const std::shared_ptr<const DirListing> listing = sctx.dir_cache->list(subdir);
+            for (const DirEntry& entry : *listing) {
+                if (entry.is_dir)
+                    continue;
 
-                    const QString game_path = finfo.canonicalPath().remove(game_dir.length(), subpath_len)
-                                            % '/' % finfo.completeBaseName();
-                    if (!extless_path_to_game.count(game_path))
-                        continue;
+                const auto game_it = games.find(complete_basename(entry.name));
+                if (game_it == games.cend())
+                    continue;
 
-                    modeldata::Game* const game = extless_path_to_game.at(game_path);
-                    game->assets.addFileMaybe(asset_dir.asset_type, dir_it.filePath());
-                    found_assets_cnt++;
-                }
+                game_it->second->assets.addFileMaybe(asset_type, subdir % QLatin1Char('/') % entry.name);
+                found_assets_cnt++;
             }
         }
     }
@@ -19,6 +19,7 @@
 
 #include "providers/Provider.h"
 #include "types/AssetType.h"
+#include "utils/HashMap.h"
 #include "utils/MoveOnly.h"
 
 #include <array>
@@ -45,6 +46,8 @@ private:
     };
     const std::vector<SkraperDir> m_asset_dirs;
     const std::array<QString, 2> m_media_dirs;
+    /// The index of the asset directories in `m_asset_dirs`, by their name
+    HashMap<QString, size_t> m_asset_dir_priority;
 };
 
 } // namespace skraper
@@ -19,12 +19,13 @@
 
 #include "LocaleUtils.h"
 #include "Paths.h"
+#include "Trace.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "modeldata/gaming/GameData.h"
+#include "utils/DirListingCache.h"
 
 #include <QDebug>
 #include <QDir>
-#include <QDirIterator>
 #include <QFileInfo>
 #include <QRegularExpression>
 #include <QSettings>
@@ -35,7 +36,9 @@
 namespace {
 static constexpr auto MSG_PREFIX = "Steam:";
 
-QString find_steam_datadir()
+/// Returns the first existing Steam directory. The paths checked are added to the
+/// sources, so if a missing one with higher priority gets created, it is noticed.
+QString find_steam_datadir(std::vector<QString>& source_paths)
 {
     QStringList possible_dirs;
 
@@ -62,6 +65,7 @@ QString find_steam_datadir()
 
 
     for (const auto& dir : qAsConst(possible_dirs)) {
+        source_paths.emplace_back(dir);
         if (QFileInfo::exists(dir)) {
             qInfo().noquote() << MSG_PREFIX << tr_log("found data directory: `%1`").arg(dir);
             return dir;
@@ -72,13 +76,16 @@ QString find_steam_datadir()
     return {};
 }
 
-std::vector<QString> find_steam_installdirs(const QString& steam_datadir)
+std::vector<QString> find_steam_installdirs(const QString& steam_datadir,
+                                            std::vector<QString>& source_paths)
 {
     std::vector<QString> installdirs;
     installdirs.emplace_back(steam_datadir % QLatin1String("steamapps"));
 
 
     const QString config_path = steam_datadir % QLatin1String("config/config.vdf");
+    source_paths.emplace_back(config_path);
+
     QFile configfile(config_path);
     if (!configfile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         qWarning().noquote() << MSG_PREFIX
@@ -97,6 +104,8 @@ std::vector<QString> find_steam_installdirs(const QString& steam_datadir)
             const QString path = match.captured(1) % QLatin1String("/steamapps/");
             if (QFileInfo::exists(path))
                 installdirs.emplace_back(path);
+            else
+                source_paths.emplace_back(path); // eg. a library on an unplugged drive
         }
     }
 
@@ -108,19 +117,32 @@ void register_appmanifests(providers::SearchContext& sctx,
                            std::vector<size_t>& collection_childs,
                            const std::vector<QString>& installdirs)
 {
-    const auto dir_filters = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    const auto dir_flags = QDirIterator::FollowSymlinks;
-    const QStringList name_filters = { QStringLiteral("appmanifest_*.acf") };
-
     for (const QString& dir_path : installdirs) {
-        QDirIterator dir_it(dir_path, name_filters, dir_filters, dir_flags);
-        while (dir_it.hasNext()) {
-            dir_it.next();
-            QFileInfo fileinfo = dir_it.fileInfo();
+        if (sctx.cancelled())
+            return;
+
+        const TraceSpan span("steam::scan_dir", dir_path);
+        sctx.source_paths.emplace_back(dir_path);
+
+        // ie. `appmanifest_*.acf` files
+        const std::shared_ptr<const DirListing> listing = sctx.dir_cache->list(dir_path);
+        for (const DirEntry& entry : *listing) {
+            const bool is_manifest = !entry.is_dir
+                && entry.name.startsWith(QLatin1String("appmanifest_"), Qt::CaseInsensitive)
+                && entry.name.endsWith(QLatin1String(".acf"), Qt::CaseInsensitive);
+            if (!is_manifest)
+                continue;
+
+            const QString file_path = dir_path % QLatin1Char('/') % entry.name;
+
+            // the manifest contents are read later
+            sctx.source_paths.emplace_back(file_path);
 
-            const QString game_path = fileinfo.canonicalFilePath();
+            const QString game_path = sctx.path_cache->canonicalFilePath(dir_path, entry);
             if (!sctx.path_to_gameidx.count(game_path)) {
+                const QFileInfo fileinfo(file_path);
                 modeldata::Game game(fileinfo);
+                game.files.front().canonical_path = game_path;
                 sctx.path_to_gameidx.emplace(game_path, sctx.games.size());
                 sctx.games.emplace_back(std::move(game));
             }
@@ -143,11 +165,11 @@ Gamelist::Gamelist(QObject* parent)
 
 void Gamelist::find(providers::SearchContext& sctx)
 {
-    const QString steamdir = find_steam_datadir();
+    const QString steamdir = find_steam_datadir(sctx.source_paths);
     if (steamdir.isEmpty())
         return;
 
-    const std::vector<QString> installdirs = find_steam_installdirs(steamdir);
+    const std::vector<QString> installdirs = find_steam_installdirs(steamdir, sctx.source_paths);
     if (installdirs.empty()) {
         qWarning().noquote() << MSG_PREFIX << tr_log("no installation directories found");
         return;
@@ -21,8 +21,10 @@
 #include "Paths.h"
 #include "modeldata/gaming/CollectionData.h"
 #include "modeldata/gaming/GameData.h"
+#include "providers/DataStream.h"
 #include "providers/JsonCacheUtils.h"
 
+#include <QDataStream>
 #include <QDebug>
 #include <QDir>
 #include <QEventLoop>
@@ -102,6 +104,39 @@ SteamGameEntry read_manifest(const QString& manifest_path)
     return entry;
 }
 
+/// Reads the manifest file, or takes its contents from the cache if it didn't change
+SteamGameEntry read_manifest_cached(const QString& manifest_path, providers::ParseCache* const cache)
+{
+    if (!cache)
+        return read_manifest(manifest_path);
+
+    const QString cache_tag = QStringLiteral("steam");
+
+    providers::ParseCache::FileStamp stamp;
+    const QByteArray cached = cache->find(cache_tag, manifest_path, stamp);
+    if (!cached.isEmpty()) {
+        QDataStream stream(cached);
+        stream.setVersion(providers::datastream::STREAM_VERSION);
+
+        SteamGameEntry entry;
+        stream >> entry.appid >> entry.title;
+        if (providers::datastream::stream_ok(stream))
+            return entry;
+    }
+
+    SteamGameEntry entry = read_manifest(manifest_path);
+    if (entry.parsed()) {
+        QByteArray bytes;
+        {
+            QDataStream stream(&bytes, QIODevice::WriteOnly);
+            stream.setVersion(providers::datastream::STREAM_VERSION);
+            stream << entry.appid << entry.title;
+        }
+        cache->insert(cache_tag, manifest_path, stamp, std::move(bytes));
+    }
+    return entry;
+}
+
 bool read_json(modeldata::Game& game, const QJsonDocument& json)
 {
     if (json.isNull())
@@ -321,7 +356,7 @@ void Metadata::enhance(providers::SearchContext& sctx)
         Q_ASSERT(game.files.size() == 1);
         const QString path = game.files.cbegin()->fileinfo.absoluteFilePath();
 
-        SteamGameEntry entry = read_manifest(path);
+        SteamGameEntry entry = read_manifest_cached(path, sctx.parse_cache.get());
         if (!entry.appid.isEmpty()) {
             if (entry.title.isEmpty())
                 entry.title = QLatin1String("App #") % entry.appid;
@@ -348,7 +383,7 @@ void Metadata::enhance(providers::SearchContext& sctx)
             uncached_entries.push_back(std::move(entry));
     }
 
-    if (uncached_entries.empty())
+    if (uncached_entries.empty() || sctx.cancelled())
         return;
 
     // try to fill from network
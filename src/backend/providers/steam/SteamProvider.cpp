@@ -22,7 +22,7 @@ namespace providers {
 namespace steam {
 
 SteamProvider::SteamProvider(QObject* parent)
-    : Provider(parent)
+    : Provider(PROVIDES_LISTS | PROVIDES_STATIC_DATA, { QStringLiteral("Steam") }, parent)
     , gamelist(this)
     , metadata(this)
 {
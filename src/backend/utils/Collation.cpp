@@ -0,0 +1,67 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Collation.h"
+
+#include <QLocale>
+#include <algorithm>
+#include <numeric>
+
+
+namespace collation {
+
+QCollator create_collator(const QString& bcp47tag)
+{
+    return QCollator(QLocale(bcp47tag));
+}
+
+QString sort_title(const QString& title, bool ignore_articles)
+{
+    if (!ignore_articles)
+        return title;
+
+    static const QLatin1String ARTICLES[] {
+        QLatin1String("the "),
+        QLatin1String("an "),
+        QLatin1String("a "),
+    };
+    for (const QLatin1String& article : ARTICLES) {
+        // NOTE: a title that is just the article is kept as it is
+        if (title.size() > article.size() && title.startsWith(article, Qt::CaseInsensitive))
+            return title.mid(article.size()).trimmed();
+    }
+    return title;
+}
+
+std::vector<quint32> ranks_of(const std::vector<QCollatorSortKey>& keys)
+{
+    std::vector<quint32> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+        [&keys](quint32 a, quint32 b){ return keys[a].compare(keys[b]) < 0; });
+
+    std::vector<quint32> ranks(keys.size());
+    quint32 rank = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i > 0 && keys[order[i - 1]].compare(keys[order[i]]) != 0)
+            rank++;
+
+        ranks[order[i]] = rank;
+    }
+    return ranks;
+}
+
+} // namespace collation
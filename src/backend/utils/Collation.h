@@ -0,0 +1,37 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <QCollator>
+#include <QString>
+#include <vector>
+
+
+namespace collation {
+
+/// Creates a collator for the locale of the BCP 47 language tag
+QCollator create_collator(const QString& bcp47tag);
+
+/// Returns the text a title is sorted by. If `ignore_articles` is set,
+/// a leading English article ("The", "A", "An") is skipped.
+QString sort_title(const QString& title, bool ignore_articles);
+
+/// Returns the order of the sort keys, as a rank for each of them;
+/// equal keys get the same rank
+std::vector<quint32> ranks_of(const std::vector<QCollatorSortKey>&);
+
+} // namespace collation
@@ -0,0 +1,459 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "DirListingCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QStringBuilder>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#else
+#include <QDateTime>
+#include <QDirIterator>
+#endif
+
+
+namespace {
+#ifdef Q_OS_LINUX
+// NOTE: the glibc headers do not declare this
+struct linux_dirent64 {
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+void fill_stats(DirEntry& entry, const struct stat& st)
+{
+    entry.size = st.st_size;
+    entry.mtime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+    entry.device = st.st_dev;
+    entry.inode = st.st_ino;
+    entry.is_dir = S_ISDIR(st.st_mode);
+}
+
+// Fills the entry if its type was not known from the directory listing.
+// Returns false if it's not a regular file or directory, or a symlink to one.
+bool read_stats(int dir_fd, const char* name, DirEntry& entry)
+{
+    struct stat st;
+    if (!entry.is_symlink) {
+        if (::fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            return false;
+
+        entry.is_symlink = S_ISLNK(st.st_mode);
+    }
+    // NOTE: broken links fail here
+    if (entry.is_symlink && ::fstatat(dir_fd, name, &st, 0) != 0)
+        return false;
+
+    fill_stats(entry, st);
+    return S_ISDIR(st.st_mode) || S_ISREG(st.st_mode);
+}
+
+DirListing read_dir(const QString& dir_path)
+{
+    DirListing entries;
+    if (dir_path.isEmpty())
+        return entries;
+
+    const int dir_fd = ::open(QFile::encodeName(dir_path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0)
+        return entries;
+
+    // NOTE: large enough to read most directories with a few calls
+    std::vector<char> buffer(64 * 1024);
+    while (true) {
+        const long bytes = ::syscall(SYS_getdents64, dir_fd, buffer.data(), buffer.size());
+        if (bytes <= 0)
+            break;
+
+        for (long offset = 0; offset < bytes; ) {
+            const auto dirent = reinterpret_cast<const linux_dirent64*>(buffer.data() + offset);
+            offset += dirent->d_reclen;
+
+            // hidden files, including `.` and `..`
+            const char* const name = dirent->d_name;
+            if (name[0] == '.')
+                continue;
+
+            DirEntry entry { QString(), -1, -1, 0, 0, false, false };
+            switch (dirent->d_type) {
+                case DT_REG:
+                    break;
+                case DT_DIR:
+                    entry.is_dir = true;
+                    break;
+                case DT_LNK:
+                    entry.is_symlink = true;
+                    if (!read_stats(dir_fd, name, entry))
+                        continue;
+                    break;
+                case DT_UNKNOWN:
+                    if (!read_stats(dir_fd, name, entry))
+                        continue;
+                    break;
+                default:
+                    // devices, pipes, sockets
+                    continue;
+            }
+
+            entry.name = QFile::decodeName(name);
+            entries.emplace_back(std::move(entry));
+        }
+    }
+
+    ::close(dir_fd);
+    return entries;
+}
+#else
+DirListing read_dir(const QString& dir_path)
+{
+    constexpr auto entry_filters = QDir::Files | QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
+
+    DirListing entries;
+    if (dir_path.isEmpty())
+        return entries;
+
+    QDirIterator dir_it(dir_path, entry_filters);
+    while (dir_it.hasNext()) {
+        dir_it.next();
+        const QFileInfo finfo = dir_it.fileInfo();
+        entries.push_back({
+            finfo.fileName(),
+            finfo.size(),
+            finfo.lastModified().toMSecsSinceEpoch(),
+            0,
+            0,
+            finfo.isDir(),
+            finfo.isSymLink(),
+        });
+    }
+
+    return entries;
+}
+#endif
+
+/// Returns the device the directory is on, or 0 if not known
+quint64 device_of(const QString& dir_path)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(dir_path).constData(), &st) == 0)
+        return st.st_dev;
+#else
+    Q_UNUSED(dir_path);
+#endif
+    return 0;
+}
+
+/// Returns how many directories of the device may be read at the same time
+int device_concurrency(quint64 device, int max_readers)
+{
+#ifdef Q_OS_LINUX
+    // spinning disks are read one directory at a time, to avoid seeking back and forth;
+    // for partitions, the queue info is in the directory of the parent device
+    const QString sysfs_dir = QStringLiteral("/sys/dev/block/%1:%2/").arg(major(device)).arg(minor(device));
+    const QString queue_subpaths[] {
+        QStringLiteral("queue/rotational"),
+        QStringLiteral("../queue/rotational"),
+    };
+    for (const QString& subpath : queue_subpaths) {
+        QFile file(sysfs_dir + subpath);
+        if (file.open(QIODevice::ReadOnly))
+            return file.read(1) == "1" ? 1 : max_readers;
+    }
+#else
+    Q_UNUSED(device);
+#endif
+    // SSDs, network shares, or not known
+    return max_readers;
+}
+
+
+/// Remembers the linked directories already visited
+class LinkedDirSet {
+public:
+    /// Returns true if the linked directory was not seen before
+    bool insert(const QString& dir_path, const DirEntry& entry)
+    {
+        // identified by their device and inode if known, or by their canonical path otherwise
+        if (entry.inode)
+            return m_ids.emplace(entry.device, entry.inode).second;
+
+        return m_paths.emplace(QFileInfo(dir_path).canonicalFilePath(), true).second;
+    }
+
+private:
+    std::set<std::pair<quint64, quint64>> m_ids;
+    // NOTE: used as a set, the values are not relevant
+    HashMap<QString, bool> m_paths;
+};
+
+
+/// Reads directory trees into the cache using multiple threads. Every directory
+/// is a task; the workers take tasks from the back of their own queue, and when
+/// that's empty, steal from the front of the others'. The queues are kept per
+/// device, so a device with no free reader slots does not hold up the others.
+class TreePrefetcher {
+public:
+    TreePrefetcher(DirListingCache& cache, size_t worker_count)
+        : m_cache(cache)
+        , m_worker_count(worker_count)
+        , m_pending(0)
+    {}
+    NO_COPY_NO_MOVE(TreePrefetcher)
+
+    void addRoot(const QString& dir_path)
+    {
+        QMutexLocker lock(&m_lock);
+        push_task(0, Task { dir_path, device_of(dir_path) });
+    }
+
+    /// Processes tasks until all directories are read
+    void work(size_t worker)
+    {
+        QMutexLocker lock(&m_lock);
+        while (m_pending > 0) {
+            Task task;
+            if (!take_task(worker, task)) {
+                m_cond.wait(&m_lock);
+                continue;
+            }
+
+            lock.unlock();
+            std::vector<Task> subtasks = read_task(task);
+            lock.relock();
+
+            m_devices.at(task.device).free_slots++;
+            for (Task& subtask : subtasks)
+                push_task(worker, std::move(subtask));
+
+            m_pending--;
+            m_cond.wakeAll();
+        }
+    }
+
+    void helperStarted() { m_helpers_started++; }
+    void helperFinished() { m_helpers_finished.release(); }
+    void waitForHelpers() { m_helpers_finished.acquire(m_helpers_started); }
+
+private:
+    struct Task {
+        QString path;
+        quint64 device;
+    };
+    struct Device {
+        int free_slots;
+        size_t queued;
+        std::vector<std::deque<Task>> queues; ///< one per worker
+    };
+
+    DirListingCache& m_cache;
+    const size_t m_worker_count;
+
+    QMutex m_lock;
+    QWaitCondition m_cond;
+    std::map<quint64, Device> m_devices;
+    size_t m_pending; ///< the tasks queued or in progress
+
+    QMutex m_links_lock;
+    LinkedDirSet m_visited_links;
+
+    int m_helpers_started = 0;
+    QSemaphore m_helpers_finished;
+
+    // NOTE: must be called with the lock held
+    void push_task(size_t worker, Task task)
+    {
+        auto dev_it = m_devices.find(task.device);
+        if (dev_it == m_devices.end()) {
+            Device device {
+                device_concurrency(task.device, static_cast<int>(m_worker_count)),
+                0,
+                std::vector<std::deque<Task>>(m_worker_count),
+            };
+            dev_it = m_devices.emplace(task.device, std::move(device)).first;
+        }
+
+        dev_it->second.queues[worker].emplace_back(std::move(task));
+        dev_it->second.queued++;
+        m_pending++;
+    }
+
+    // NOTE: must be called with the lock held
+    bool take_task(size_t worker, Task& task)
+    {
+        for (auto& dev_entry : m_devices) {
+            Device& device = dev_entry.second;
+            if (device.free_slots == 0 || device.queued == 0)
+                continue;
+
+            std::deque<Task>& own_queue = device.queues[worker];
+            if (!own_queue.empty()) {
+                task = std::move(own_queue.back());
+                own_queue.pop_back();
+            }
+            else {
+                for (size_t i = 1; i < m_worker_count; i++) {
+                    std::deque<Task>& other_queue = device.queues[(worker + i) % m_worker_count];
+                    if (!other_queue.empty()) {
+                        task = std::move(other_queue.front());
+                        other_queue.pop_front();
+                        break;
+                    }
+                }
+            }
+
+            device.queued--;
+            device.free_slots--;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<Task> read_task(const Task& task)
+    {
+        std::vector<Task> subtasks;
+
+        const std::shared_ptr<const DirListing> listing = m_cache.list(task.path);
+        for (const DirEntry& entry : *listing) {
+            if (!entry.is_dir)
+                continue;
+
+            QString subdir = task.path % QLatin1Char('/') % entry.name;
+            if (entry.is_symlink) {
+                QMutexLocker lock(&m_links_lock);
+                if (!m_visited_links.insert(subdir, entry))
+                    continue;
+            }
+
+            // NOTE: only linked directories have their device read; the others are
+            // assumed to be on the same device as their parent, mount points aside
+            const quint64 device = (entry.is_symlink && entry.inode) ? entry.device : task.device;
+            subtasks.emplace_back(Task { std::move(subdir), device });
+        }
+
+        return subtasks;
+    }
+};
+
+class PrefetchHelper : public QRunnable {
+public:
+    PrefetchHelper(TreePrefetcher& prefetcher, size_t worker)
+        : m_prefetcher(prefetcher)
+        , m_worker(worker)
+    {}
+
+    void run() override
+    {
+        m_prefetcher.work(m_worker);
+        m_prefetcher.helperFinished();
+    }
+
+private:
+    TreePrefetcher& m_prefetcher;
+    const size_t m_worker;
+};
+} // namespace
+
+
+DirListingCache::DirListingCache() = default;
+
+std::shared_ptr<const DirListing> DirListingCache::list(const QString& dir_path)
+{
+    {
+        QReadLocker lock(&m_lock);
+        const auto it = m_listings.find(dir_path);
+        if (it != m_listings.cend())
+            return it->second;
+    }
+
+    // NOTE: read without holding the lock; if another thread
+    // does the same meanwhile, the first result is kept
+    std::shared_ptr<const DirListing> listing = std::make_shared<DirListing>(read_dir(dir_path));
+
+    QWriteLocker lock(&m_lock);
+    return m_listings.emplace(dir_path, std::move(listing)).first->second;
+}
+
+std::vector<QString> DirListingCache::findDirs(const QString& dir_path)
+{
+    std::vector<QString> result;
+    LinkedDirSet visited_links;
+
+    std::vector<QString> pending { dir_path };
+    while (!pending.empty()) {
+        QString dir = std::move(pending.back());
+        pending.pop_back();
+
+        // the subdirectories are pushed in reverse, to be visited in the listing order
+        const std::shared_ptr<const DirListing> listing = list(dir);
+        for (auto it = listing->crbegin(); it != listing->crend(); ++it) {
+            if (!it->is_dir)
+                continue;
+
+            QString subdir = dir % QLatin1Char('/') % it->name;
+            if (it->is_symlink && !visited_links.insert(subdir, *it))
+                continue;
+            pending.emplace_back(std::move(subdir));
+        }
+
+        result.emplace_back(std::move(dir));
+    }
+
+    return result;
+}
+
+void DirListingCache::prefetch(const std::vector<QString>& dir_paths)
+{
+    QThreadPool* const pool = QThreadPool::globalInstance();
+    const size_t worker_count = static_cast<size_t>(std::max(pool->maxThreadCount(), 1));
+
+    TreePrefetcher prefetcher(*this, worker_count);
+    for (const QString& dir_path : dir_paths)
+        prefetcher.addRoot(dir_path);
+
+    // NOTE: the calling thread also works, so if no helpers can be
+    // started (eg. the pool is busy), the trees are still read
+    for (size_t worker = 1; worker < worker_count; worker++) {
+        if (pool->tryStart(new PrefetchHelper(prefetcher, worker)))
+            prefetcher.helperStarted();
+    }
+    prefetcher.work(0);
+    prefetcher.waitForHelpers();
+}
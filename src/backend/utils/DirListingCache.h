@@ -0,0 +1,71 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+#include "utils/NoCopyNoMove.h"
+
+#include <QReadWriteLock>
+#include <QString>
+#include <memory>
+#include <vector>
+
+
+/// A file or directory, found in a directory listing
+struct DirEntry {
+    QString name;
+    // NOTE: when the type of the entry can be known without reading its status
+    // (eg. on Linux), these are not filled, and set to -1 (or 0 for the ids)
+    qint64 size;
+    qint64 mtime; ///< in milliseconds since the epoch
+    quint64 device;
+    quint64 inode;
+    bool is_dir;
+    bool is_symlink;
+};
+using DirListing = std::vector<DirEntry>;
+
+
+/// Lists directories, with each directory read from the disk only once.
+/// Meant to be shared by everything during a search. Thread safe.
+class DirListingCache {
+public:
+    DirListingCache();
+    NO_COPY_NO_MOVE(DirListingCache)
+
+    /// Returns the regular files and directories in the directory, except the
+    /// hidden ones, with symlinks followed. The list is empty if the directory
+    /// doesn't exist. On Linux, the directory is read with `getdents64` and the
+    /// entries are only checked one by one if their type is not known from that.
+    std::shared_ptr<const DirListing> list(const QString& dir_path);
+
+    /// Returns the directory and all of its subdirectories recursively, with
+    /// symlinks followed (but each linked directory visited only once)
+    std::vector<QString> findDirs(const QString& dir_path);
+
+    /// Reads the directory trees into the cache in parallel, so that walking them
+    /// later with `findDirs` and `list` does not touch the disk. The number of
+    /// directories read at the same time is limited per device (eg. spinning
+    /// disks are read one directory at a time).
+    void prefetch(const std::vector<QString>& dir_paths);
+
+private:
+    QReadWriteLock m_lock;
+    HashMap<QString, std::shared_ptr<const DirListing>> m_listings;
+};
@@ -0,0 +1,501 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <QtGlobal>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace flat_hash {
+
+/// Each slot of the table has a control byte: the lowest 7 bits of the hash
+/// if it's in use, or one of the negative special values otherwise
+using ctrl_t = signed char;
+constexpr ctrl_t CTRL_EMPTY = -128;
+constexpr ctrl_t CTRL_DELETED = -2;
+
+/// Spreads the bits of the hash, so even the identity hash of small integers
+/// or enums produces usable group positions and control bytes
+inline quint64 mix(std::size_t hash)
+{
+    quint64 h = static_cast<quint64>(hash);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    return h;
+}
+
+/// The positions of the matching slots in a group
+class BitMask {
+public:
+    BitMask(quint64 mask, int shift) : m_mask(mask), m_shift(shift) {}
+
+    explicit operator bool() const { return m_mask != 0; }
+    size_t lowest() const { return qCountTrailingZeroBits(m_mask) >> m_shift; }
+    void removeLowest() { m_mask &= m_mask - 1; }
+
+private:
+    quint64 m_mask;
+    int m_shift;
+};
+
+#ifdef FLAT_HASH_SSE2
+constexpr size_t GROUP_WIDTH = 16;
+
+/// The control bytes of a group of slots, compared at once with SSE2
+struct Group {
+    explicit Group(const ctrl_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)))
+    {}
+
+    BitMask match(ctrl_t h2) const {
+        const __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl);
+        return BitMask(static_cast<quint32>(_mm_movemask_epi8(matches)), 0);
+    }
+    BitMask matchEmpty() const {
+        return match(CTRL_EMPTY);
+    }
+    BitMask matchEmptyOrDeleted() const {
+        return BitMask(static_cast<quint32>(_mm_movemask_epi8(ctrl)), 0);
+    }
+
+    __m128i ctrl;
+};
+#else
+constexpr size_t GROUP_WIDTH = 8;
+
+/// The control bytes of a group of slots, compared at once as a 64-bit word
+struct Group {
+    static constexpr quint64 LSBS = Q_UINT64_C(0x0101010101010101);
+    static constexpr quint64 MSBS = Q_UINT64_C(0x8080808080808080);
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl(qFromLittleEndian<quint64>(pos))
+    {}
+
+    // NOTE: may report false positives, but those are filtered out by the key comparison
+    BitMask match(ctrl_t h2) const {
+        const quint64 x = ctrl ^ (LSBS * static_cast<quint8>(h2));
+        return BitMask((x - LSBS) & ~x & MSBS, 3);
+    }
+    BitMask matchEmpty() const {
+        return BitMask(ctrl & (~ctrl << 6) & MSBS, 3);
+    }
+    BitMask matchEmptyOrDeleted() const {
+        return BitMask(ctrl & MSBS, 3);
+    }
+
+    quint64 ctrl;
+};
+#endif
+
+/// The number of entries a table of the given capacity may hold (7/8)
+inline size_t max_load(size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+/// The smallest capacity that can hold the given number of entries
+inline size_t capacity_for(size_t count)
+{
+    size_t capacity = GROUP_WIDTH;
+    while (max_load(capacity) < count)
+        capacity *= 2;
+
+    return capacity;
+}
+
+} // namespace flat_hash
+
+
+/// An open addressing hash table with flat storage, in the style of Abseil's
+/// SwissTable. Entries are looked up by comparing the control bytes of a whole
+/// group of slots at once, so a lookup usually touches a single cache line.
+///
+/// The interface follows std::unordered_map, with the following differences:
+/// - rehashing moves the entries, invalidating all references and iterators
+///   to them (erasing only invalidates the erased entry)
+/// - find(), count() and at() accept any type the hasher and the key
+///   comparison supports, eg. QStringRef for QString keys
+template <typename Key, typename Val, typename Hash>
+class FlatHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = Val;
+    using value_type = std::pair<const Key, Val>;
+    using size_type = size_t;
+    using hasher = Hash;
+
+    template <typename V>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::remove_const<V>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        Iterator() : m_ctrl(nullptr), m_ctrl_end(nullptr), m_slot(nullptr) {}
+        template <typename U, typename = typename std::enable_if<std::is_convertible<U*, V*>::value>::type>
+        Iterator(const Iterator<U>& other)
+            : m_ctrl(other.m_ctrl), m_ctrl_end(other.m_ctrl_end), m_slot(other.m_slot)
+        {}
+
+        reference operator*() const { return *m_slot; }
+        pointer operator->() const { return m_slot; }
+
+        Iterator& operator++() {
+            ++m_ctrl;
+            ++m_slot;
+            skipFreeSlots();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator prev(*this);
+            ++*this;
+            return prev;
+        }
+
+        template <typename U>
+        bool operator==(const Iterator<U>& other) const { return m_slot == other.m_slot; }
+        template <typename U>
+        bool operator!=(const Iterator<U>& other) const { return m_slot != other.m_slot; }
+
+    private:
+        friend class FlatHashMap;
+        template <typename> friend class Iterator;
+
+        Iterator(const flat_hash::ctrl_t* ctrl, const flat_hash::ctrl_t* ctrl_end, V* slot)
+            : m_ctrl(ctrl), m_ctrl_end(ctrl_end), m_slot(slot)
+        {}
+
+        void skipFreeSlots() {
+            while (m_ctrl != m_ctrl_end && *m_ctrl < 0) {
+                ++m_ctrl;
+                ++m_slot;
+            }
+        }
+
+        const flat_hash::ctrl_t* m_ctrl;
+        const flat_hash::ctrl_t* m_ctrl_end;
+        V* m_slot;
+    };
+
+    using iterator = Iterator<value_type>;
+    using const_iterator = Iterator<const value_type>;
+
+
+    FlatHashMap()
+        : m_ctrl(nullptr)
+        , m_slots(nullptr)
+        , m_capacity(0)
+        , m_size(0)
+        , m_growth_left(0)
+    {}
+    FlatHashMap(std::initializer_list<value_type> entries)
+        : FlatHashMap()
+    {
+        reserve(entries.size());
+        for (const value_type& entry : entries)
+            emplace(entry.first, entry.second);
+    }
+    FlatHashMap(const FlatHashMap& other)
+        : FlatHashMap()
+    {
+        m_hash = other.m_hash;
+        reserve(other.m_size);
+        for (const value_type& entry : other)
+            emplace(entry.first, entry.second);
+    }
+    FlatHashMap(FlatHashMap&& other)
+        : FlatHashMap()
+    {
+        swap(other);
+    }
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            FlatHashMap copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    FlatHashMap& operator=(FlatHashMap&& other) {
+        FlatHashMap moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+    ~FlatHashMap() {
+        destroyEntries();
+        deallocate(m_ctrl, m_slots);
+    }
+
+    void swap(FlatHashMap& other) {
+        std::swap(m_ctrl, other.m_ctrl);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_growth_left, other.m_growth_left);
+        std::swap(m_hash, other.m_hash);
+    }
+
+
+    iterator begin() { return iteratorFrom(0); }
+    iterator end() { return iteratorAt(m_capacity); }
+    const_iterator begin() const { return iteratorFrom(0); }
+    const_iterator end() const { return iteratorAt(m_capacity); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    void reserve(size_t count) {
+        const size_t capacity = flat_hash::capacity_for(count);
+        if (m_capacity < capacity)
+            rehash(capacity);
+    }
+    void clear() {
+        destroyEntries();
+        if (m_capacity)
+            std::memset(m_ctrl, flat_hash::CTRL_EMPTY, m_capacity);
+        m_size = 0;
+        m_growth_left = flat_hash::max_load(m_capacity);
+    }
+
+
+    template <typename K>
+    iterator find(const K& key) { return iteratorAt(findIndex(key)); }
+    template <typename K>
+    const_iterator find(const K& key) const { return iteratorAt(findIndex(key)); }
+    template <typename K>
+    size_t count(const K& key) const { return findIndex(key) != m_capacity ? 1 : 0; }
+
+    template <typename K>
+    Val& at(const K& key) {
+        const size_t idx = findIndex(key);
+        Q_ASSERT(idx != m_capacity);
+        return m_slots[idx].second;
+    }
+    template <typename K>
+    const Val& at(const K& key) const {
+        const size_t idx = findIndex(key);
+        Q_ASSERT(idx != m_capacity);
+        return m_slots[idx].second;
+    }
+
+    Val& operator[](const Key& key) { return emplace(key).first->second; }
+    Val& operator[](Key&& key) { return emplace(std::move(key)).first->second; }
+
+    /// Constructs a new entry from the arguments, unless the key already exists
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> emplace(K&& key, Args&&... args) {
+        const quint64 hash = flat_hash::mix(m_hash(key));
+        const size_t found_idx = findIndex(key, hash);
+        if (found_idx != m_capacity)
+            return { iteratorAt(found_idx), false };
+
+        const size_t idx = prepareInsert(hash);
+        new (m_slots + idx) value_type(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        return { iteratorAt(idx), true };
+    }
+
+    size_t erase(const Key& key) {
+        const size_t idx = findIndex(key);
+        if (idx == m_capacity)
+            return 0;
+
+        eraseAt(idx);
+        return 1;
+    }
+    iterator erase(const_iterator pos) {
+        const size_t idx = static_cast<size_t>(pos.m_slot - m_slots);
+        eraseAt(idx);
+        return iteratorFrom(idx + 1);
+    }
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+private:
+    flat_hash::ctrl_t* m_ctrl;
+    value_type* m_slots;
+    size_t m_capacity;
+    size_t m_size;
+    size_t m_growth_left;
+    Hash m_hash;
+
+    static flat_hash::ctrl_t h2_of(quint64 hash) { return static_cast<flat_hash::ctrl_t>(hash & 0x7F); }
+
+    size_t firstGroupOf(quint64 hash) const { return static_cast<size_t>(hash >> 7) & groupMask(); }
+    size_t groupMask() const { return m_capacity / flat_hash::GROUP_WIDTH - 1; }
+
+    iterator iteratorAt(size_t idx) {
+        return iterator(m_ctrl + idx, m_ctrl + m_capacity, m_slots + idx);
+    }
+    const_iterator iteratorAt(size_t idx) const {
+        return const_iterator(m_ctrl + idx, m_ctrl + m_capacity, m_slots + idx);
+    }
+    iterator iteratorFrom(size_t idx) {
+        iterator it = iteratorAt(idx);
+        it.skipFreeSlots();
+        return it;
+    }
+    const_iterator iteratorFrom(size_t idx) const {
+        const_iterator it = iteratorAt(idx);
+        it.skipFreeSlots();
+        return it;
+    }
+
+    /// Returns the slot index of the key, or the capacity if not found
+    template <typename K>
+    size_t findIndex(const K& key) const {
+        if (m_size == 0)
+            return m_capacity;
+
+        return findIndex(key, flat_hash::mix(m_hash(key)));
+    }
+    // NOTE: the groups are probed quadratically; as their count is a power of two,
+    // all of them are visited eventually, and there is always at least one empty slot
+    template <typename K>
+    size_t findIndex(const K& key, quint64 hash) const {
+        if (m_size == 0)
+            return m_capacity;
+
+        const flat_hash::ctrl_t h2 = h2_of(hash);
+        size_t group = firstGroupOf(hash);
+        for (size_t step = 1; ; step++) {
+            const size_t base = group * flat_hash::GROUP_WIDTH;
+            const flat_hash::Group ctrl_group(m_ctrl + base);
+
+            for (flat_hash::BitMask matches = ctrl_group.match(h2); matches; matches.removeLowest()) {
+                const size_t idx = base + matches.lowest();
+                if (m_slots[idx].first == key)
+                    return idx;
+            }
+            if (ctrl_group.matchEmpty())
+                return m_capacity;
+
+            group = (group + step) & groupMask();
+        }
+    }
+
+    size_t findFreeSlot(quint64 hash) const {
+        size_t group = firstGroupOf(hash);
+        for (size_t step = 1; ; step++) {
+            const size_t base = group * flat_hash::GROUP_WIDTH;
+            const flat_hash::BitMask free_slots = flat_hash::Group(m_ctrl + base).matchEmptyOrDeleted();
+            if (free_slots)
+                return base + free_slots.lowest();
+
+            group = (group + step) & groupMask();
+        }
+    }
+
+    /// Reserves a slot for a new entry with the hash, growing the table if necessary
+    size_t prepareInsert(quint64 hash) {
+        if (m_capacity == 0)
+            rehash(flat_hash::capacity_for(1));
+
+        size_t idx = findFreeSlot(hash);
+        if (m_growth_left == 0 && m_ctrl[idx] != flat_hash::CTRL_DELETED) {
+            // drop the deleted slots if there are many, otherwise grow
+            size_t capacity = flat_hash::capacity_for(m_size + 1);
+            if (capacity <= m_capacity && m_size + 1 > flat_hash::max_load(m_capacity) / 2)
+                capacity = m_capacity * 2;
+
+            rehash(capacity);
+            idx = findFreeSlot(hash);
+        }
+
+        if (m_ctrl[idx] == flat_hash::CTRL_EMPTY)
+            m_growth_left--;
+
+        m_ctrl[idx] = h2_of(hash);
+        m_size++;
+        return idx;
+    }
+
+    void eraseAt(size_t idx) {
+        Q_ASSERT(idx < m_capacity && m_ctrl[idx] >= 0);
+        m_slots[idx].~value_type();
+        m_size--;
+
+        // NOTE: if the group still has an empty slot, no probe went past it,
+        // so the slot can become empty again instead of a tombstone
+        const size_t base = idx - idx % flat_hash::GROUP_WIDTH;
+        if (flat_hash::Group(m_ctrl + base).matchEmpty()) {
+            m_ctrl[idx] = flat_hash::CTRL_EMPTY;
+            m_growth_left++;
+        }
+        else {
+            m_ctrl[idx] = flat_hash::CTRL_DELETED;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        Q_ASSERT(flat_hash::max_load(capacity) >= m_size);
+
+        flat_hash::ctrl_t* const old_ctrl = m_ctrl;
+        value_type* const old_slots = m_slots;
+        const size_t old_capacity = m_capacity;
+
+        m_ctrl = new flat_hash::ctrl_t[capacity];
+        m_slots = static_cast<value_type*>(::operator new(capacity * sizeof(value_type)));
+        m_capacity = capacity;
+        m_growth_left = flat_hash::max_load(capacity) - m_size;
+        std::memset(m_ctrl, flat_hash::CTRL_EMPTY, capacity);
+
+        for (size_t old_idx = 0; old_idx < old_capacity; old_idx++) {
+            if (old_ctrl[old_idx] < 0)
+                continue;
+
+            value_type& entry = old_slots[old_idx];
+            const quint64 hash = flat_hash::mix(m_hash(entry.first));
+            const size_t idx = findFreeSlot(hash);
+            m_ctrl[idx] = h2_of(hash);
+            new (m_slots + idx) value_type(std::move(entry));
+            entry.~value_type();
+        }
+
+        deallocate(old_ctrl, old_slots);
+    }
+
+    void destroyEntries() {
+        for (size_t idx = 0; idx < m_capacity; idx++) {
+            if (m_ctrl[idx] >= 0)
+                m_slots[idx].~value_type();
+        }
+    }
+
+    static void deallocate(flat_hash::ctrl_t* ctrl, value_type* slots) {
+        delete[] ctrl;
+        ::operator delete(slots);
+    }
+};
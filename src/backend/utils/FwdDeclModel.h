@@ -20,3 +20,5 @@
 namespace model { class Collection; }
 namespace model { class Game; }
 namespace model { class GameFile; }
+namespace model { class GameList; }
+namespace model { class Library; }
@@ -17,27 +17,83 @@
 
 #pragma once
 
-#include <QHash>
+#include "utils/FlatHashMap.h"
+
 #include <QString>
-#include <unordered_map>
+#include <QStringRef>
+#include <functional>
 
 
-// std::unordered_map is too verbose
 template <typename Key, typename Val, typename Hash = std::hash<Key>>
-using HashMap = std::unordered_map<Key, Val, Hash>;
+using HashMap = FlatHashMap<Key, Val, Hash>;
 
 // hash for strings
-namespace std {
-    template<> struct hash<QString> {
-        std::size_t operator()(const QString& s) const {
-            return qHash(s);
+namespace flat_hash {
+inline quint64 hash_block(quint64 h, quint64 block)
+{
+    h = (h ^ block) * Q_UINT64_C(0x9E3779B97F4A7C15);
+    return h ^ (h >> 29);
+}
+
+/// Hashes the UTF-16 code units of the string, four at a time.
+/// Strings of the same content produce the same hash, regardless of their type.
+inline std::size_t hash_chars(const ushort* data, int len)
+{
+    quint64 h = static_cast<quint64>(len);
+    int i = 0;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    for (; i + 4 <= len; i += 4) {
+        quint64 block;
+        std::memcpy(&block, data + i, sizeof(block));
+        h = hash_block(h, block);
+    }
+#endif
+    quint64 tail = 0;
+    for (int shift = 0; i < len; i++, shift += 16) {
+        tail |= static_cast<quint64>(data[i]) << shift;
+        if (shift == 48) {
+            h = hash_block(h, tail);
+            tail = 0;
+            shift = -16;
         }
-    };
-    template<> struct hash<QLatin1String> {
-        std::size_t operator()(const QLatin1String& s) const {
-            return qHash(s);
+    }
+    return static_cast<std::size_t>(hash_block(h, tail));
+}
+inline std::size_t hash_chars(const char* latin1_data, int len)
+{
+    const auto data = reinterpret_cast<const uchar*>(latin1_data);
+
+    quint64 h = static_cast<quint64>(len);
+    quint64 tail = 0;
+    for (int i = 0, shift = 0; i < len; i++, shift += 16) {
+        tail |= static_cast<quint64>(data[i]) << shift;
+        if (shift == 48) {
+            h = hash_block(h, tail);
+            tail = 0;
+            shift = -16;
         }
-    };
+    }
+    return static_cast<std::size_t>(hash_block(h, tail));
+}
+
+/// Hash for all kinds of strings, to allow lookups without creating a QString
+struct StringHash {
+    // NOTE: not `utf16()`, which would detach raw data strings to add a terminator
+    std::size_t operator()(const QString& s) const {
+        return hash_chars(reinterpret_cast<const ushort*>(s.unicode()), s.size());
+    }
+    std::size_t operator()(const QStringRef& s) const {
+        return hash_chars(reinterpret_cast<const ushort*>(s.unicode()), s.size());
+    }
+    std::size_t operator()(QLatin1String s) const {
+        return hash_chars(s.data(), s.size());
+    }
+};
+} // namespace flat_hash
+
+namespace std {
+    template<> struct hash<QString> : flat_hash::StringHash {};
+    template<> struct hash<QLatin1String> : flat_hash::StringHash {};
 }
 
 // hash for enum classes
@@ -0,0 +1,71 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "PathCache.h"
+
+#include "utils/DirListingCache.h"
+
+#include <QStringBuilder>
+
+
+PathCache::PathCache() = default;
+
+QString PathCache::canonicalDir(const QString& dir_path)
+{
+    {
+        QReadLocker lock(&m_lock);
+        const auto it = m_dirs.find(dir_path);
+        if (it != m_dirs.cend())
+            return it->second;
+    }
+
+    // NOTE: resolved without holding the lock; if another thread
+    // does the same meanwhile, the first result is kept
+    QString canonical_path = QFileInfo(dir_path).canonicalFilePath();
+
+    QWriteLocker lock(&m_lock);
+    return m_dirs.emplace(dir_path, std::move(canonical_path)).first->second;
+}
+
+QString PathCache::pathInCanonicalDir(const QString& dir_path, const QString& file_name)
+{
+    const QString canonical_dir = canonicalDir(dir_path);
+    if (canonical_dir.isEmpty())
+        return QString();
+
+    return canonical_dir.endsWith(QLatin1Char('/'))
+        ? canonical_dir % file_name
+        : canonical_dir % QLatin1Char('/') % file_name;
+}
+
+QString PathCache::canonicalFilePath(const QFileInfo& finfo)
+{
+    // symlinks resolve to the path of their target
+    if (finfo.isSymLink())
+        return finfo.canonicalFilePath();
+    if (!finfo.exists())
+        return QString();
+
+    return pathInCanonicalDir(finfo.absolutePath(), finfo.fileName());
+}
+
+QString PathCache::canonicalFilePath(const QString& dir_path, const DirEntry& entry)
+{
+    if (entry.is_symlink)
+        return QFileInfo(dir_path % QLatin1Char('/') % entry.name).canonicalFilePath();
+
+    return pathInCanonicalDir(dir_path, entry.name);
+}
@@ -0,0 +1,49 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "utils/HashMap.h"
+#include "utils/NoCopyNoMove.h"
+
+#include <QFileInfo>
+#include <QReadWriteLock>
+#include <QString>
+
+struct DirEntry;
+
+/// Resolves canonical paths, with each directory resolved only once.
+/// Meant to be shared by everything during a search. Thread safe.
+class PathCache {
+public:
+    PathCache();
+    NO_COPY_NO_MOVE(PathCache)
+
+    /// Returns the canonical path of the directory, or an empty string if it doesn't exist
+    QString canonicalDir(const QString& dir_path);
+    /// Returns the same as QFileInfo::canonicalFilePath, but resolves only
+    /// the file itself, using the cached path of its directory
+    QString canonicalFilePath(const QFileInfo&);
+    /// Same as above, for an entry of a directory listing. As the entry exists
+    /// and its type is already known, only symlinks are looked up on the disk.
+    QString canonicalFilePath(const QString& dir_path, const DirEntry&);
+
+private:
+    QReadWriteLock m_lock;
+    HashMap<QString, QString> m_dirs;
+
+    QString pathInCanonicalDir(const QString& dir_path, const QString& file_name);
+};
@@ -0,0 +1,101 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "StringPool.h"
+
+#include <QMutexLocker>
+
+
+namespace {
+qint64 allocation_size(const QString& str)
+{
+    return static_cast<qint64>(sizeof(QString::Data))
+         + static_cast<qint64>(str.capacity() + 1) * static_cast<qint64>(sizeof(QChar));
+}
+
+qint64 allocation_size(const QStringList& list)
+{
+    // NOTE: the internals of QList are private, this is an estimation
+    constexpr qint64 HEADER_SIZE = 16;
+    return HEADER_SIZE + static_cast<qint64>(list.size()) * static_cast<qint64>(sizeof(void*));
+}
+} // namespace
+
+
+StringPool::StringPool()
+    : m_saved_bytes(0)
+{}
+
+void StringPool::intern(QString& str)
+{
+    QMutexLocker lock(&m_lock);
+    internString(str);
+}
+
+void StringPool::internString(QString& str)
+{
+    if (str.isEmpty())
+        return;
+
+    const auto it = m_strings.constFind(str);
+    if (it == m_strings.cend()) {
+        m_strings.insert(str);
+        return;
+    }
+
+    // already shared
+    if (it->constData() == str.constData())
+        return;
+
+    if (str.isDetached())
+        m_saved_bytes += allocation_size(str);
+    str = *it;
+}
+
+void StringPool::intern(QStringList& list)
+{
+    if (list.isEmpty())
+        return;
+
+    QMutexLocker lock(&m_lock);
+
+    const auto it = m_lists.constFind(list);
+    if (it != m_lists.cend()) {
+        if (it->constBegin() != list.constBegin()) {
+            if (list.isDetached()) {
+                for (const QString& str : qAsConst(list)) {
+                    if (str.isDetached())
+                        m_saved_bytes += allocation_size(str);
+                }
+            }
+            if (list.isDetached())
+                m_saved_bytes += allocation_size(list);
+            list = *it;
+        }
+        return;
+    }
+
+    for (QString& str : list)
+        internString(str);
+
+    m_lists.insert(list);
+}
+
+qint64 StringPool::savedBytes() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_saved_bytes;
+}
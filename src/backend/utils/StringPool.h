@@ -0,0 +1,49 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "utils/NoCopyNoMove.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+
+/// Makes equal strings share the same memory, by replacing them with
+/// a previously stored copy. Thread safe.
+class StringPool {
+public:
+    StringPool();
+    NO_COPY_NO_MOVE(StringPool)
+
+    /// Replaces the value with its pooled copy, or adds it to the pool
+    void intern(QString&);
+    /// Interns the list itself, as well as each of its items
+    void intern(QStringList&);
+
+    /// Approximate number of bytes freed by the interning so far
+    qint64 savedBytes() const;
+
+private:
+    mutable QMutex m_lock;
+    QSet<QString> m_strings;
+    QSet<QStringList> m_lists;
+    qint64 m_saved_bytes;
+
+    void internString(QString&);
+};
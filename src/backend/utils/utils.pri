@@ -1,20 +1,29 @@
 HEADERS += \
+    $$PWD/Collation.h \
+    $$PWD/DirListingCache.h \
     $$PWD/FwdDeclModelData.h \
+    $$PWD/FlatHashMap.h \
     $$PWD/HashMap.h \
     $$PWD/FwdDeclModel.h \
     $$PWD/FolderListModel.h \
     $$PWD/MoveOnly.h \
     $$PWD/NoCopyNoMove.h \
     $$PWD/StrBoolConverter.h \
+    $$PWD/PathCache.h \
     $$PWD/PathCheck.h \
     $$PWD/FakeQKeyEvent.h \
     $$PWD/KeySequenceTools.h \
     $$PWD/QmlHelpers.h \
-    $$PWD/StdHelpers.h
+    $$PWD/StdHelpers.h \
+    $$PWD/StringPool.h
 
 SOURCES += \
+    $$PWD/Collation.cpp \
+    $$PWD/DirListingCache.cpp \
     $$PWD/FolderListModel.cpp \
     $$PWD/StrBoolConverter.cpp \
+    $$PWD/PathCache.cpp \
     $$PWD/PathCheck.cpp \
     $$PWD/FakeQKeyEvent.cpp \
     $$PWD/KeySequenceTools.cpp \
+    $$PWD/StringPool.cpp \
@@ -1,6 +1,6 @@
 # Link the project that includes this file to the Backend
 
-QT *= qml quick multimedia gamepad svg sql
+QT *= qml quick multimedia gamepad svg sql concurrent
 CONFIG += c++11 warn_on
 
 win32: LIBS += -luser32 -ladvapi32
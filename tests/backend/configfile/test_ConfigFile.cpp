@@ -30,6 +30,8 @@ private slots:
     void empty();
     void datablob();
     void file();
+    void file_unicode();
+    void file_sameAsStream();
 
     void merge_lines();
 
@@ -114,6 +116,64 @@ void test_ConfigFile::file()
     QCOMPARE(m_entries.size(), expected.size());
 }
 
+void test_ConfigFile::file_unicode()
+{
+    m_entries.clear();
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("\xEF\xBB\xBF" "key: \xC3\xA1rv\xC3\xADzt\xC5\xB1r\xC5\x91\r\n"
+               "  second line\r\n"
+               "\xC2\xA0\r\n"
+               "KEY2 :value\r\n"
+               "  .\r\n"
+               "  last");
+    file.close();
+
+    QVERIFY(config::readFile(file.fileName(),
+        [this](const config::Entry& entry){ this->onAttributeFound(entry); },
+        [this](const config::Error& error){ this->onError(error); }));
+
+    QCOMPARE(m_entries.size(), static_cast<size_t>(2));
+    QCOMPARE(m_entries.at(0).line, 1);
+    QCOMPARE(m_entries.at(0).key, QStringLiteral("key"));
+    QCOMPARE(m_entries.at(0).values, QVector<QString>({ QString::fromUtf8("\xC3\xA1rv\xC3\xADzt\xC5\xB1r\xC5\x91"), "second line" }));
+    QCOMPARE(m_entries.at(1).line, 4);
+    QCOMPARE(m_entries.at(1).key, QStringLiteral("key2"));
+    QCOMPARE(m_entries.at(1).values, QVector<QString>({ "value", "\n", "last" }));
+}
+
+void test_ConfigFile::file_sameAsStream()
+{
+    m_entries.clear();
+
+    QTest::ignoreMessage(QtWarningMsg, "line 3: line starts with whitespace, but no attribute has been defined yet");
+    QTest::ignoreMessage(QtWarningMsg, "line 8: attribute value missing, entry ignored");
+    QTest::ignoreMessage(QtWarningMsg, "line 9: line invalid, skipped");
+    QTest::ignoreMessage(QtWarningMsg, "line 23: line starts with whitespace, but no attribute has been defined yet");
+    QFile file(":/test.cfg");
+    QVERIFY(file.open(QFile::ReadOnly | QFile::Text));
+    QTextStream stream(&file);
+    readStream(stream);
+    const decltype(m_entries) stream_entries = std::move(m_entries);
+    m_entries.clear();
+
+    QTest::ignoreMessage(QtWarningMsg, "line 3: line starts with whitespace, but no attribute has been defined yet");
+    QTest::ignoreMessage(QtWarningMsg, "line 8: attribute value missing, entry ignored");
+    QTest::ignoreMessage(QtWarningMsg, "line 9: line invalid, skipped");
+    QTest::ignoreMessage(QtWarningMsg, "line 23: line starts with whitespace, but no attribute has been defined yet");
+    config::readFile(":/test.cfg",
+        [this](const config::Entry& entry){ this->onAttributeFound(entry); },
+        [this](const config::Error& error){ this->onError(error); });
+
+    QCOMPARE(m_entries.size(), stream_entries.size());
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        QCOMPARE(m_entries.at(i).line, stream_entries.at(i).line);
+        QCOMPARE(m_entries.at(i).key, stream_entries.at(i).key);
+        QCOMPARE(m_entries.at(i).values, stream_entries.at(i).values);
+    }
+}
+
 void test_ConfigFile::merge_lines()
 {
     QCOMPARE(config::mergeLines({}), QString());
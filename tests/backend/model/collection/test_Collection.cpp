@@ -19,6 +19,7 @@
 
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/Library.h"
 
 
 class test_Collection : public QObject {
@@ -34,7 +35,8 @@ void test_Collection::names()
     modeldata::Collection modeldata("myname");
     modeldata.setShortName("abbrev");
     modeldata.launch_cmd = "runner";
-    model::Collection collection(std::move(modeldata));
+    model::Library library;
+    model::Collection collection(std::move(modeldata), library);
     collection.setGameList({});
 
     // the properties are read-only and should be called only after the initial setup
@@ -44,19 +46,22 @@ void test_Collection::names()
 
 void test_Collection::games()
 {
-    QVector<model::Game*> games = {
-        new model::Game(modeldata::Game(QFileInfo("a")), this),
-        new model::Game(modeldata::Game(QFileInfo("b")), this),
-        new model::Game(modeldata::Game(QFileInfo("c")), this),
-    };
-    model::Collection collection(modeldata::Collection("test"));
-    collection.setGameList(std::move(games));
+    modeldata::GameStore store;
+    store.append(modeldata::Game(QFileInfo("a")));
+    store.append(modeldata::Game(QFileInfo("b")));
+    store.append(modeldata::Game(QFileInfo("c")));
+
+    model::Library library;
+    library.replaceStore(std::move(store), {});
+
+    model::Collection collection(modeldata::Collection("test"), library);
+    collection.setGameList({ 0, 1, 2 });
 
     // matching count and sorted by title
-    QCOMPARE(collection.games()->count(), 3);
-    QCOMPARE(collection.games()->at(0)->title(), QStringLiteral("a"));
-    QCOMPARE(collection.games()->at(1)->title(), QStringLiteral("b"));
-    QCOMPARE(collection.games()->at(2)->title(), QStringLiteral("c"));
+    QCOMPARE(collection.games().count(), 3);
+    QCOMPARE(collection.games().at(0)->title(), QStringLiteral("a"));
+    QCOMPARE(collection.games().at(1)->title(), QStringLiteral("b"));
+    QCOMPARE(collection.games().at(2)->title(), QStringLiteral("c"));
 }
 
 
@@ -18,6 +18,18 @@
 #include <QtTest/QtTest>
 
 #include "model/gaming/Game.h"
+#include "model/gaming/Library.h"
+
+
+namespace {
+model::Game* create_game(model::Library& library, modeldata::Game gamedata)
+{
+    modeldata::GameStore store;
+    store.append(std::move(gamedata));
+    library.replaceStore(std::move(store), {});
+    return library.game(0);
+}
+} // namespace
 
 
 class test_Game : public QObject {
@@ -44,10 +56,11 @@ void testStrAndList(std::function<void(modeldata::Game&, const QString&)> fn_add
     fn_add(modeldata, "test2");
     fn_add(modeldata, "test3");
 
-    model::Game game(std::move(modeldata));
+    model::Library library;
+    model::Game* const game = create_game(library, std::move(modeldata));
 
-    QCOMPARE(game.property(str_name).toString(), QStringLiteral("test1, test2, test3"));
-    QCOMPARE(game.property(list_name).toStringList(), QStringList({"test1", "test2", "test3"}));
+    QCOMPARE(game->property(str_name).toString(), QStringLiteral("test1, test2, test3"));
+    QCOMPARE(game->property(list_name).toStringList(), QStringList({"test1", "test2", "test3"}));
 }
 
 void test_Game::developers()
@@ -73,10 +86,11 @@ void test_Game::release()
     modeldata::Game modeldata("test");
     modeldata.release_date = QDate(1999,1,2);
 
-    model::Game game(std::move(modeldata));
-    QCOMPARE(game.property("releaseYear").toInt(), 1999);
-    QCOMPARE(game.property("releaseMonth").toInt(), 1);
-    QCOMPARE(game.property("releaseDay").toInt(), 2);
+    model::Library library;
+    model::Game* const game = create_game(library, std::move(modeldata));
+    QCOMPARE(game->property("releaseYear").toInt(), 1999);
+    QCOMPARE(game->property("releaseMonth").toInt(), 1);
+    QCOMPARE(game->property("releaseDay").toInt(), 2);
 }
 
 void test_Game::files()
@@ -84,23 +98,25 @@ void test_Game::files()
     modeldata::Game gamedata("test");
     gamedata.files.emplace_back(QFileInfo("test1"));
     gamedata.files.emplace_back(QFileInfo("test2"));
-    model::Game game(std::move(gamedata));
+    model::Library library;
+    model::Game* const game = create_game(library, std::move(gamedata));
 
-    QCOMPARE(game.files()->count(), 2);
-    QCOMPARE(game.files()->get(0)->property("name").toString(), QStringLiteral("test1"));
-    QCOMPARE(game.files()->get(1)->property("name").toString(), QStringLiteral("test2"));
+    QCOMPARE(game->files()->count(), 2);
+    QCOMPARE(game->files()->get(0)->property("name").toString(), QStringLiteral("test1"));
+    QCOMPARE(game->files()->get(1)->property("name").toString(), QStringLiteral("test2"));
 }
 
 void test_Game::launchSingle()
 {
     modeldata::Game gamedata("test");
     gamedata.files.emplace_back(QFileInfo("test"));
-    model::Game game(std::move(gamedata));
+    model::Library library;
+    model::Game* const game = create_game(library, std::move(gamedata));
 
-    QSignalSpy spy_launch(game.files()->first(), &model::GameFile::launchRequested);
+    QSignalSpy spy_launch(game->files()->first(), &model::GameFile::launchRequested);
     QVERIFY(spy_launch.isValid());
 
-    QMetaObject::invokeMethod(&game, "launch");
+    QMetaObject::invokeMethod(game, "launch");
     QVERIFY(spy_launch.count() == 1 || spy_launch.wait());
 }
 
@@ -109,12 +125,13 @@ void test_Game::launchMulti()
     modeldata::Game gamedata("test");
     gamedata.files.emplace_back(QFileInfo("test1"));
     gamedata.files.emplace_back(QFileInfo("test2"));
-    model::Game game(std::move(gamedata));
+    model::Library library;
+    model::Game* const game = create_game(library, std::move(gamedata));
 
-    QSignalSpy spy_launch(&game, &model::Game::launchFileSelectorRequested);
+    QSignalSpy spy_launch(game, &model::Game::launchFileSelectorRequested);
     QVERIFY(spy_launch.isValid());
 
-    QMetaObject::invokeMethod(&game, "launch");
+    QMetaObject::invokeMethod(game, "launch");
     QVERIFY(spy_launch.count() == 1 || spy_launch.wait());
 }
 
@@ -0,0 +1,125 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Game.h"
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
+
+
+namespace {
+void fill_library(model::Library& library, const QStringList& titles)
+{
+    modeldata::GameStore store;
+    for (const QString& title : titles)
+        store.append(modeldata::Game(QFileInfo(title)));
+
+    library.replaceStore(std::move(store), {});
+}
+
+QStringList list_titles(const model::GameList& list)
+{
+    QStringList titles;
+    for (int row = 0; row < list.rowCount(); row++)
+        titles << list.data(list.index(row), model::GameList::TitleRole).toString();
+
+    return titles;
+}
+} // namespace
+
+
+class test_GameList : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roles();
+    void insertSorted();
+    void remove();
+    void lazyObjects();
+};
+
+void test_GameList::roles()
+{
+    model::Library library;
+    fill_library(library, { "a", "b" });
+
+    model::GameList list(library);
+    list.setEntries({ 1, 0 });
+
+    QCOMPARE(list.count(), 2);
+    QCOMPARE(list_titles(list), QStringList({ "b", "a" }));
+    QVERIFY(list.roleNames().values().contains("modelData"));
+    QVERIFY(list.roleNames().values().contains("favorite"));
+
+    QVERIFY(list.setData(list.index(0), true, model::GameList::FavoriteRole));
+    QVERIFY(library.store().isFavorite(1));
+    QVERIFY(!library.store().isFavorite(0));
+}
+
+void test_GameList::insertSorted()
+{
+    model::Library library;
+    fill_library(library, { "c", "a", "d", "b" });
+    library.updateSortKeys(QCollator(QLocale::c()), false);
+    const std::vector<quint32> ranks = library.store().titleRanks();
+
+    model::GameList list(library);
+    QSignalSpy spy_count(&list, &model::GameList::countChanged);
+    QVERIFY(spy_count.isValid());
+
+    list.insertEntries({ 1, 0 }, ranks);
+    QCOMPARE(list_titles(list), QStringList({ "a", "c" }));
+
+    list.insertEntries({ 3, 2 }, ranks);
+    QCOMPARE(list_titles(list), QStringList({ "a", "b", "c", "d" }));
+    QVERIFY(spy_count.count() > 0);
+}
+
+void test_GameList::remove()
+{
+    model::Library library;
+    fill_library(library, { "a", "b", "c", "d", "e" });
+
+    model::GameList list(library);
+    list.setEntries({ 0, 1, 2, 3, 4 });
+
+    list.removeEntries([](size_t idx){ return idx == 1 || idx == 2 || idx == 4; });
+    QCOMPARE(list_titles(list), QStringList({ "a", "d" }));
+    QCOMPARE(list.entries(), std::vector<size_t>({ 0, 3 }));
+}
+
+void test_GameList::lazyObjects()
+{
+    model::Library library;
+    fill_library(library, { "a", "b" });
+
+    model::GameList list(library);
+    list.setEntries({ 0, 1 });
+
+    QCOMPARE(library.findChildren<model::Game*>().count(), 0);
+
+    auto game = qobject_cast<model::Game*>(list.get(1));
+    QVERIFY(game);
+    QCOMPARE(game->title(), QStringLiteral("b"));
+    QCOMPARE(list.get(1), game);
+    QCOMPARE(list.indexOf(game), 1);
+    QVERIFY(list.contains(game));
+}
+
+
+QTEST_MAIN(test_GameList)
+#include "test_GameList.moc"
@@ -0,0 +1,193 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <QtTest/QtTest>
+
+#include "modeldata/gaming/GameListSort.h"
+#include "modeldata/gaming/GameStore.h"
+
+
+class test_GameStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundtrip();
+    void emptyFields();
+    void dictionary();
+    void titleRanks();
+    void appendedGames();
+    void sortGameLists();
+    void playStats();
+};
+
+void test_GameStore::roundtrip()
+{
+    modeldata::Game game(QStringLiteral("Test Game"));
+    game.summary = QStringLiteral("summary");
+    game.description = QStringLiteral("description");
+    game.launch_cmd = QStringLiteral("emulator {file.path}");
+    game.launch_workdir = QStringLiteral("/tmp");
+    game.player_count = 4;
+    game.rating = 0.5f;
+    game.release_date = QDate(2000, 1, 2);
+    game.is_favorite = true;
+    game.developers << QStringLiteral("dev A") << QStringLiteral("dev B");
+    game.genres << QStringLiteral("genre");
+    game.files.emplace_back(QFileInfo(QStringLiteral("/dummy/a.ext")));
+    game.files.emplace_back(QFileInfo(QStringLiteral("/dummy/b.ext")));
+    game.files.back().play_count = 3;
+    game.assets.setSingle(AssetType::BOX_FRONT, QStringLiteral("file:///box.png"));
+    game.assets.appendMulti(AssetType::SCREENSHOTS, QStringLiteral("file:///a.png"));
+    game.assets.appendMulti(AssetType::SCREENSHOTS, QStringLiteral("file:///b.png"));
+
+    modeldata::GameStore store;
+    QCOMPARE(store.append(std::move(game)), 0ul);
+    QCOMPARE(store.size(), 1ul);
+
+    modeldata::Game copy = store.game(0);
+    QCOMPARE(copy.title, QStringLiteral("Test Game"));
+    QCOMPARE(copy.summary, QStringLiteral("summary"));
+    QCOMPARE(copy.description, QStringLiteral("description"));
+    QCOMPARE(copy.launch_cmd, QStringLiteral("emulator {file.path}"));
+    QCOMPARE(copy.launch_workdir, QStringLiteral("/tmp"));
+    QCOMPARE(copy.player_count, static_cast<short>(4));
+    QCOMPARE(copy.rating, 0.5f);
+    QCOMPARE(copy.release_date, QDate(2000, 1, 2));
+    QCOMPARE(copy.is_favorite, true);
+    QCOMPARE(copy.developers, QStringList({QStringLiteral("dev A"), QStringLiteral("dev B")}));
+    QCOMPARE(copy.publishers, QStringList());
+    QCOMPARE(copy.genres, QStringList({QStringLiteral("genre")}));
+
+    QCOMPARE(copy.files.size(), 2ul);
+    QCOMPARE(copy.files[0].fileinfo.filePath(), QStringLiteral("/dummy/a.ext"));
+    QCOMPARE(copy.files[1].fileinfo.filePath(), QStringLiteral("/dummy/b.ext"));
+    QCOMPARE(copy.files[0].name, QStringLiteral("a"));
+    QCOMPARE(copy.files[0].play_count, 0);
+    QCOMPARE(copy.files[1].play_count, 3);
+    QVERIFY(!copy.files[1].last_played.isValid());
+
+    QCOMPARE(copy.assets.single(AssetType::BOX_FRONT), QStringLiteral("file:///box.png"));
+    QCOMPARE(copy.assets.multi(AssetType::SCREENSHOTS),
+             QStringList({QStringLiteral("file:///a.png"), QStringLiteral("file:///b.png")}));
+}
+
+void test_GameStore::emptyFields()
+{
+    modeldata::GameStore store;
+    store.append(modeldata::Game(QStringLiteral("first")));
+    store.append(modeldata::Game(QString()));
+    store.append(modeldata::Game(QStringLiteral("third")));
+
+    QCOMPARE(store.title(0), QStringLiteral("first"));
+    QVERIFY(store.title(1).isEmpty());
+    QCOMPARE(store.title(2), QStringLiteral("third"));
+    QVERIFY(store.launchCmd(1).isEmpty());
+    QCOMPARE(store.fileCount(1), 0ul);
+}
+
+void test_GameStore::dictionary()
+{
+    modeldata::DictColumn column;
+    column.append(QStringList({QStringLiteral("a"), QStringLiteral("b")}));
+    column.append(QStringLiteral("b"));
+    column.append(QString());
+    column.append(QStringList({QStringLiteral("a")}));
+
+    QCOMPARE(column.size(), 4ul);
+    QCOMPARE(column.distinctCount(), 2ul);
+    QCOMPARE(column.at(0), QStringList({QStringLiteral("a"), QStringLiteral("b")}));
+    QCOMPARE(column.first(1), QStringLiteral("b"));
+    QCOMPARE(column.count(2), 0);
+    QCOMPARE(column.at(3), QStringList({QStringLiteral("a")}));
+}
+
+void test_GameStore::titleRanks()
+{
+    modeldata::GameStore store;
+    store.append(modeldata::Game(QStringLiteral("c")));
+    store.append(modeldata::Game(QStringLiteral("a")));
+    store.append(modeldata::Game(QStringLiteral("b")));
+    store.append(modeldata::Game(QStringLiteral("a")));
+    store.append(modeldata::Game(QStringLiteral("the b2")));
+
+    store.updateSortKeys(QCollator(QLocale::c()), false);
+    QCOMPARE(store.titleRanks(), std::vector<quint32>({2, 0, 1, 0, 3}));
+
+    // ...and without the articles
+    store.updateSortKeys(QCollator(QLocale::c()), true);
+    QCOMPARE(store.titleRanks(), std::vector<quint32>({3, 0, 1, 0, 2}));
+}
+
+void test_GameStore::appendedGames()
+{
+    const QCollator collator(QLocale::c());
+
+    modeldata::GameStore store;
+    store.append(modeldata::Game(QStringLiteral("c")));
+    store.append(modeldata::Game(QStringLiteral("a")));
+    store.appendSortKeys(collator, false);
+
+    const modeldata::GameStore copy = store.clone();
+
+    store.append(modeldata::Game(QStringLiteral("b")));
+    store.appendSortKeys(collator, false);
+    QCOMPARE(store.titleRanks(), std::vector<quint32>({2, 0, 1}));
+
+    // the copy is not affected
+    QCOMPARE(copy.size(), 2ul);
+    QCOMPARE(copy.title(0), QStringLiteral("c"));
+    QCOMPARE(copy.titleRanks(), std::vector<quint32>({1, 0}));
+}
+
+void test_GameStore::sortGameLists()
+{
+    // titles: c, a, b, a
+    const std::vector<quint32> ranks { 2, 0, 1, 0 };
+    HashMap<QString, std::vector<size_t>> lists {
+        { QStringLiteral("x"), { 0, 1, 2, 0 } },
+        { QStringLiteral("y"), { 3, 2, 1 } },
+        { QStringLiteral("z"), {} },
+    };
+
+    const std::vector<size_t> all_games = modeldata::sort_game_lists(lists, ranks);
+    QCOMPARE(all_games, std::vector<size_t>({1, 3, 2, 0}));
+    QCOMPARE(lists.at(QStringLiteral("x")), std::vector<size_t>({1, 2, 0}));
+    QCOMPARE(lists.at(QStringLiteral("y")), std::vector<size_t>({1, 3, 2}));
+    QVERIFY(lists.at(QStringLiteral("z")).empty());
+}
+
+void test_GameStore::playStats()
+{
+    modeldata::Game game(QFileInfo(QStringLiteral("/dummy/a.ext")));
+
+    modeldata::GameStore store;
+    store.append(std::move(game));
+    QCOMPARE(store.fileCount(0), 1ul);
+
+    const size_t file_idx = store.firstFile(0);
+    const QDateTime now = QDateTime::fromMSecsSinceEpoch(QDateTime::currentMSecsSinceEpoch());
+    store.setPlayStats(file_idx, 2, 60, now);
+
+    QCOMPARE(store.playCount(file_idx), 2);
+    QCOMPARE(store.playTime(file_idx), 60ll);
+    QCOMPARE(store.lastPlayed(file_idx), now);
+    QCOMPARE(store.game(0).files.front().play_time, 60ll);
+}
+
+
+QTEST_MAIN(test_GameStore)
+#include "test_GameStore.moc"
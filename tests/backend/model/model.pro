@@ -4,6 +4,8 @@ SUBDIRS += \
     collection \
     game \
     gameassets \
+    gamelist \
+    gamestore \
     locales \
     memory \
     system \
@@ -0,0 +1,59 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <QtTest/QtTest>
+
+#include "providers/es2/Es2Systems.h"
+
+
+class test_Es2Systems : public QObject {
+    Q_OBJECT
+
+private slots:
+    void extensions_data();
+    void extensions();
+};
+
+void test_Es2Systems::extensions_data()
+{
+    QTest::addColumn<QString>("extensions");
+    QTest::addColumn<QString>("file_name");
+    QTest::addColumn<bool>("matches");
+
+    QTest::newRow("dotted") << QStringLiteral(".iso .cue") << QStringLiteral("game.cue") << true;
+    QTest::newRow("uppercase file") << QStringLiteral(".iso .cue") << QStringLiteral("GAME.ISO") << true;
+    QTest::newRow("uppercase extension") << QStringLiteral(".ISO") << QStringLiteral("game.iso") << true;
+    QTest::newRow("multi part") << QStringLiteral(".tar.gz") << QStringLiteral("game.tar.gz") << true;
+    QTest::newRow("without dot") << QStringLiteral("iso cue") << QStringLiteral("game.iso") << true;
+    QTest::newRow("mixed") << QStringLiteral(".iso cue") << QStringLiteral("game.cue") << true;
+    QTest::newRow("other extension") << QStringLiteral(".iso") << QStringLiteral("game.bin") << false;
+    QTest::newRow("partial suffix") << QStringLiteral("iso") << QStringLiteral("gameiso") << false;
+    QTest::newRow("empty") << QStringLiteral("") << QStringLiteral("game.iso") << false;
+}
+
+void test_Es2Systems::extensions()
+{
+    QFETCH(QString, extensions);
+    QFETCH(QString, file_name);
+    QFETCH(bool, matches);
+
+    const providers::es2::ExtensionSet ext_set(extensions);
+    QCOMPARE(ext_set.matches(file_name), matches);
+}
+
+
+QTEST_MAIN(test_Es2Systems)
+#include "test_Es2Systems.moc"
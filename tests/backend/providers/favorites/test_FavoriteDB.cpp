@@ -17,12 +17,23 @@
 
 #include <QtTest/QtTest>
 
-#include "model/gaming/Collection.h"
-#include "model/gaming/Game.h"
+#include "modeldata/gaming/GameStore.h"
 #include "providers/pegasus_favorites/Favorites.h"
 #include "utils/HashMap.h"
 
 
+namespace {
+modeldata::GameStore create_dummy_store()
+{
+    modeldata::GameStore store;
+    store.append(modeldata::Game(QFileInfo(":/a/b/coll1dummy1")));
+    store.append(modeldata::Game(QFileInfo(":/coll1dummy2")));
+    store.append(modeldata::Game(QFileInfo(":/x/y/z/coll2dummy1")));
+    return store;
+}
+} // namespace
+
+
 class test_FavoriteDB : public QObject {
     Q_OBJECT
 
@@ -35,21 +46,9 @@ private slots:
 
 void test_FavoriteDB::write()
 {
-    QVector<model::Collection*> collections = {
-        new model::Collection(modeldata::Collection("coll1"), this),
-        new model::Collection(modeldata::Collection("coll2"), this),
-    };
-    QVector<model::Game*> games = {
-        new model::Game(modeldata::Game(QFileInfo(":/a/b/coll1dummy1")), this),
-        new model::Game(modeldata::Game(QFileInfo(":/coll1dummy2")), this),
-        new model::Game(modeldata::Game(QFileInfo(":/x/y/z/coll2dummy1")), this),
-    };
-
-    games.at(1)->setFavorite(true);
-    games.at(2)->setFavorite(true);
-
-    collections.at(0)->setGameList({ games.at(0), games.at(1) });
-    collections.at(1)->setGameList({ games.at(2) });
+    modeldata::GameStore store = create_dummy_store();
+    store.setFavorite(1, true);
+    store.setFavorite(2, true);
 
     QTemporaryFile tmp_file;
     tmp_file.setAutoRemove(false);
@@ -66,7 +65,7 @@ void test_FavoriteDB::write()
     QVERIFY(spy_start.isValid());
     QVERIFY(spy_end.isValid());
 
-    favorite_db.onGameFavoriteChanged(games);
+    favorite_db.onGameFavoriteChanged(store);
 
     QVERIFY(spy_start.count() || spy_start.wait());
     QVERIFY(spy_end.count() || spy_end.wait());
@@ -94,17 +93,7 @@ void test_FavoriteDB::write()
 
 void test_FavoriteDB::rewrite_empty()
 {
-    QVector<model::Collection*> collections = {
-        new model::Collection(modeldata::Collection("coll1"), this),
-        new model::Collection(modeldata::Collection("coll2"), this),
-    };
-    QVector<model::Game*> games = {
-        new model::Game(modeldata::Game(QFileInfo(":/a/b/coll1dummy1")), this),
-        new model::Game(modeldata::Game(QFileInfo(":/coll1dummy2")), this),
-        new model::Game(modeldata::Game(QFileInfo(":/x/y/z/coll2dummy1")), this),
-    };
-    collections.at(0)->setGameList({ games.at(0), games.at(1) });
-    collections.at(1)->setGameList({ games.at(2) });
+    modeldata::GameStore store = create_dummy_store();
 
     QTemporaryFile tmp_file;
     tmp_file.setAutoRemove(false);
@@ -118,11 +107,11 @@ void test_FavoriteDB::rewrite_empty()
     QSignalSpy spy_end(&favorite_db, &providers::favorites::Favorites::finishedWriting);
     QVERIFY(spy_end.isValid());
 
-    games.at(1)->setFavorite(true);
-    favorite_db.onGameFavoriteChanged(games);
+    store.setFavorite(1, true);
+    favorite_db.onGameFavoriteChanged(store);
 
-    games.at(1)->setFavorite(false);
-    favorite_db.onGameFavoriteChanged(games);
+    store.setFavorite(1, false);
+    favorite_db.onGameFavoriteChanged(store);
 
     QVERIFY(spy_end.count() == 2 || spy_end.wait());
 
@@ -144,11 +133,7 @@ void test_FavoriteDB::rewrite_empty()
 
 void test_FavoriteDB::read()
 {
-    QVector<model::Game*> games = {
-        new model::Game(modeldata::Game(QFileInfo(":/a/b/coll1dummy1")), this),
-        new model::Game(modeldata::Game(QFileInfo(":/coll1dummy2")), this),
-        new model::Game(modeldata::Game(QFileInfo(":/x/y/z/coll2dummy1")), this),
-    };
+    modeldata::GameStore store = create_dummy_store();
 
     QTemporaryFile tmp_file;
     tmp_file.setAutoRemove(false);
@@ -156,8 +141,8 @@ void test_FavoriteDB::read()
     {
         QTextStream tmp_stream(&tmp_file);
         tmp_stream << QStringLiteral("# Favorite reader test") << endl;
-        tmp_stream << games[2]->filesConst().first()->data().fileinfo.canonicalFilePath() << endl;
-        tmp_stream << games[1]->filesConst().first()->data().fileinfo.canonicalFilePath() << endl;
+        tmp_stream << store.fileInfo(2).canonicalFilePath() << endl;
+        tmp_stream << store.fileInfo(1).canonicalFilePath() << endl;
         tmp_stream << QStringLiteral(":/somethingfake") << endl;
     }
     const QString db_path = tmp_file.fileName();
@@ -165,19 +150,18 @@ void test_FavoriteDB::read()
 
     providers::favorites::Favorites favorite_db(db_path);
 
-    HashMap<QString, model::GameFile*> path_map;
-    for (const model::Game* const game : games) {
-        model::GameFile* const gamefile = game->filesConst().first();
-        QString path = gamefile->data().fileinfo.canonicalFilePath();
+    HashMap<QString, size_t> path_map;
+    for (size_t file_idx = 0; file_idx < store.totalFileCount(); file_idx++) {
+        QString path = store.fileInfo(file_idx).canonicalFilePath();
         QVERIFY(!path.isEmpty());
-        path_map.emplace(std::move(path), gamefile);
+        path_map.emplace(std::move(path), file_idx);
     }
 
-    favorite_db.findDynamicData({}, games, path_map);
+    favorite_db.findDynamicData({}, store, path_map);
 
-    QVERIFY(!games[0]->data().is_favorite);
-    QVERIFY(games[1]->data().is_favorite);
-    QVERIFY(games[2]->data().is_favorite);
+    QVERIFY(!store.isFavorite(0));
+    QVERIFY(store.isFavorite(1));
+    QVERIFY(store.isFavorite(2));
 
     QFile::remove(db_path);
 }
@@ -0,0 +1,173 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "providers/ParseCache.h"
+
+#include <QTemporaryDir>
+
+
+namespace {
+bool write_file(const QString& path, const QByteArray& contents)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+}
+
+// Files modified recently are not cached, so the tests have to use older ones
+bool make_old(const QString& path)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    QFile file(path);
+    return file.open(QIODevice::ReadWrite)
+        && file.setFileTime(QDateTime::currentDateTime().addDays(-1), QFileDevice::FileModificationTime);
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+} // namespace
+
+
+class test_ParseCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void roundtrip();
+    void file_changed();
+    void recent_file();
+    void unused_dropped();
+    void missing_cache();
+
+private:
+    QTemporaryDir m_tmp_dir;
+    QString m_input_path;
+    QString m_cache_path;
+};
+
+void test_ParseCache::init()
+{
+    QVERIFY(m_tmp_dir.isValid());
+    m_input_path = m_tmp_dir.path() + QStringLiteral("/metadata.txt");
+    m_cache_path = m_tmp_dir.path() + QStringLiteral("/parse.cache");
+    QFile::remove(m_cache_path);
+
+    QVERIFY(write_file(m_input_path, "collection: My Games\n"));
+    if (!make_old(m_input_path))
+        QSKIP("file times cannot be changed with this Qt version");
+}
+
+void test_ParseCache::roundtrip()
+{
+    {
+        providers::ParseCache cache(m_cache_path);
+        providers::ParseCache::FileStamp stamp;
+        QVERIFY(cache.find("test", m_input_path, stamp).isEmpty());
+        QVERIFY(stamp.isValid());
+
+        cache.insert("test", m_input_path, stamp, "parsed data");
+        QCOMPARE(cache.find("test", m_input_path, stamp), QByteArray("parsed data"));
+        QVERIFY(cache.find("other", m_input_path, stamp).isEmpty());
+        QVERIFY(cache.save());
+    }
+
+    providers::ParseCache cache(m_cache_path);
+    QVERIFY(cache.load());
+
+    providers::ParseCache::FileStamp stamp;
+    QCOMPARE(cache.find("test", m_input_path, stamp), QByteArray("parsed data"));
+}
+
+void test_ParseCache::file_changed()
+{
+    {
+        providers::ParseCache cache(m_cache_path);
+        providers::ParseCache::FileStamp stamp;
+        cache.find("test", m_input_path, stamp);
+        cache.insert("test", m_input_path, stamp, "parsed data");
+        QVERIFY(cache.save());
+    }
+
+    QVERIFY(write_file(m_input_path, "collection: My Other Games\n"));
+
+    providers::ParseCache cache(m_cache_path);
+    QVERIFY(cache.load());
+
+    providers::ParseCache::FileStamp stamp;
+    QVERIFY(cache.find("test", m_input_path, stamp).isEmpty());
+}
+
+void test_ParseCache::recent_file()
+{
+    QVERIFY(write_file(m_input_path, "collection: My Other Games\n"));
+
+    providers::ParseCache cache(m_cache_path);
+    providers::ParseCache::FileStamp stamp;
+    cache.find("test", m_input_path, stamp);
+    cache.insert("test", m_input_path, stamp, "parsed data");
+    QVERIFY(cache.find("test", m_input_path, stamp).isEmpty());
+}
+
+void test_ParseCache::unused_dropped()
+{
+    const QString other_path = m_tmp_dir.path() + QStringLiteral("/other.txt");
+    QVERIFY(write_file(other_path, "collection: My Other Games\n"));
+    QVERIFY(make_old(other_path));
+
+    {
+        providers::ParseCache cache(m_cache_path);
+        providers::ParseCache::FileStamp stamp;
+        cache.find("test", m_input_path, stamp);
+        cache.insert("test", m_input_path, stamp, "parsed data");
+        cache.find("test", other_path, stamp);
+        cache.insert("test", other_path, stamp, "other data");
+        QVERIFY(cache.save());
+    }
+    {
+        providers::ParseCache cache(m_cache_path);
+        QVERIFY(cache.load());
+
+        providers::ParseCache::FileStamp stamp;
+        QVERIFY(!cache.find("test", m_input_path, stamp).isEmpty());
+        cache.dropUnused();
+        QVERIFY(cache.save());
+    }
+
+    providers::ParseCache cache(m_cache_path);
+    QVERIFY(cache.load());
+
+    providers::ParseCache::FileStamp stamp;
+    QCOMPARE(cache.find("test", m_input_path, stamp), QByteArray("parsed data"));
+    QVERIFY(cache.find("test", other_path, stamp).isEmpty());
+}
+
+void test_ParseCache::missing_cache()
+{
+    providers::ParseCache cache(m_cache_path);
+    QVERIFY(!cache.load());
+
+    providers::ParseCache::FileStamp stamp;
+    QVERIFY(cache.find("test", m_input_path, stamp).isEmpty());
+}
+
+
+QTEST_MAIN(test_ParseCache)
+#include "test_ParseCache.moc"
@@ -81,6 +81,8 @@ private slots:
     void custom_assets();
     void custom_directories();
     void multifile();
+    void multidir_redefinition();
+    void filter_rules();
 };
 
 void test_PegasusProvider::empty()
@@ -372,6 +374,52 @@ void test_PegasusProvider::multifile()
     QCOMPARE(std::find(child_vec.cbegin(), child_vec.cend(), 1) != child_vec.cend(), true);
 }
 
+void test_PegasusProvider::multidir_redefinition()
+{
+    providers::SearchContext ctx;
+
+    QTest::ignoreMessage(QtInfoMsg, "Collections: found `:/multidir/a/metadata.txt`");
+    QTest::ignoreMessage(QtInfoMsg, "Collections: found `:/multidir/b/metadata.txt`");
+    providers::pegasus::PegasusProvider provider({QStringLiteral(":/multidir/a"), QStringLiteral(":/multidir/b")});
+    provider.findLists(ctx);
+
+    // the files are processed in order, the later definitions win
+    QCOMPARE(static_cast<int>(ctx.collections.size()), 1);
+    const modeldata::Collection& coll = ctx.collections.at(QStringLiteral("Shared"));
+    QCOMPARE(coll.shortName(), QStringLiteral("shr"));
+    QCOMPARE(coll.launch_cmd, QStringLiteral("cmd_b"));
+    QCOMPARE(coll.summary, QStringLiteral("from b"));
+
+    // the game was defined when the collection had the launch command of the first file
+    const auto game_it = std::find_if(ctx.games.cbegin(), ctx.games.cend(),
+        [](const modeldata::Game& game){ return game.title == QLatin1String("Game B"); });
+    QVERIFY(game_it != ctx.games.cend());
+    QCOMPARE(game_it->launch_cmd, QStringLiteral("cmd_a"));
+}
+
+void test_PegasusProvider::filter_rules()
+{
+    providers::SearchContext ctx;
+
+    QTest::ignoreMessage(QtInfoMsg, "Collections: found `:/filters/metadata.txt`");
+    providers::pegasus::PegasusProvider provider({QStringLiteral(":/filters")});
+    provider.findLists(ctx);
+
+    QCOMPARE(static_cast<int>(ctx.games.size()), 4);
+
+    // the extension lists are lowercased, but the file extensions are not;
+    // excludes win over includes
+    const HashMap<QString, QStringList> coll_files_map {
+        { QStringLiteral("Filtered"), {
+            { ":/filters/game.ext" },
+            { ":/filters/game2.zip" },
+            { ":/filters/extra.bin" },
+            { ":/filters/sub/kept.ext" },
+        }},
+    };
+    verify_collected_files(ctx, coll_files_map);
+}
+
 
 QTEST_MAIN(test_PegasusProvider)
 #include "test_PegasusProvider.moc"
@@ -17,8 +17,9 @@
 
 #include <QtTest/QtTest>
 
-#include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "model/gaming/Library.h"
 #include "providers/pegasus_playtime/PlaytimeStats.h"
 
 #include <QSqlDatabase>
@@ -28,26 +29,12 @@ using PlaytimeStats = providers::playtime::PlaytimeStats;
 
 namespace {
 
-void create_dummy_data(QVector<model::Collection*>& collections,
-                       QVector<model::Game*>& games,
-                       HashMap<QString, model::GameFile*>& path_map,
-                       QObject* parent)
+modeldata::GameStore create_dummy_store()
 {
-    collections = {
-        new model::Collection(modeldata::Collection("coll1"), parent),
-        new model::Collection(modeldata::Collection("coll2"), parent),
-    };
-    games = {
-        new model::Game(modeldata::Game(QFileInfo("dummy1")), parent),
-        new model::Game(modeldata::Game(QFileInfo("dummy2")), parent),
-    };
-    path_map = {
-        { "dummy1", games.at(0)->files()->first() },
-        { "dummy2", games.at(1)->files()->first() },
-    };
-
-    collections.at(0)->setGameList({ games.at(0) });
-    collections.at(1)->setGameList({ games.at(1) });
+    modeldata::GameStore store;
+    store.append(modeldata::Game(QFileInfo("dummy1")));
+    store.append(modeldata::Game(QFileInfo("dummy2")));
+    return store;
 }
 
 } // namespace
@@ -64,10 +51,11 @@ private slots:
 
 void test_Playtime::read()
 {
-    QVector<model::Collection*> collections;
-    QVector<model::Game*> games;
-    HashMap<QString, model::GameFile*> path_map;
-    create_dummy_data(collections, games, path_map, this);
+    modeldata::GameStore store = create_dummy_store();
+    const HashMap<QString, size_t> path_map {
+        { "dummy1", 0 },
+        { "dummy2", 1 },
+    };
 
     const QString db_path = QDir::tempPath() + QStringLiteral("/data.db");
     QFile::remove(db_path);
@@ -75,19 +63,19 @@ void test_Playtime::read()
 
 
     PlaytimeStats playtime(db_path);
-    playtime.findDynamicData(collections, games, path_map);
+    playtime.findDynamicData({}, store, path_map);
 
-    QCOMPARE(games.at(0)->playCount(), 4);
-    QCOMPARE(games.at(0)->playTime(), 35 /*sec*/);
-    QCOMPARE(games.at(0)->lastPlayed(), QDateTime::fromSecsSinceEpoch(1531755039));
+    QCOMPARE(store.playCount(0), 4);
+    QCOMPARE(store.playTime(0), 35 /*sec*/);
+    QCOMPARE(store.lastPlayed(0), QDateTime::fromSecsSinceEpoch(1531755039));
 }
 
 void test_Playtime::write()
 {
-    QVector<model::Collection*> collections;
-    QVector<model::Game*> games;
-    HashMap<QString, model::GameFile*> path_map;
-    create_dummy_data(collections, games, path_map, this);
+    model::Library library;
+    library.replaceStore(create_dummy_store(), {});
+    model::Game* const game = library.game(0);
+    model::GameFile* const gamefile = game->filesConst().first();
 
     QTemporaryFile db_file;
     QVERIFY(db_file.open());
@@ -99,23 +87,23 @@ void test_Playtime::write()
     QSignalSpy spy_end(&playtime, &providers::playtime::PlaytimeStats::finishedWriting);
     QVERIFY(spy_start.isValid() && spy_end.isValid());
 
-    playtime.onGameLaunched(games.at(0)->files()->first());
-    playtime.onGameFinished(games.at(0)->files()->first());
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
 
     QVERIFY(spy_start.count() || spy_start.wait());
     QVERIFY(spy_end.count() || spy_end.wait());
     QCOMPARE(spy_start.count(), 1);
     QCOMPARE(spy_end.count(), 1);
 
-    QCOMPARE(games.at(0)->property("playCount").toInt(), 1);
+    QCOMPARE(game->property("playCount").toInt(), 1);
 }
 
 void test_Playtime::write_queue()
 {
-    QVector<model::Collection*> collections;
-    QVector<model::Game*> games;
-    HashMap<QString, model::GameFile*> path_map;
-    create_dummy_data(collections, games, path_map, this);
+    model::Library library;
+    library.replaceStore(create_dummy_store(), {});
+    model::Game* const game = library.game(0);
+    model::GameFile* const gamefile = game->filesConst().first();
 
     QTemporaryFile db_file;
     QVERIFY(db_file.open());
@@ -128,14 +116,14 @@ void test_Playtime::write_queue()
     QVERIFY(spy_start.isValid() && spy_end.isValid());
 
 
-    playtime.onGameLaunched(games.at(0)->files()->first());
-    playtime.onGameFinished(games.at(0)->files()->first());
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
 
-    playtime.onGameLaunched(games.at(0)->files()->first());
-    playtime.onGameFinished(games.at(0)->files()->first());
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
 
-    playtime.onGameLaunched(games.at(0)->files()->first());
-    playtime.onGameFinished(games.at(0)->files()->first());
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
 
 
     QVERIFY(spy_start.count() || spy_start.wait());
@@ -143,7 +131,7 @@ void test_Playtime::write_queue()
     QCOMPARE(spy_start.count(), 1);
     QCOMPARE(spy_end.count(), 1);
 
-    QCOMPARE(games.at(0)->property("playCount").toInt(), 3);
+    QCOMPARE(game->property("playCount").toInt(), 3);
 }
 
 
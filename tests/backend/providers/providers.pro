@@ -4,3 +4,7 @@ SUBDIRS += \
     pegasus \
     favorites \
     playtime \
+    snapshot \
+    parsecache \
+    rescan \
+    es2systems \
@@ -0,0 +1,289 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Collection.h"
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
+#include "model/internal/Meta.h"
+#include "providers/LibrarySnapshot.h"
+#include "providers/Provider.h"
+#include "providers/ProviderManager.h"
+
+#include "QtQmlTricks/QQmlObjectListModel.h"
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <atomic>
+
+
+/// Reports a single game file in its own collection, and counts how many
+/// times (and how many at once) it was searched
+class FakeProvider : public providers::Provider {
+    Q_OBJECT
+
+public:
+    FakeProvider(QString collection, QString game_path)
+        : providers::Provider(providers::PROVIDES_LISTS)
+        , m_collection(std::move(collection))
+        , m_game_path(std::move(game_path))
+        , m_blocking(false)
+        , m_search_count(0)
+        , m_active_count(0)
+        , m_max_active_count(0)
+    {}
+
+    void findLists(providers::SearchContext& sctx) final
+    {
+        const int active = ++m_active_count;
+        int max_active = m_max_active_count.load();
+        while (active > max_active && !m_max_active_count.compare_exchange_weak(max_active, active)) {}
+        m_search_count++;
+
+        // stays in the search until released or cancelled
+        while (m_blocking && !sctx.cancelled())
+            QThread::msleep(5);
+
+        if (!sctx.cancelled()) {
+            QString game_path;
+            {
+                QMutexLocker lock(&m_guard);
+                game_path = m_game_path;
+            }
+            const QFileInfo fileinfo(game_path);
+            modeldata::Game game(fileinfo);
+            game.files.front().canonical_path = fileinfo.canonicalFilePath();
+
+            sctx.path_to_gameidx.emplace(game.files.front().canonical_path, sctx.games.size());
+            sctx.collection_childs[m_collection].emplace_back(sctx.games.size());
+            sctx.collections.emplace(m_collection, modeldata::Collection(m_collection));
+            sctx.games.emplace_back(std::move(game));
+        }
+
+        m_active_count--;
+    }
+
+    void setGamePath(QString path)
+    {
+        QMutexLocker lock(&m_guard);
+        m_game_path = std::move(path);
+    }
+    void setBlocking(bool value) { m_blocking = value; }
+    int searchCount() const { return m_search_count; }
+    int maxActiveCount() const { return m_max_active_count; }
+
+private:
+    const QString m_collection;
+    QMutex m_guard;
+    QString m_game_path;
+    std::atomic<bool> m_blocking;
+    std::atomic<int> m_search_count;
+    std::atomic<int> m_active_count;
+    std::atomic<int> m_max_active_count;
+};
+
+
+namespace {
+bool create_file(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly);
+}
+
+QStringList game_titles(const model::GameList& list)
+{
+    QStringList titles;
+    for (int row = 0; row < list.count(); row++)
+        titles << list.data(list.index(row), model::GameList::TitleRole).toString();
+
+    titles.sort();
+    return titles;
+}
+} // namespace
+
+
+class test_Rescan : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_tmp_dir;
+    FakeProvider* m_provider_a;
+    FakeProvider* m_provider_b;
+
+    std::unique_ptr<ProviderManager> m_providerman;
+    std::unique_ptr<model::Library> m_library;
+    std::unique_ptr<model::GameList> m_game_model;
+    std::unique_ptr<QQmlObjectListModel<model::Collection>> m_collection_model;
+    std::unique_ptr<model::Meta> m_meta;
+
+    QString tmpFile(const QString& name) const { return m_tmp_dir.path() + QLatin1Char('/') + name; }
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void masked_rescan();
+    void cancel_keeps_library();
+    void requests_during_rescan();
+    void results_wait_for_game();
+};
+
+void test_Rescan::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    QVERIFY(m_tmp_dir.isValid());
+    QVERIFY(create_file(tmpFile(QStringLiteral("alpha.bin"))));
+    QVERIFY(create_file(tmpFile(QStringLiteral("beta.bin"))));
+    QVERIFY(create_file(tmpFile(QStringLiteral("gamma.bin"))));
+}
+
+void test_Rescan::init()
+{
+    // the initial search would be served from the snapshot of the previous test
+    QFile::remove(providers::snapshot::default_path());
+
+    m_provider_a = new FakeProvider(QStringLiteral("A"), tmpFile(QStringLiteral("alpha.bin")));
+    m_provider_b = new FakeProvider(QStringLiteral("B"), tmpFile(QStringLiteral("beta.bin")));
+    std::vector<ProviderPtr> provider_list;
+    provider_list.emplace_back(m_provider_a);
+    provider_list.emplace_back(m_provider_b);
+
+    m_providerman.reset(new ProviderManager(std::move(provider_list), nullptr));
+    m_library.reset(new model::Library());
+    m_game_model.reset(new model::GameList(*m_library));
+    m_collection_model.reset(new QQmlObjectListModel<model::Collection>());
+    m_meta.reset(new model::Meta());
+
+    // the same connections as in the API object
+    connect(m_providerman.get(), &ProviderManager::rescanStarted,
+            m_meta.get(), &model::Meta::onRescanStarted);
+    connect(m_providerman.get(), &ProviderManager::rescanFinished,
+            m_meta.get(), &model::Meta::onRescanFinished);
+    m_meta->setProviderNames(m_providerman->providerNames());
+    connect(m_meta.get(), &model::Meta::rescanRequested,
+            m_providerman.get(), &ProviderManager::startRescan);
+    connect(m_meta.get(), &model::Meta::rescanCancelRequested,
+            m_providerman.get(), &ProviderManager::cancelRescan);
+
+    QSignalSpy search_done(m_providerman.get(), &ProviderManager::thirdPhaseComplete);
+    m_providerman->startSearch(*m_library, *m_game_model, *m_collection_model);
+    QTRY_COMPARE(search_done.count(), 1);
+    QCOMPARE(game_titles(*m_game_model), QStringList({ QStringLiteral("alpha"), QStringLiteral("beta") }));
+}
+
+void test_Rescan::cleanup()
+{
+    // the manager waits for the running search, so the providers must not block
+    m_provider_a->setBlocking(false);
+    m_provider_b->setBlocking(false);
+
+    m_providerman.reset();
+    m_meta.reset();
+    m_collection_model.reset();
+    m_game_model.reset();
+    m_library.reset();
+}
+
+void test_Rescan::masked_rescan()
+{
+    QSignalSpy rescan_done(m_providerman.get(), &ProviderManager::rescanFinished);
+    m_provider_a->setGamePath(tmpFile(QStringLiteral("gamma.bin")));
+
+    m_meta->rescan(1 << 0);
+    QTRY_COMPARE(rescan_done.count(), 1);
+    QVERIFY(!m_meta->isRescanning());
+
+    QCOMPARE(m_provider_a->searchCount(), 2);
+    QCOMPARE(m_provider_b->searchCount(), 1);
+    // the game of the provider left out comes from the cache filled by the initial search
+    QCOMPARE(game_titles(*m_game_model), QStringList({ QStringLiteral("beta"), QStringLiteral("gamma") }));
+}
+
+void test_Rescan::cancel_keeps_library()
+{
+    QSignalSpy rescan_done(m_providerman.get(), &ProviderManager::rescanFinished);
+    m_provider_a->setGamePath(tmpFile(QStringLiteral("gamma.bin")));
+    m_provider_b->setBlocking(true);
+
+    m_meta->rescan();
+    QTRY_COMPARE(m_provider_b->searchCount(), 2);
+    QVERIFY(m_meta->isRescanning());
+
+    m_meta->cancelRescan();
+    QTRY_COMPARE(rescan_done.count(), 1);
+    QVERIFY(!m_meta->isRescanning());
+
+    // the results of the cancelled rescan are not published
+    QCOMPARE(game_titles(*m_game_model), QStringList({ QStringLiteral("alpha"), QStringLiteral("beta") }));
+    QCOMPARE(m_collection_model->count(), 2);
+}
+
+void test_Rescan::requests_during_rescan()
+{
+    m_provider_a->setBlocking(true);
+
+    m_meta->rescan(1 << 0);
+    QTRY_COMPARE(m_provider_a->searchCount(), 2);
+
+    // the running rescan gets restarted with both providers,
+    // instead of a second one running next to it
+    m_meta->rescan(1 << 1);
+    m_meta->rescan(1 << 1);
+    m_provider_a->setBlocking(false);
+
+    QTRY_COMPARE(m_provider_b->searchCount(), 2);
+    QTRY_VERIFY(!m_meta->isRescanning());
+
+    QCOMPARE(m_provider_a->searchCount(), 3);
+    QCOMPARE(m_provider_b->searchCount(), 2);
+    QCOMPARE(m_provider_a->maxActiveCount(), 1);
+    QCOMPARE(m_provider_b->maxActiveCount(), 1);
+    QCOMPARE(game_titles(*m_game_model), QStringList({ QStringLiteral("alpha"), QStringLiteral("beta") }));
+}
+
+void test_Rescan::results_wait_for_game()
+{
+    QSignalSpy rescan_done(m_providerman.get(), &ProviderManager::rescanFinished);
+    m_provider_a->setGamePath(tmpFile(QStringLiteral("gamma.bin")));
+    m_provider_a->setBlocking(true);
+
+    m_meta->rescan();
+    QTRY_COMPARE(m_provider_a->searchCount(), 2);
+
+    // a game gets launched while the rescan is running
+    m_providerman->onGameLaunched(nullptr);
+    m_provider_a->setBlocking(false);
+    QTRY_COMPARE(m_provider_b->searchCount(), 2);
+
+    // the results must not remove the game objects while the game is running
+    QTest::qWait(500);
+    QCOMPARE(rescan_done.count(), 0);
+    QVERIFY(m_meta->isRescanning());
+    QCOMPARE(game_titles(*m_game_model), QStringList({ QStringLiteral("alpha"), QStringLiteral("beta") }));
+
+    m_providerman->onGameFinished(nullptr);
+    QCOMPARE(rescan_done.count(), 1);
+    QVERIFY(!m_meta->isRescanning());
+    QCOMPARE(game_titles(*m_game_model), QStringList({ QStringLiteral("beta"), QStringLiteral("gamma") }));
+}
+
+
+QTEST_MAIN(test_Rescan)
+#include "test_Rescan.moc"
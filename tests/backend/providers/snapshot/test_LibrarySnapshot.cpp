@@ -0,0 +1,294 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "modeldata/gaming/CollectionData.h"
+#include "modeldata/gaming/GameData.h"
+#include "providers/LibrarySnapshot.h"
+#include "providers/Provider.h"
+
+#include <QTemporaryDir>
+
+
+namespace {
+void fill_context(providers::SearchContext& sctx, const QString& source_path)
+{
+    modeldata::Collection coll(QStringLiteral("My Games"));
+    coll.setShortName(QStringLiteral("mg"));
+    coll.launch_cmd = QStringLiteral("runner {file.path}");
+    coll.assets.setSingle(AssetType::LOGO, QStringLiteral("logo.png"));
+    sctx.collections.emplace(coll.name, std::move(coll));
+
+    modeldata::Game game(QFileInfo(QStringLiteral("/tmp/game.bin")));
+    game.title = QStringLiteral("Game Title");
+    game.player_count = 4;
+    game.rating = 0.5f;
+    game.release_date = QDate(2000, 1, 2);
+    game.developers << QStringLiteral("Dev A") << QStringLiteral("Dev B");
+    game.assets.setSingle(AssetType::BOX_FRONT, QStringLiteral("box.png"));
+    game.assets.appendMulti(AssetType::SCREENSHOTS, QStringLiteral("screen1.png"));
+    game.assets.appendMulti(AssetType::SCREENSHOTS, QStringLiteral("screen2.png"));
+    sctx.games.emplace_back(std::move(game));
+
+    sctx.collection_childs[QStringLiteral("My Games")].emplace_back(0);
+    sctx.path_to_gameidx.emplace(QStringLiteral("/tmp/game.bin"), 0);
+    sctx.source_paths.emplace_back(source_path);
+}
+
+bool write_file(const QString& path, const QByteArray& contents)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+}
+} // namespace
+
+
+class test_LibrarySnapshot : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundtrip();
+    void source_changed();
+    void source_changed_allowed();
+    void missing_source_created();
+    void key_changed();
+    void missing_snapshot();
+    void list_results_roundtrip();
+    void list_results_of_unchanged_sources();
+};
+
+void test_LibrarySnapshot::roundtrip()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    const QString source_path = tmp_dir.path() + QStringLiteral("/metadata.txt");
+    const QString snapshot_path = tmp_dir.path() + QStringLiteral("/library.snapshot");
+    QVERIFY(write_file(source_path, "collection: My Games\n"));
+
+    {
+        providers::SearchContext sctx;
+        fill_context(sctx, source_path);
+        QVERIFY(providers::snapshot::write(snapshot_path, providers::snapshot::serialize(sctx, "key")));
+    }
+
+    providers::SearchContext sctx;
+    QVERIFY(providers::snapshot::load(snapshot_path, "key", sctx));
+
+    QCOMPARE(sctx.collections.size(), static_cast<size_t>(1));
+    modeldata::Collection& coll = sctx.collections.at(QStringLiteral("My Games"));
+    QCOMPARE(coll.shortName(), QStringLiteral("mg"));
+    QCOMPARE(coll.launch_cmd, QStringLiteral("runner {file.path}"));
+    QCOMPARE(coll.assets.single(AssetType::LOGO), QStringLiteral("logo.png"));
+
+    QCOMPARE(sctx.games.size(), static_cast<size_t>(1));
+    modeldata::Game& game = sctx.games.front();
+    QCOMPARE(game.title, QStringLiteral("Game Title"));
+    QCOMPARE(game.player_count, static_cast<short>(4));
+    QCOMPARE(game.rating, 0.5f);
+    QCOMPARE(game.release_date, QDate(2000, 1, 2));
+    QCOMPARE(game.developers, QStringList({ QStringLiteral("Dev A"), QStringLiteral("Dev B") }));
+    QCOMPARE(game.files.size(), static_cast<size_t>(1));
+    QCOMPARE(game.files.front().fileinfo.filePath(), QStringLiteral("/tmp/game.bin"));
+    QCOMPARE(game.assets.single(AssetType::BOX_FRONT), QStringLiteral("box.png"));
+    QCOMPARE(game.assets.multi(AssetType::SCREENSHOTS),
+             QStringList({ QStringLiteral("screen1.png"), QStringLiteral("screen2.png") }));
+
+    QCOMPARE(sctx.collection_childs.at(QStringLiteral("My Games")), std::vector<size_t>({ 0 }));
+    QCOMPARE(sctx.path_to_gameidx.at(QStringLiteral("/tmp/game.bin")), static_cast<size_t>(0));
+    QCOMPARE(sctx.source_paths, std::vector<QString>({ source_path }));
+}
+
+void test_LibrarySnapshot::source_changed()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    const QString source_path = tmp_dir.path() + QStringLiteral("/metadata.txt");
+    const QString snapshot_path = tmp_dir.path() + QStringLiteral("/library.snapshot");
+    QVERIFY(write_file(source_path, "collection: My Games\n"));
+
+    {
+        providers::SearchContext sctx;
+        fill_context(sctx, source_path);
+        QVERIFY(providers::snapshot::write(snapshot_path, providers::snapshot::serialize(sctx, "key")));
+    }
+
+    QVERIFY(write_file(source_path, "collection: My Other Games\n"));
+
+    providers::SearchContext sctx;
+    QVERIFY(!providers::snapshot::load(snapshot_path, "key", sctx));
+    QVERIFY(sctx.games.empty());
+    QVERIFY(sctx.collections.empty());
+}
+
+void test_LibrarySnapshot::source_changed_allowed()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    const QString source_path = tmp_dir.path() + QStringLiteral("/metadata.txt");
+    const QString snapshot_path = tmp_dir.path() + QStringLiteral("/library.snapshot");
+    QVERIFY(write_file(source_path, "collection: My Games\n"));
+
+    {
+        providers::SearchContext sctx;
+        fill_context(sctx, source_path);
+        QVERIFY(providers::snapshot::write(snapshot_path, providers::snapshot::serialize(sctx, "key")));
+    }
+
+    bool is_outdated = false;
+    {
+        providers::SearchContext sctx;
+        QVERIFY(providers::snapshot::load(snapshot_path, "key", sctx, &is_outdated));
+        QVERIFY(!is_outdated);
+    }
+
+    QVERIFY(write_file(source_path, "collection: My Other Games\n"));
+
+    providers::SearchContext sctx;
+    QVERIFY(providers::snapshot::load(snapshot_path, "key", sctx, &is_outdated));
+    QVERIFY(is_outdated);
+    QCOMPARE(sctx.games.size(), static_cast<size_t>(1));
+}
+
+void test_LibrarySnapshot::missing_source_created()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    // eg. a config file looked for, but not found
+    const QString source_path = tmp_dir.path() + QStringLiteral("/es_systems.cfg");
+    const QString snapshot_path = tmp_dir.path() + QStringLiteral("/library.snapshot");
+
+    {
+        providers::SearchContext sctx;
+        fill_context(sctx, source_path);
+        QVERIFY(providers::snapshot::write(snapshot_path, providers::snapshot::serialize(sctx, "key")));
+    }
+    {
+        providers::SearchContext sctx;
+        QVERIFY(providers::snapshot::load(snapshot_path, "key", sctx));
+    }
+
+    QVERIFY(write_file(source_path, "<systemList/>\n"));
+
+    providers::SearchContext sctx;
+    QVERIFY(!providers::snapshot::load(snapshot_path, "key", sctx));
+}
+
+void test_LibrarySnapshot::key_changed()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    const QString snapshot_path = tmp_dir.path() + QStringLiteral("/library.snapshot");
+    {
+        providers::SearchContext sctx;
+        fill_context(sctx, tmp_dir.path());
+        QVERIFY(providers::snapshot::write(snapshot_path, providers::snapshot::serialize(sctx, "key")));
+    }
+
+    providers::SearchContext sctx;
+    QVERIFY(!providers::snapshot::load(snapshot_path, "other key", sctx));
+    QVERIFY(sctx.games.empty());
+}
+
+void test_LibrarySnapshot::missing_snapshot()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    providers::SearchContext sctx;
+    QVERIFY(!providers::snapshot::load(tmp_dir.path() + QStringLiteral("/none"), "key", sctx));
+}
+
+void test_LibrarySnapshot::list_results_roundtrip()
+{
+    QByteArray bytes;
+    {
+        providers::SearchContext sctx;
+        fill_context(sctx, QStringLiteral("/tmp/metadata.txt"));
+        sctx.sources_trackable = false;
+        bytes = providers::snapshot::serialize_list_results(sctx);
+    }
+
+    providers::SearchContext sctx;
+    QVERIFY(providers::snapshot::deserialize_list_results(bytes, sctx));
+    QVERIFY(!sctx.sources_trackable);
+    QCOMPARE(sctx.source_paths, std::vector<QString>({ QStringLiteral("/tmp/metadata.txt") }));
+    QCOMPARE(sctx.collections.size(), static_cast<size_t>(1));
+    QCOMPARE(sctx.games.size(), static_cast<size_t>(1));
+    QCOMPARE(sctx.games.front().title, QStringLiteral("Game Title"));
+    QCOMPARE(sctx.collection_childs.at(QStringLiteral("My Games")), std::vector<size_t>({ 0 }));
+    QCOMPARE(sctx.path_to_gameidx.at(QStringLiteral("/tmp/game.bin")), static_cast<size_t>(0));
+
+    providers::SearchContext broken_sctx;
+    QVERIFY(!providers::snapshot::deserialize_list_results(bytes.left(bytes.size() / 2), broken_sctx));
+    QVERIFY(broken_sctx.games.empty());
+}
+
+void test_LibrarySnapshot::list_results_of_unchanged_sources()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    const QString source_a = tmp_dir.path() + QStringLiteral("/a.txt");
+    const QString source_b = tmp_dir.path() + QStringLiteral("/b.txt");
+    const QString snapshot_path = tmp_dir.path() + QStringLiteral("/library.snapshot");
+    QVERIFY(write_file(source_a, "collection: A\n"));
+    QVERIFY(write_file(source_b, "collection: B\n"));
+
+    {
+        providers::SearchContext sctx_a;
+        fill_context(sctx_a, source_a);
+        providers::SearchContext sctx_b;
+        fill_context(sctx_b, source_b);
+        const std::vector<QByteArray> list_results {
+            providers::snapshot::serialize_list_results(sctx_a),
+            providers::snapshot::serialize_list_results(sctx_b),
+        };
+
+        providers::SearchContext sctx;
+        fill_context(sctx, source_a);
+        sctx.source_paths.emplace_back(source_b);
+        QVERIFY(providers::snapshot::write(snapshot_path,
+            providers::snapshot::serialize(sctx, "key", list_results)));
+    }
+
+    QVERIFY(write_file(source_b, "collection: Other B\n"));
+
+    bool is_outdated = false;
+    std::vector<QByteArray> list_results;
+    providers::SearchContext sctx;
+    QVERIFY(providers::snapshot::load(snapshot_path, "key", sctx, &is_outdated, &list_results));
+    QVERIFY(is_outdated);
+
+    // only the results built from the changed file are dropped
+    QCOMPARE(list_results.size(), static_cast<size_t>(2));
+    QVERIFY(list_results[1].isEmpty());
+
+    providers::SearchContext sctx_a;
+    QVERIFY(providers::snapshot::deserialize_list_results(list_results[0], sctx_a));
+    QCOMPARE(sctx_a.source_paths, std::vector<QString>({ source_a }));
+    QCOMPARE(sctx_a.games.size(), static_cast<size_t>(1));
+}
+
+
+QTEST_MAIN(test_LibrarySnapshot)
+#include "test_LibrarySnapshot.moc"
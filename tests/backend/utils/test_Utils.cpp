@@ -17,7 +17,12 @@
 
 #include <QtTest/QtTest>
 
+#include "utils/Collation.h"
+#include "utils/DirListingCache.h"
+#include "utils/HashMap.h"
+#include "utils/PathCache.h"
 #include "utils/PathCheck.h"
+#include "utils/StringPool.h"
 
 
 class test_Utils : public QObject
@@ -27,6 +32,18 @@ class test_Utils : public QObject
 private slots:
     void validExtPath_data();
     void validExtPath();
+
+    void stringPool_strings();
+    void stringPool_lists();
+
+    void sortTitle_data();
+    void sortTitle();
+
+    void pathCache();
+    void dirListingCache();
+
+    void hashMap();
+    void hashMap_strref();
 };
 
 void test_Utils::validExtPath_data()
@@ -49,6 +66,217 @@ void test_Utils::validExtPath()
     QCOMPARE(::validExtPath(path), result);
 }
 
+void test_Utils::stringPool_strings()
+{
+    StringPool pool;
+
+    QString first = QStringLiteral("Action");
+    QString second = QString(QStringLiteral("Act")) + QStringLiteral("ion");
+    QString other = QStringLiteral("Puzzle");
+    QVERIFY(first.constData() != second.constData());
+
+    pool.intern(first);
+    pool.intern(second);
+    pool.intern(other);
+
+    QCOMPARE(second, QStringLiteral("Action"));
+    QCOMPARE(first.constData(), second.constData());
+    QVERIFY(other.constData() != first.constData());
+    QVERIFY(pool.savedBytes() > 0);
+
+    // interning again changes nothing
+    const qint64 saved = pool.savedBytes();
+    pool.intern(second);
+    QCOMPARE(pool.savedBytes(), saved);
+}
+
+void test_Utils::stringPool_lists()
+{
+    StringPool pool;
+
+    QStringList first { QStringLiteral("Action"), QStringLiteral("Puzzle") };
+    QStringList second { QStringLiteral("Action"), QStringLiteral("Puzzle") };
+    QStringList partial { QStringLiteral("Puzzle") };
+
+    pool.intern(first);
+    pool.intern(second);
+    pool.intern(partial);
+
+    QCOMPARE(second, first);
+    QCOMPARE(first.constBegin(), second.constBegin());
+    QCOMPARE(partial.first().constData(), first.at(1).constData());
+    QVERIFY(pool.savedBytes() > 0);
+}
+
+void test_Utils::sortTitle_data()
+{
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<bool>("ignore_articles");
+    QTest::addColumn<QString>("result");
+
+    QTest::newRow("disabled") << "The Game" << false << "The Game";
+    QTest::newRow("the") << "The Game" << true << "Game";
+    QTest::newRow("a") << "a game" << true << "game";
+    QTest::newRow("an") << "An Apple" << true << "Apple";
+    QTest::newRow("no article") << "Theater" << true << "Theater";
+    QTest::newRow("article only") << "The " << true << "The ";
+}
+
+void test_Utils::sortTitle()
+{
+    QFETCH(QString, title);
+    QFETCH(bool, ignore_articles);
+    QFETCH(QString, result);
+
+    QCOMPARE(collation::sort_title(title, ignore_articles), result);
+}
+
+void test_Utils::pathCache()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    QVERIFY(QDir(tmp_dir.path()).mkdir(QStringLiteral("sub")));
+
+    const QString file_path = tmp_dir.path() + QStringLiteral("/sub/game.bin");
+    QFile file(file_path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    PathCache cache;
+    const QFileInfo finfo(tmp_dir.path() + QStringLiteral("/sub/../sub/game.bin"));
+    QCOMPARE(cache.canonicalFilePath(finfo), QFileInfo(file_path).canonicalFilePath());
+    QCOMPARE(cache.canonicalDir(tmp_dir.path() + QStringLiteral("/sub")),
+             QFileInfo(tmp_dir.path() + QStringLiteral("/sub")).canonicalFilePath());
+
+    QVERIFY(cache.canonicalFilePath(QFileInfo(tmp_dir.path() + QStringLiteral("/sub/missing.bin"))).isEmpty());
+    QVERIFY(cache.canonicalDir(tmp_dir.path() + QStringLiteral("/missing")).isEmpty());
+
+    // entries of directory listings
+    const QString sub_path = tmp_dir.path() + QStringLiteral("/sub");
+    DirEntry entry { QStringLiteral("game.bin"), -1, -1, 0, 0, false, false };
+    QCOMPARE(cache.canonicalFilePath(sub_path, entry), QFileInfo(file_path).canonicalFilePath());
+#ifdef Q_OS_UNIX
+    QVERIFY(QFile::link(file_path, sub_path + QStringLiteral("/link.bin")));
+    entry.name = QStringLiteral("link.bin");
+    entry.is_symlink = true;
+    QCOMPARE(cache.canonicalFilePath(sub_path, entry), QFileInfo(file_path).canonicalFilePath());
+#endif
+}
+
+void test_Utils::dirListingCache()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    QVERIFY(QDir(tmp_dir.path()).mkpath(QStringLiteral("sub/subsub")));
+
+    QFile file(tmp_dir.path() + QStringLiteral("/sub/game.bin"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+#ifdef Q_OS_UNIX
+    QVERIFY(QFile::link(tmp_dir.path() + QStringLiteral("/sub"), tmp_dir.path() + QStringLiteral("/sub/subsub/loop")));
+#endif
+
+    DirListingCache cache;
+    const std::shared_ptr<const DirListing> listing = cache.list(tmp_dir.path() + QStringLiteral("/sub"));
+    QCOMPARE(static_cast<int>(listing->size()), 2);
+    for (const DirEntry& entry : *listing) {
+        QVERIFY(!entry.is_symlink);
+        if (entry.name == QLatin1String("game.bin")) {
+            QVERIFY(!entry.is_dir);
+        }
+        else {
+            QCOMPARE(entry.name, QStringLiteral("subsub"));
+            QVERIFY(entry.is_dir);
+        }
+    }
+
+    // the same listing is returned, even if the directory changes
+    QVERIFY(QFile::remove(tmp_dir.path() + QStringLiteral("/sub/game.bin")));
+    QCOMPARE(cache.list(tmp_dir.path() + QStringLiteral("/sub")), listing);
+
+    // the linked directory is visited only once
+    const std::vector<QString> expected_dirs {
+        tmp_dir.path(),
+        tmp_dir.path() + QStringLiteral("/sub"),
+        tmp_dir.path() + QStringLiteral("/sub/subsub"),
+#ifdef Q_OS_UNIX
+        tmp_dir.path() + QStringLiteral("/sub/subsub/loop"),
+        tmp_dir.path() + QStringLiteral("/sub/subsub/loop/subsub"),
+#endif
+    };
+    QCOMPARE(cache.findDirs(tmp_dir.path()), expected_dirs);
+
+    QVERIFY(cache.list(tmp_dir.path() + QStringLiteral("/missing"))->empty());
+
+    // after prefetching, the trees are walked in the same order without reading the disk
+    DirListingCache prefetched;
+    prefetched.prefetch({ tmp_dir.path(), tmp_dir.path() + QStringLiteral("/missing") });
+    QVERIFY(QDir(tmp_dir.path()).removeRecursively());
+    QCOMPARE(prefetched.findDirs(tmp_dir.path()), expected_dirs);
+}
+
+void test_Utils::hashMap()
+{
+    HashMap<int, int> map;
+    for (int i = 0; i < 1000; i++)
+        QVERIFY(map.emplace(i, i * 2).second);
+    QVERIFY(!map.emplace(10, 0).second);
+    QCOMPARE(map.size(), static_cast<size_t>(1000));
+    QCOMPARE(map.at(10), 20);
+
+    for (int i = 0; i < 1000; i += 2)
+        QCOMPARE(map.erase(i), static_cast<size_t>(1));
+    QCOMPARE(map.erase(0), static_cast<size_t>(0));
+    QCOMPARE(map.size(), static_cast<size_t>(500));
+
+    int sum = 0;
+    for (const auto& entry : map) {
+        QVERIFY(entry.first % 2 == 1);
+        QCOMPARE(entry.second, entry.first * 2);
+        sum += entry.first;
+    }
+    QCOMPARE(sum, 250000);
+
+    for (auto it = map.begin(); it != map.end(); ) {
+        if (it->first < 500)
+            it = map.erase(it);
+        else
+            ++it;
+    }
+    QCOMPARE(map.size(), static_cast<size_t>(250));
+    QCOMPARE(map.count(499), static_cast<size_t>(0));
+    QCOMPARE(map.count(501), static_cast<size_t>(1));
+
+    map[2000] += 5;
+    QCOMPARE(map.at(2000), 5);
+
+    map.clear();
+    QVERIFY(map.empty());
+    QVERIFY(map.begin() == map.end());
+}
+
+void test_Utils::hashMap_strref()
+{
+    const QString text = QStringLiteral("path: /home/user/games/game.bin");
+    const QStringRef path_ref = text.midRef(6);
+
+    const HashMap<QString, int> map {
+        { QStringLiteral("/home/user/games/game.bin"), 1 },
+        { QStringLiteral("/home/user/games/other.bin"), 2 },
+    };
+    QCOMPARE(map.count(path_ref), static_cast<size_t>(1));
+    QCOMPARE(map.at(path_ref), 1);
+    QCOMPARE(map.count(QLatin1String("/home/user/games/other.bin")), static_cast<size_t>(1));
+    QVERIFY(map.find(text.midRef(7)) == map.cend());
+
+    const HashMap<QLatin1String, int> latin1_map {
+        { QLatin1String("name"), 1 },
+        { QLatin1String("fullname"), 2 },
+    };
+    const QString xml_name = QStringLiteral("<fullname>");
+    QCOMPARE(latin1_map.at(xml_name.midRef(1, 8)), 2);
+}
+
 
 QTEST_MAIN(test_Utils)
 #include "test_Utils.moc"
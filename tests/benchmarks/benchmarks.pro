@@ -2,4 +2,8 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     configfile \
+    es2_parser \
+    game_lists \
+    hashmap \
     pegasus_provider \
+    provider_manager \
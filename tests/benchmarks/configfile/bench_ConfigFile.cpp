@@ -20,15 +20,96 @@
 #include "ConfigFile.h"
 
 
+namespace {
+/// The previous, line by line reader of the config files, kept as a baseline
+void read_stream_by_lines(QTextStream& stream,
+                          const std::function<void(const config::Entry&)>& onAttributeFound,
+                          const std::function<void(const config::Error&)>& onError)
+{
+    constexpr auto EMPTY_LINE_MARK = QChar('.');
+    const QRegularExpression rx_keyval(QStringLiteral(R"(^([^:]+):(.*)$)")); // key: value
+
+    config::Entry entry;
+    entry.reset();
+
+    const auto close_current_attrib = [&](){
+        if (!entry.key.isEmpty()) {
+            if (entry.values.isEmpty())
+                onError({ entry.line, QStringLiteral("attribute value missing, entry ignored") });
+            else
+                onAttributeFound(entry);
+        }
+
+        entry.reset();
+    };
+
+    int linenum = 0;
+    QString line;
+    while (stream.readLineInto(&line)) {
+        linenum++;
+
+        if (line.startsWith('#'))
+            continue;
+
+        const QStringRef trimmed_line = line.leftRef(-1).trimmed();
+        if (trimmed_line.isEmpty()) {
+            close_current_attrib();
+            continue;
+        }
+
+        if (line.at(0).isSpace()) {
+            if (entry.key.isEmpty()) {
+                onError({ linenum, QStringLiteral("line starts with whitespace, but no attribute has been defined yet") });
+                continue;
+            }
+
+            if (trimmed_line == EMPTY_LINE_MARK) {
+                entry.values.append(QStringLiteral("\n"));
+                continue;
+            }
+
+            entry.values.append(trimmed_line.toString());
+            continue;
+        }
+
+        close_current_attrib();
+
+        const auto rx_keyval_match = rx_keyval.match(trimmed_line);
+        if (rx_keyval_match.hasMatch()) {
+            entry.key = rx_keyval_match.capturedRef(1).trimmed().toString().toLower();
+
+            const auto value_part = rx_keyval_match.capturedRef(2).trimmed();
+            if (!value_part.isEmpty())
+                entry.values.append(value_part.toString());
+
+            entry.line = linenum;
+            continue;
+        }
+
+        onError({ linenum, QStringLiteral("line invalid, skipped") });
+    }
+
+    close_current_attrib();
+}
+} // namespace
+
+
 class bench_ConfigFile : public QObject {
     Q_OBJECT
 
 private slots:
+    void initTestCase();
+
     void empty();
     void file();
+    void largeFile();
+    void largeFile_stream_data();
+    void largeFile_stream();
 
 private:
     QVector<config::Entry> m_entries;
+    QTemporaryDir m_tmp_dir;
+    QString m_large_file_path;
 
     void onAttributeFound(const config::Entry&);
     void onError(int, const QString&);
@@ -56,6 +137,33 @@ void bench_ConfigFile::readStream(QTextStream& stream)
 }
 
 
+void bench_ConfigFile::initTestCase()
+{
+    QVERIFY(m_tmp_dir.isValid());
+    m_large_file_path = m_tmp_dir.path() + QStringLiteral("/metadata.pegasus.txt");
+
+    QFile file(m_large_file_path);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Text));
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    stream << "collection: My Games\nextension: bin\n\n";
+    for (int i = 0; i < 50000; i++) {
+        stream << "# entry " << i << "\n"
+               << "game: Game Title " << i << "\n"
+               << "file: game_" << i << ".bin\n"
+               << "developer: Developer " << (i % 100) << "\n"
+               << "genre: Platformer, Action\n"
+               << "players: 1-2\n"
+               << "release: 1994-03-12\n"
+               << "description: Lorem ipsum dolor sit amet, consectetur adipiscing elit,\n"
+               << "  sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\n"
+               << "  .\n"
+               << "  Ut enim ad minim veniam, quis nostrud exercitation.\n"
+               << "\n";
+    }
+}
+
 void bench_ConfigFile::empty()
 {
     QByteArray buffer;
@@ -79,6 +187,47 @@ void bench_ConfigFile::file()
     }
 }
 
+void bench_ConfigFile::largeFile()
+{
+    QBENCHMARK {
+        m_entries.clear();
+        config::readFile(m_large_file_path,
+            [this](const config::Entry& entry){ this->onAttributeFound(entry); },
+            [this](const config::Error& error){ this->onError(error.line, error.message); });
+    }
+    QCOMPARE(m_entries.size(), 2 + 50000 * 7);
+}
+
+void bench_ConfigFile::largeFile_stream_data()
+{
+    QTest::addColumn<bool>("by_lines");
+
+    QTest::newRow("line reader (baseline)") << true;
+    QTest::newRow("current") << false;
+}
+
+void bench_ConfigFile::largeFile_stream()
+{
+    QFETCH(bool, by_lines);
+
+    QBENCHMARK {
+        m_entries.clear();
+
+        QFile file(m_large_file_path);
+        QVERIFY(file.open(QFile::ReadOnly | QFile::Text));
+        QTextStream stream(&file);
+        if (by_lines) {
+            read_stream_by_lines(stream,
+                [this](const config::Entry& entry){ this->onAttributeFound(entry); },
+                [this](const config::Error& error){ this->onError(error.line, error.message); });
+        }
+        else {
+            readStream(stream);
+        }
+    }
+    QCOMPARE(m_entries.size(), 2 + 50000 * 7);
+}
+
 
 QTEST_MAIN(bench_ConfigFile)
 #include "bench_ConfigFile.moc"
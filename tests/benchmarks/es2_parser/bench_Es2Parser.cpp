@@ -0,0 +1,114 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "providers/es2/Es2Metadata.h"
+
+#include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+
+namespace {
+QString gamelist_path(const QTemporaryDir& dir, int game_count)
+{
+    return dir.path() + QStringLiteral("/gamelist_%1.xml").arg(game_count);
+}
+
+bool write_gamelist(const QString& path, int game_count)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "<?xml version=\"1.0\"?>\n<gameList>\n";
+    for (int i = 0; i < game_count; i++) {
+        out << "  <game id=\"" << i << "\" source=\"ScreenScraper.fr\">\n";
+        out << "    <path>./game" << i << ".bin</path>\n";
+        out << "    <name>Game " << i << "</name>\n";
+        out << "    <desc>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</desc>\n";
+        out << "    <image>./images/game" << i << "-image.jpg</image>\n";
+        out << "    <rating>0." << (i % 10) << "</rating>\n";
+        out << "    <releasedate>19" << (80 + i % 20) << "0101T000000</releasedate>\n";
+        out << "    <developer>Developer " << (i % 50) << "</developer>\n";
+        out << "    <publisher>Publisher " << (i % 30) << "</publisher>\n";
+        out << "    <genre>Genre " << (i % 20) << "</genre>\n";
+        out << "    <players>1-" << (1 + i % 4) << "</players>\n";
+        out << "    <playcount>" << (i % 7) << "</playcount>\n";
+        out << "    <lastplayed>20190101T120000</lastplayed>\n";
+        // not supported fields
+        out << "    <thumbnail>./images/game" << i << "-thumb.jpg</thumbnail>\n";
+        out << "    <hash>0123456789ABCDEF</hash>\n";
+        out << "  </game>\n";
+    }
+    out << "</gameList>\n";
+
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+} // namespace
+
+
+class bench_Es2Parser : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void read_gamelist_data();
+    void read_gamelist();
+
+private:
+    QTemporaryDir m_tmp_dir;
+};
+
+void bench_Es2Parser::initTestCase()
+{
+    QVERIFY(m_tmp_dir.isValid());
+
+    for (const int game_count : { 1000, 100000 })
+        QVERIFY(write_gamelist(gamelist_path(m_tmp_dir, game_count), game_count));
+}
+
+void bench_Es2Parser::read_gamelist_data()
+{
+    QTest::addColumn<int>("game_count");
+
+    QTest::newRow("1k games") << 1000;
+    QTest::newRow("100k games") << 100000;
+}
+
+void bench_Es2Parser::read_gamelist()
+{
+    QFETCH(int, game_count);
+
+    const QString path = gamelist_path(m_tmp_dir, game_count);
+    providers::SearchContext sctx;
+    const providers::es2::MetadataParser parser(nullptr);
+
+    QBENCHMARK {
+        std::vector<providers::es2::GameEntry> entries;
+        QVERIFY(parser.readGamelist(path, sctx, entries));
+        QCOMPARE(static_cast<int>(entries.size()), game_count);
+    }
+}
+
+
+QTEST_MAIN(bench_Es2Parser)
+#include "bench_Es2Parser.moc"
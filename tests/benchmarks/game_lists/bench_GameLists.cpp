@@ -0,0 +1,158 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
+#include "modeldata/gaming/GameListSort.h"
+#include "modeldata/gaming/GameStore.h"
+#include "utils/HashMap.h"
+
+#include <QStringBuilder>
+#include <QThreadPool>
+#include <memory>
+#include <random>
+
+
+namespace {
+static constexpr int COLLECTION_COUNT = 150;
+
+struct TestLibrary {
+    modeldata::GameStore store;
+    std::vector<quint32> ranks;
+    HashMap<QString, std::vector<size_t>> collection_childs;
+};
+
+/// Creates a store of randomly named games, with each game being in one or two
+/// collections, and the games of the collections in a random order
+TestLibrary create_library(int game_count)
+{
+    static const QStringList WORDS {
+        "Super", "Mega", "Dragon", "Quest", "Racing", "Star", "Fighter", "Legend",
+        "Puzzle", "World", "Tales", "Ninja", "Space", "Island", "Kart", "Dungeon",
+    };
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> word_dist(0, WORDS.size() - 1);
+    std::uniform_int_distribution<int> coll_dist(0, COLLECTION_COUNT - 1);
+
+    TestLibrary library;
+    library.store.reserve(static_cast<size_t>(game_count));
+    for (int i = 0; i < game_count; i++) {
+        const QString title = WORDS.at(word_dist(rng)) % ' ' % WORDS.at(word_dist(rng))
+                            % ' ' % QString::number(i % 97);
+
+        modeldata::Game game(title);
+        game.files.emplace_back(QFileInfo(QStringLiteral("/games/%1.bin").arg(i)));
+        const size_t game_idx = library.store.append(std::move(game));
+
+        library.collection_childs[QStringLiteral("coll%1").arg(coll_dist(rng))].emplace_back(game_idx);
+        if (i % 4 == 0)
+            library.collection_childs[QStringLiteral("coll%1").arg(coll_dist(rng))].emplace_back(game_idx);
+    }
+
+    library.store.updateSortKeys(QCollator(QLocale::c()), false);
+    library.ranks = library.store.titleRanks();
+    return library;
+}
+} // namespace
+
+
+class bench_GameLists : public QObject {
+    Q_OBJECT
+
+private slots:
+    void sortLists_data();
+    void sortLists();
+    void fillModels_data();
+    void fillModels();
+
+    void cleanup();
+};
+
+void bench_GameLists::cleanup()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+void bench_GameLists::sortLists_data()
+{
+    QTest::addColumn<int>("game_count");
+    QTest::addColumn<int>("thread_count");
+
+    const int ideal_threads = QThread::idealThreadCount();
+    for (const int game_count : { 10000, 100000 }) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 games, 1 thread").arg(game_count)))
+            << game_count << 1;
+        QTest::newRow(qPrintable(QStringLiteral("%1 games, %2 threads").arg(game_count).arg(ideal_threads)))
+            << game_count << ideal_threads;
+    }
+}
+
+void bench_GameLists::sortLists()
+{
+    QFETCH(int, game_count);
+    QFETCH(int, thread_count);
+    QThreadPool::globalInstance()->setMaxThreadCount(thread_count);
+
+    const TestLibrary library = create_library(game_count);
+
+    std::vector<size_t> all_games;
+    QBENCHMARK {
+        // NOTE: the lists are sorted in place, so the copy is part of the measurement
+        HashMap<QString, std::vector<size_t>> lists = library.collection_childs;
+        all_games = modeldata::sort_game_lists(lists, library.ranks);
+    }
+    QCOMPARE(all_games.size(), static_cast<size_t>(game_count));
+}
+
+void bench_GameLists::fillModels_data()
+{
+    QTest::addColumn<int>("game_count");
+
+    QTest::newRow("10000 games") << 10000;
+    QTest::newRow("100000 games") << 100000;
+}
+
+void bench_GameLists::fillModels()
+{
+    QFETCH(int, game_count);
+
+    TestLibrary test_lib = create_library(game_count);
+    const std::vector<size_t> all_games = modeldata::sort_game_lists(test_lib.collection_childs, test_lib.ranks);
+
+    model::Library library;
+    library.replaceStore(std::move(test_lib.store), {});
+
+    // only the part done on the UI thread: filling the list models
+    QBENCHMARK {
+        model::GameList all_list(library);
+        all_list.insertEntries(all_games, test_lib.ranks);
+
+        std::vector<std::unique_ptr<model::GameList>> coll_lists;
+        coll_lists.reserve(test_lib.collection_childs.size());
+        for (const auto& entry : test_lib.collection_childs) {
+            coll_lists.emplace_back(new model::GameList(library));
+            coll_lists.back()->insertEntries(entry.second, test_lib.ranks);
+        }
+        QCOMPARE(all_list.count(), game_count);
+    }
+}
+
+
+QTEST_MAIN(bench_GameLists)
+#include "bench_GameLists.moc"
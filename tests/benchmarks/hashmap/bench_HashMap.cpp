@@ -0,0 +1,151 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <QtTest/QtTest>
+
+#include "utils/HashMap.h"
+
+#include <unordered_map>
+
+
+namespace {
+static constexpr int KEY_COUNT = 100000;
+
+/// The previous HashMap setup, a node based map with the Qt string hash
+struct QtStringHash {
+    std::size_t operator()(const QString& s) const { return qHash(s); }
+};
+using NodeHashMap = std::unordered_map<QString, size_t, QtStringHash>;
+
+QStringList create_paths()
+{
+    QStringList paths;
+    paths.reserve(KEY_COUNT);
+    for (int i = 0; i < KEY_COUNT; i++) {
+        paths.append(QStringLiteral("/home/user/games/collection %1/subdir/game %2.bin")
+            .arg(QString::number(i % 50), QString::number(i)));
+    }
+    return paths;
+}
+
+template <typename Map>
+Map fill_map(const QStringList& paths)
+{
+    Map map;
+    map.reserve(static_cast<size_t>(paths.size()));
+    for (int i = 0; i < paths.size(); i++)
+        map.emplace(paths.at(i), static_cast<size_t>(i));
+
+    return map;
+}
+} // namespace
+
+
+class bench_HashMap : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void insert_node();
+    void insert_flat();
+    void lookup_node();
+    void lookup_flat();
+    void lookupRef_node();
+    void lookupRef_flat();
+
+private:
+    QStringList m_paths;
+    // lines containing the paths, to look up parts of them
+    QStringList m_lines;
+};
+
+void bench_HashMap::initTestCase()
+{
+    m_paths = create_paths();
+
+    m_lines.reserve(m_paths.size());
+    for (const QString& path : qAsConst(m_paths))
+        m_lines.append(QStringLiteral("file: ") + path);
+}
+
+void bench_HashMap::insert_node()
+{
+    QBENCHMARK {
+        const NodeHashMap map = fill_map<NodeHashMap>(m_paths);
+        QCOMPARE(map.size(), static_cast<size_t>(KEY_COUNT));
+    }
+}
+
+void bench_HashMap::insert_flat()
+{
+    QBENCHMARK {
+        const HashMap<QString, size_t> map = fill_map<HashMap<QString, size_t>>(m_paths);
+        QCOMPARE(map.size(), static_cast<size_t>(KEY_COUNT));
+    }
+}
+
+void bench_HashMap::lookup_node()
+{
+    const NodeHashMap map = fill_map<NodeHashMap>(m_paths);
+
+    size_t found = 0;
+    QBENCHMARK {
+        for (const QString& path : qAsConst(m_paths))
+            found += map.count(path);
+    }
+    QVERIFY(found > 0);
+}
+
+void bench_HashMap::lookup_flat()
+{
+    const HashMap<QString, size_t> map = fill_map<HashMap<QString, size_t>>(m_paths);
+
+    size_t found = 0;
+    QBENCHMARK {
+        for (const QString& path : qAsConst(m_paths))
+            found += map.count(path);
+    }
+    QVERIFY(found > 0);
+}
+
+void bench_HashMap::lookupRef_node()
+{
+    const NodeHashMap map = fill_map<NodeHashMap>(m_paths);
+
+    size_t found = 0;
+    QBENCHMARK {
+        for (const QString& line : qAsConst(m_lines))
+            found += map.count(line.midRef(6).toString());
+    }
+    QVERIFY(found > 0);
+}
+
+void bench_HashMap::lookupRef_flat()
+{
+    const HashMap<QString, size_t> map = fill_map<HashMap<QString, size_t>>(m_paths);
+
+    size_t found = 0;
+    QBENCHMARK {
+        for (const QString& line : qAsConst(m_lines))
+            found += map.count(line.midRef(6));
+    }
+    QVERIFY(found > 0);
+}
+
+
+QTEST_MAIN(bench_HashMap)
+#include "bench_HashMap.moc"
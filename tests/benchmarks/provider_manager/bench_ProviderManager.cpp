@@ -0,0 +1,281 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <QtTest/QtTest>
+
+#include "AppSettings.h"
+#include "LibraryGenerator.h"
+#include "Paths.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
+#include "providers/LibrarySnapshot.h"
+#include "providers/ParseCache.h"
+#include "providers/ProviderManager.h"
+#include "types/ProviderType.h"
+
+#include "QtQmlTricks/QQmlObjectListModel.h"
+#include <QString>
+#include <QTemporaryDir>
+#include <map>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+
+namespace {
+/// Starts a new measurement of the peak memory usage. Only supported on Linux,
+/// elsewhere the peak is measured from the start of the process.
+void reset_peak_rss()
+{
+#ifdef Q_OS_LINUX
+    QFile file(QStringLiteral("/proc/self/clear_refs"));
+    if (file.open(QIODevice::WriteOnly))
+        file.write("5");
+#endif
+}
+
+long peak_rss_kib()
+{
+#if defined(Q_OS_LINUX)
+    // NOTE: unlike `ru_maxrss`, this one can be reset
+    QFile file(QStringLiteral("/proc/self/status"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').first().toLong(); // kilobytes
+    }
+    return -1;
+#elif defined(Q_OS_MACOS)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024; // bytes
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // kilobytes
+#else
+    return -1;
+#endif
+}
+
+struct PhaseTimes {
+    bool finished = false;
+    qint64 lists = 0;
+    qint64 assets = 0;
+    qint64 total = 0;
+    long peak_rss_kib = -1;
+};
+
+void write_text(const QString& path, const QByteArray& text)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(text) == text.size());
+}
+} // namespace
+
+
+class bench_ProviderManager : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void full_search_data();
+    void full_search();
+    void parse_cached_search_data();
+    void parse_cached_search();
+    void warm_start_data();
+    void warm_start();
+
+private:
+    QTemporaryDir m_tmpdir;
+    QString m_home_dir;
+    std::map<int, testsupport::GeneratedLibrary> m_libraries;
+
+    void add_rows();
+    void use_library(int game_count);
+    PhaseTimes run_search();
+    void report(int game_count, const PhaseTimes&);
+};
+
+void bench_ProviderManager::initTestCase()
+{
+    QVERIFY(m_tmpdir.isValid());
+
+    // NOTE: both must be set before the first path lookup, as they get cached
+    m_home_dir = QDir(m_tmpdir.path()).canonicalPath() + QStringLiteral("/home");
+    QVERIFY(QDir().mkpath(m_home_dir + QStringLiteral("/.emulationstation")));
+    qputenv("PEGASUS_HOME", m_home_dir.toLocal8Bit());
+    QStandardPaths::setTestModeEnabled(true);
+
+    // only the providers that can be pointed to the generated files
+    AppSettings::ext_providers.mut(ExtProvider::ES2).enabled = true;
+    AppSettings::ext_providers.mut(ExtProvider::STEAM).enabled = false;
+    AppSettings::ext_providers.mut(ExtProvider::GOG).enabled = false;
+    AppSettings::ext_providers.mut(ExtProvider::ANDROIDAPPS).enabled = false;
+    AppSettings::ext_providers.mut(ExtProvider::SKRAPER).enabled = true;
+}
+
+void bench_ProviderManager::add_rows()
+{
+    QTest::addColumn<int>("game_count");
+
+    QTest::newRow("1k games") << 1000;
+    QTest::newRow("10k games") << 10000;
+    QTest::newRow("100k games") << 100000;
+}
+
+void bench_ProviderManager::use_library(int game_count)
+{
+    auto it = m_libraries.find(game_count);
+    if (it == m_libraries.end()) {
+        const QString root_dir = QDir(m_tmpdir.path()).canonicalPath()
+                               + QStringLiteral("/lib%1").arg(game_count);
+        const int coll_count = std::max(4, game_count / 250);
+
+        testsupport::GeneratedLibrary library;
+        QVERIFY(testsupport::generate_library(root_dir, testsupport::LibraryOptions(coll_count, game_count), library));
+        it = m_libraries.emplace(game_count, std::move(library)).first;
+    }
+
+    const testsupport::GeneratedLibrary& library = it->second;
+    write_text(paths::writableConfigDir() + QStringLiteral("/game_dirs.txt"),
+               library.game_dirs.join('\n').toUtf8());
+
+    const QString es_systems_path = m_home_dir + QStringLiteral("/.emulationstation/es_systems.cfg");
+    QFile::remove(es_systems_path);
+    QVERIFY(QFile::copy(library.es_systems_path, es_systems_path));
+}
+
+PhaseTimes bench_ProviderManager::run_search()
+{
+    PhaseTimes times;
+
+    model::Library library;
+    QQmlObjectListModel<model::Collection> collections;
+    model::GameList games(library);
+    ProviderManager manager(nullptr);
+
+    connect(&manager, &ProviderManager::firstPhaseComplete,
+            [&times](qint64 ms){ times.lists = ms; });
+    connect(&manager, &ProviderManager::secondPhaseComplete,
+            [&times](qint64 ms){ times.assets = ms; });
+    connect(&manager, &ProviderManager::thirdPhaseComplete,
+            [&times](qint64 ms){ times.total = ms; times.finished = true; });
+
+    reset_peak_rss();
+
+    QSignalSpy finished_spy(&manager, &ProviderManager::thirdPhaseComplete);
+    manager.startSearch(library, games, collections);
+    finished_spy.wait(10 * 60 * 1000);
+
+    times.peak_rss_kib = peak_rss_kib();
+    return times;
+}
+
+void bench_ProviderManager::report(int game_count, const PhaseTimes& times)
+{
+    qInfo().noquote() << QStringLiteral("%1 games: lists %2 ms, assets %3 ms, models %4 ms, total %5 ms, peak RSS %6 KiB")
+        .arg(game_count)
+        .arg(times.lists)
+        .arg(times.assets)
+        .arg(times.total - times.lists - times.assets)
+        .arg(times.total)
+        .arg(times.peak_rss_kib);
+}
+
+void bench_ProviderManager::full_search_data()
+{
+    add_rows();
+}
+
+void bench_ProviderManager::full_search()
+{
+    QFETCH(int, game_count);
+    use_library(game_count);
+
+    const QString snapshot_path = providers::snapshot::default_path();
+    const QString parse_cache_path = providers::ParseCache::defaultPath();
+
+    PhaseTimes times;
+    QBENCHMARK {
+        QFile::remove(snapshot_path);
+        QFile::remove(parse_cache_path);
+        times = run_search();
+    }
+    QVERIFY(times.finished);
+    report(game_count, times);
+}
+
+void bench_ProviderManager::parse_cached_search_data()
+{
+    add_rows();
+}
+
+void bench_ProviderManager::parse_cached_search()
+{
+    QFETCH(int, game_count);
+    use_library(game_count);
+
+    const QString snapshot_path = providers::snapshot::default_path();
+
+    // fill the parse cache, then search without the snapshot
+    QFile::remove(snapshot_path);
+    QFile::remove(providers::ParseCache::defaultPath());
+    QVERIFY(run_search().finished);
+    QVERIFY(QFileInfo::exists(providers::ParseCache::defaultPath()));
+
+    PhaseTimes times;
+    QBENCHMARK {
+        QFile::remove(snapshot_path);
+        times = run_search();
+    }
+    QVERIFY(times.finished);
+    report(game_count, times);
+}
+
+void bench_ProviderManager::warm_start_data()
+{
+    add_rows();
+}
+
+void bench_ProviderManager::warm_start()
+{
+    QFETCH(int, game_count);
+    use_library(game_count);
+
+    // create a fresh snapshot of the library
+    QFile::remove(providers::snapshot::default_path());
+    QVERIFY(run_search().finished);
+    QVERIFY(QFileInfo::exists(providers::snapshot::default_path()));
+
+    PhaseTimes times;
+    QBENCHMARK {
+        times = run_search();
+    }
+    QVERIFY(times.finished);
+    report(game_count, times);
+}
+
+
+QTEST_MAIN(bench_ProviderManager)
+#include "bench_ProviderManager.moc"
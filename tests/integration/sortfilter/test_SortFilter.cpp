@@ -19,6 +19,8 @@
 
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameList.h"
+#include "model/gaming/Library.h"
 
 #include "SortFilterProxyModel/qqmlsortfilterproxymodel.h"
 #include "SortFilterProxyModel/filters/filtersqmltypes.h"
@@ -46,6 +48,8 @@ public slots:
     }
 
 private:
+    // NOTE: the library has to outlive the collections
+    model::Library m_library;
     QQmlObjectListModel<model::Collection> m_collection_model;
 
     void register_api() {
@@ -54,6 +58,7 @@ private:
 
         qmlRegisterUncreatableType<model::Collection>(api, 1, 0, "Collection", err);
         qmlRegisterUncreatableType<model::Game>(api, 1, 0, "Game", err);
+        qmlRegisterUncreatableType<model::GameList>(api, 1, 0, "GameList", err);
         qmlRegisterUncreatableType<model::GameAssets>(api, 1, 0, "GameAssets", err);
 
         qqsfpm::registerSorterTypes();
@@ -63,13 +68,14 @@ private:
     }
 
     void create_model() {
-        QVector<model::Game*> games = {
-            new model::Game(modeldata::Game(QFileInfo("ccc"))),
-            new model::Game(modeldata::Game(QFileInfo("aaa"))),
-            new model::Game(modeldata::Game(QFileInfo("bbb"))),
-        };
-        auto collection = new model::Collection(modeldata::Collection("test"), this);
-        collection->setGameList(std::move(games));
+        modeldata::GameStore store;
+        store.append(modeldata::Game(QFileInfo("ccc")));
+        store.append(modeldata::Game(QFileInfo("aaa")));
+        store.append(modeldata::Game(QFileInfo("bbb")));
+        m_library.replaceStore(std::move(store), {});
+
+        auto collection = new model::Collection(modeldata::Collection("test"), m_library);
+        collection->setGameList({ 0, 1, 2 });
 
         m_collection_model.append(collection);
     }
@@ -0,0 +1,11 @@
+TEMPLATE = app
+
+QT -= gui
+CONFIG += c++11 console warn_on exceptions_off
+CONFIG -= app_bundle
+
+TARGET = gen_library
+SOURCES = main.cpp
+DEFINES *= $${COMMON_DEFINES}
+
+include($${TOP_SRCDIR}/tests/support/link_to_support.pri)
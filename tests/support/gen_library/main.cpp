@@ -0,0 +1,78 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "LibraryGenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser argparser;
+    argparser.setApplicationDescription(QStringLiteral(
+        "Creates a test game library with the given number of collections and games.\n"
+        "The game directories are written into `game_dirs.txt` in the target directory."));
+    argparser.addPositionalArgument(QStringLiteral("dir"), QStringLiteral("Target directory"));
+    argparser.addPositionalArgument(QStringLiteral("collections"), QStringLiteral("Number of collections"));
+    argparser.addPositionalArgument(QStringLiteral("games"), QStringLiteral("Number of games"));
+    argparser.addHelpOption();
+    argparser.process(app);
+
+    QTextStream err(stderr);
+
+    const QStringList args = argparser.positionalArguments();
+    if (args.size() != 3)
+        argparser.showHelp(1); // quits
+
+    bool coll_ok = false;
+    bool games_ok = false;
+    const int coll_count = args.at(1).toInt(&coll_ok);
+    const int game_count = args.at(2).toInt(&games_ok);
+    if (!coll_ok || !games_ok || coll_count < 1 || game_count < 0) {
+        err << "Invalid collection or game count" << endl;
+        return 1;
+    }
+
+    const QString root_dir = QDir(args.at(0)).absolutePath();
+    if (!QDir().mkpath(root_dir)) {
+        err << "Could not create " << root_dir << endl;
+        return 1;
+    }
+
+    testsupport::GeneratedLibrary library;
+    if (!testsupport::generate_library(root_dir, testsupport::LibraryOptions(coll_count, game_count), library)) {
+        err << "Failed to create the library in " << root_dir << endl;
+        return 1;
+    }
+
+    QFile game_dirs_file(root_dir + QStringLiteral("/game_dirs.txt"));
+    if (!game_dirs_file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        err << "Could not write " << game_dirs_file.fileName() << endl;
+        return 1;
+    }
+    game_dirs_file.write(library.game_dirs.join('\n').toUtf8());
+
+    QTextStream(stdout)
+        << "Created " << library.game_count << " games in " << library.collection_count << " collections\n"
+        << "ES2 systems file: " << library.es_systems_path << endl;
+    return 0;
+}
@@ -0,0 +1,14 @@
+# Link the project that includes this file to the test support library
+
+win32:CONFIG(release, debug|release): LIBS += -L$${TOP_BUILDDIR}/tests/support/testsupport/release/ -ltestsupport
+else:win32:CONFIG(debug, debug|release): LIBS += -L$${TOP_BUILDDIR}/tests/support/testsupport/debug/ -ltestsupport
+else:unix: LIBS += -L$${TOP_BUILDDIR}/tests/support/testsupport/ -ltestsupport
+
+INCLUDEPATH += $${TOP_SRCDIR}/tests/support/testsupport
+DEPENDPATH += $${TOP_SRCDIR}/tests/support/testsupport
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $${TOP_BUILDDIR}/tests/support/testsupport/release/libtestsupport.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $${TOP_BUILDDIR}/tests/support/testsupport/debug/libtestsupport.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $${TOP_BUILDDIR}/tests/support/testsupport/release/testsupport.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $${TOP_BUILDDIR}/tests/support/testsupport/debug/testsupport.lib
+else:unix: PRE_TARGETDEPS += $${TOP_BUILDDIR}/tests/support/testsupport/libtestsupport.a
@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    testsupport \
+    gen_library \
+
+gen_library.depends = testsupport
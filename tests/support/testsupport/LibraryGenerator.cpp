@@ -0,0 +1,309 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "LibraryGenerator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <random>
+
+
+namespace {
+constexpr int GAMES_PER_SUBDIR = 250;
+
+enum class CollectionKind : unsigned char {
+    PEGASUS,
+    PEGASUS_MEDIA,
+    SKRAPER,
+    ES2,
+};
+
+const char* const DEVELOPERS[] = {
+    "Alpha Soft", "Bitworks", "Cyber Studio", "Data East", "Epoch Games",
+    "Falcom", "Game Arts", "Hudson", "Irem", "Jaleco",
+};
+const char* const GENRES[] = {
+    "Action", "Adventure", "Fighting", "Platform", "Puzzle",
+    "Racing", "Role-Playing", "Shooter", "Sports", "Strategy",
+};
+const char* const LOREM =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod"
+    " tempor incididunt ut labore et dolore magna aliqua.";
+
+
+class Generator {
+public:
+    Generator(const QString& root_dir, unsigned seed)
+        : m_root(root_dir)
+        , m_rng(seed)
+        , m_ok(true)
+    {}
+
+    bool ok() const { return m_ok; }
+
+    void make_dir(const QString& path) {
+        m_ok &= QDir().mkpath(path);
+    }
+    void touch(const QString& path) {
+        QFile file(path);
+        m_ok &= file.open(QIODevice::WriteOnly);
+    }
+    void write_text(const QString& path, const QString& text) {
+        QFile file(path);
+        m_ok &= file.open(QIODevice::WriteOnly | QIODevice::Text)
+            && file.write(text.toUtf8()) >= 0;
+    }
+
+    bool chance(int percent) {
+        return std::uniform_int_distribution<int>(0, 99)(m_rng) < percent;
+    }
+    template<size_t N>
+    QString pick(const char* const (&pool)[N]) {
+        return QString::fromLatin1(pool[std::uniform_int_distribution<size_t>(0, N - 1)(m_rng)]);
+    }
+    int number(int min, int max) {
+        return std::uniform_int_distribution<int>(min, max)(m_rng);
+    }
+
+    QString pegasus_dir(int coll_idx) const {
+        return m_root + QStringLiteral("/pegasus/coll%1").arg(coll_idx);
+    }
+    QString es2_dir(int coll_idx) const {
+        return m_root + QStringLiteral("/es2/sys%1").arg(coll_idx);
+    }
+
+    void create_pegasus_collection(int coll_idx, CollectionKind, int game_count, int first_game_idx);
+    void create_es2_system(int coll_idx, int game_count, int first_game_idx, QTextStream& systems_xml);
+
+private:
+    const QString m_root;
+    std::mt19937 m_rng;
+    bool m_ok;
+
+    void create_game_files(const QString& dir, const QString& ext, int game_count, int first_game_idx);
+    void write_pegasus_game(QTextStream& out, const QString& relpath, const QString& title);
+    void write_es2_game(QTextStream& out, const QString& relpath, const QString& title);
+};
+
+QString game_relpath(int game_idx, int idx_in_coll, const QString& ext)
+{
+    return QStringLiteral("sub%1/game%2.%3")
+        .arg(idx_in_coll / GAMES_PER_SUBDIR)
+        .arg(game_idx)
+        .arg(ext);
+}
+
+QString game_title(int game_idx)
+{
+    return QStringLiteral("Game %1").arg(game_idx);
+}
+
+void Generator::create_game_files(const QString& dir, const QString& ext, int game_count, int first_game_idx)
+{
+    for (int i = 0; i < game_count; i += GAMES_PER_SUBDIR)
+        make_dir(dir + QStringLiteral("/sub%1").arg(i / GAMES_PER_SUBDIR));
+
+    for (int i = 0; i < game_count; i++)
+        touch(dir + '/' + game_relpath(first_game_idx + i, i, ext));
+}
+
+void Generator::write_pegasus_game(QTextStream& out, const QString& relpath, const QString& title)
+{
+    out << "game: " << title << '\n';
+    out << "file: " << relpath << '\n';
+    if (chance(80))
+        out << "developer: " << pick(DEVELOPERS) << '\n';
+    if (chance(60))
+        out << "publisher: " << pick(DEVELOPERS) << '\n';
+    if (chance(70))
+        out << "genre: " << pick(GENRES) << '\n';
+    if (chance(50))
+        out << "players: 1-" << number(1, 4) << '\n';
+    if (chance(60))
+        out << "release: " << number(1980, 2010) << '-' << number(10, 12) << '-' << number(10, 28) << '\n';
+    if (chance(50))
+        out << "rating: " << number(0, 100) << "%\n";
+    if (chance(40))
+        out << "summary: " << LOREM << '\n';
+    if (chance(30))
+        out << "description:\n  " << LOREM << "\n  .\n  " << LOREM << '\n';
+    if (chance(10))
+        out << "x-custom-id: " << number(1000, 9999) << '\n';
+    out << '\n';
+}
+
+void Generator::create_pegasus_collection(int coll_idx, CollectionKind kind, int game_count, int first_game_idx)
+{
+    const QString dir = pegasus_dir(coll_idx);
+    const QString ext = QStringLiteral("rom%1").arg(coll_idx % 8);
+    make_dir(dir);
+    create_game_files(dir, ext, game_count, first_game_idx);
+
+    QString metafile;
+    QTextStream out(&metafile);
+    out << "collection: Collection " << coll_idx << '\n';
+    out << "shortname: coll" << coll_idx << '\n';
+    out << "extension: " << ext << '\n';
+    out << "launch: emulator \"{file.path}\"\n";
+    if (chance(50))
+        out << "summary: " << LOREM << '\n';
+    out << '\n';
+
+    for (int i = 0; i < game_count; i++) {
+        const int game_idx = first_game_idx + i;
+        const QString relpath = game_relpath(game_idx, i, ext);
+
+        // some games are only found by their extension
+        if (kind != CollectionKind::SKRAPER && chance(80))
+            write_pegasus_game(out, relpath, game_title(game_idx));
+
+        const QString basepath = relpath.left(relpath.lastIndexOf('.'));
+        const QString subdir = basepath.left(basepath.lastIndexOf('/'));
+        if (kind == CollectionKind::PEGASUS_MEDIA && chance(90)) {
+            const QString media_dir = dir + QStringLiteral("/media/") + basepath;
+            make_dir(media_dir);
+            touch(media_dir + QStringLiteral("/boxFront.png"));
+            if (chance(50))
+                touch(media_dir + QStringLiteral("/screenshot.jpg"));
+            if (chance(20))
+                touch(media_dir + QStringLiteral("/video.mp4"));
+        }
+        if (kind == CollectionKind::SKRAPER && chance(90)) {
+            const QString skraper_dir = dir + QStringLiteral("/skraper/");
+            make_dir(skraper_dir + QStringLiteral("box2dfront/") + subdir);
+            touch(skraper_dir + QStringLiteral("box2dfront/") + basepath + QStringLiteral(".png"));
+            if (chance(50)) {
+                make_dir(skraper_dir + QStringLiteral("screenshot/") + subdir);
+                touch(skraper_dir + QStringLiteral("screenshot/") + basepath + QStringLiteral(".png"));
+            }
+        }
+    }
+
+    out.flush();
+    write_text(dir + QStringLiteral("/metadata.pegasus.txt"), metafile);
+}
+
+void Generator::write_es2_game(QTextStream& out, const QString& relpath, const QString& title)
+{
+    out << "  <game>\n";
+    out << "    <path>./" << relpath.toHtmlEscaped() << "</path>\n";
+    out << "    <name>" << title.toHtmlEscaped() << "</name>\n";
+    if (chance(60))
+        out << "    <desc>" << LOREM << "</desc>\n";
+    if (chance(80))
+        out << "    <developer>" << pick(DEVELOPERS) << "</developer>\n";
+    if (chance(60))
+        out << "    <publisher>" << pick(DEVELOPERS) << "</publisher>\n";
+    if (chance(70))
+        out << "    <genre>" << pick(GENRES) << "</genre>\n";
+    if (chance(50))
+        out << "    <players>1-" << number(1, 4) << "</players>\n";
+    if (chance(50))
+        out << "    <rating>0." << number(0, 9) << "</rating>\n";
+    if (chance(60))
+        out << "    <releasedate>" << number(1980, 2010) << "0101T000000</releasedate>\n";
+    if (chance(10))
+        out << "    <favorite>true</favorite>\n";
+    out << "  </game>\n";
+}
+
+void Generator::create_es2_system(int coll_idx, int game_count, int first_game_idx, QTextStream& systems_xml)
+{
+    const QString dir = es2_dir(coll_idx);
+    const QString ext = QStringLiteral("bin");
+    make_dir(dir);
+    create_game_files(dir, ext, game_count, first_game_idx);
+
+    systems_xml << "  <system>\n";
+    systems_xml << "    <name>sys" << coll_idx << "</name>\n";
+    systems_xml << "    <fullname>System " << coll_idx << "</fullname>\n";
+    systems_xml << "    <path>" << dir.toHtmlEscaped() << "</path>\n";
+    systems_xml << "    <extension>.bin .BIN</extension>\n";
+    systems_xml << "    <command>emulator %ROM%</command>\n";
+    systems_xml << "  </system>\n";
+
+    QString gamelist;
+    QTextStream out(&gamelist);
+    out << "<?xml version=\"1.0\"?>\n<gameList>\n";
+    for (int i = 0; i < game_count; i++) {
+        const int game_idx = first_game_idx + i;
+        if (chance(85))
+            write_es2_game(out, game_relpath(game_idx, i, ext), game_title(game_idx));
+    }
+    out << "</gameList>\n";
+
+    out.flush();
+    write_text(dir + QStringLiteral("/gamelist.xml"), gamelist);
+}
+} // namespace
+
+
+namespace testsupport {
+
+LibraryOptions::LibraryOptions(int collection_count, int game_count)
+    : collection_count(collection_count)
+    , game_count(game_count)
+    , seed(42)
+{}
+
+GeneratedLibrary::GeneratedLibrary()
+    : collection_count(0)
+    , game_count(0)
+{}
+
+bool generate_library(const QString& root_dir, const LibraryOptions& options, GeneratedLibrary& result)
+{
+    Q_ASSERT(options.collection_count > 0);
+    Q_ASSERT(options.game_count >= 0);
+
+    Generator gen(root_dir, options.seed);
+
+    QString systems_xml_str;
+    QTextStream systems_xml(&systems_xml_str);
+    systems_xml << "<?xml version=\"1.0\"?>\n<systemList>\n";
+
+    const int games_per_coll = options.game_count / options.collection_count;
+    const int games_remaining = options.game_count % options.collection_count;
+    int next_game_idx = 0;
+
+    for (int coll_idx = 0; coll_idx < options.collection_count; coll_idx++) {
+        const int game_count = games_per_coll + (coll_idx < games_remaining ? 1 : 0);
+        const auto kind = static_cast<CollectionKind>(coll_idx % 4);
+
+        if (kind == CollectionKind::ES2) {
+            gen.create_es2_system(coll_idx, game_count, next_game_idx, systems_xml);
+        }
+        else {
+            gen.create_pegasus_collection(coll_idx, kind, game_count, next_game_idx);
+            result.game_dirs << gen.pegasus_dir(coll_idx);
+        }
+
+        next_game_idx += game_count;
+    }
+
+    systems_xml << "</systemList>\n";
+    systems_xml.flush();
+
+    result.es_systems_path = root_dir + QStringLiteral("/es_systems.cfg");
+    gen.write_text(result.es_systems_path, systems_xml_str);
+
+    result.collection_count = options.collection_count;
+    result.game_count = options.game_count;
+    return gen.ok();
+}
+
+} // namespace testsupport
@@ -0,0 +1,52 @@
+// Pegasus Frontend
+// Copyright (C) 2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+
+namespace testsupport {
+
+struct LibraryOptions {
+    int collection_count;
+    int game_count;
+    /// Seed of the random generator used for picking the metadata attributes
+    unsigned seed;
+
+    LibraryOptions(int collection_count, int game_count);
+};
+
+struct GeneratedLibrary {
+    /// The directories to be listed in `game_dirs.txt`
+    QStringList game_dirs;
+    /// The ES2 system config, to be placed at `~/.emulationstation/es_systems.cfg`
+    QString es_systems_path;
+
+    int collection_count;
+    int game_count;
+
+    GeneratedLibrary();
+};
+
+/// Creates a game library on the disk, in the given directory. The collections
+/// are split between Pegasus metadata files (with `media` directories and
+/// Skraper-style asset trees) and ES2 systems (with gamelist files).
+/// The game files and assets are empty. Returns false on file system errors.
+bool generate_library(const QString& root_dir, const LibraryOptions&, GeneratedLibrary&);
+
+} // namespace testsupport
@@ -0,0 +1,12 @@
+TEMPLATE = lib
+
+QT -= gui
+CONFIG += c++11 staticlib warn_on exceptions_off
+
+SOURCES += \
+    LibraryGenerator.cpp
+
+HEADERS += \
+    LibraryGenerator.h
+
+DEFINES *= $${COMMON_DEFINES}
@@ -4,5 +4,8 @@ SUBDIRS += \
     backend \
     benchmarks \
     integration \
+    support \
+
+benchmarks.depends = support
 
 requires(qtHaveModule(testlib))